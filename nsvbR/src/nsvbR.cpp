@@ -1,41 +1,64 @@
 
 #include <Rcpp.h>
 #include "../../src/nsvb.hpp"
+#include "../../src/nsvb_batch.hpp"
 #include <string>
 
 using namespace Rcpp;
 
+// divisions arrive as the levels and codes of an R factor with "" prepended to the levels
+// so the 1-based codes index them directly (NA codes are treated as blank)
+static TREE_BATCH tree_batch( IntegerVector fia_spp, std::vector<std::string> &levels, StringVector division_levels,
+                              IntegerVector division, NumericVector dbh, NumericVector height )
+{
+    for( R_xlen_t i = 0; i < division_levels.size(); i++ )
+        levels.push_back( std::string( division_levels[i] ) );
+
+    TREE_BATCH trees;
+    trees.n = fia_spp.size();
+    trees.fia_spp = fia_spp.begin();
+    trees.division_dictionary = levels.data();
+    trees.division_dictionary_size = levels.size();
+    trees.division_index = division.begin();
+    trees.dbh = dbh.begin();
+    trees.height = height.begin();
+
+    return trees;
+}
+
 // [[Rcpp::export]]
 Rcpp::DataFrame compute_biomass_components( 
         IntegerVector plot,
         IntegerVector tree,
         IntegerVector fia_spp, 
-        StringVector  division,
+        StringVector  division_levels,
+        IntegerVector division,
         NumericVector vtotib,
         NumericVector dbh, 
         NumericVector height ) 
 {
     size_t n = fia_spp.size();
     
-    std::vector<double> wood( n, 0.0 );
-    std::vector<double> bark( n, 0.0 );
-    std::vector<double> branch( n, 0.0 );
-    std::vector<double> foliage( n, 0.0 );
-    std::vector<double> total( n, 0.0 );
-    std::vector<double> above_ground_biomass( n, 0.0 );
+    NumericVector wood( n );
+    NumericVector bark( n );
+    NumericVector branch( n );
+    NumericVector foliage( n );
+    NumericVector total( n );
+    NumericVector above_ground_biomass( n );
     
-    for( size_t i = 0; i < n; i++ )
-    {
-        auto d = std::string( division[i] );
-        auto bc = biomass_components( fia_spp[i], d, vtotib[i], dbh[i], height[i] );
-        
-        wood[i] = bc.wood;
-        bark[i] = bc.bark;
-        branch[i] = bc.branch;
-        foliage[i] = bc.foliage;
-        total[i] = bc.total;
-        above_ground_biomass[i] = bc.above_ground_biomass;
-    }
+    std::vector<std::string> levels;
+    TREE_BATCH trees = tree_batch( fia_spp, levels, division_levels, division, dbh, height );
+    trees.vtotib = vtotib.begin();
+
+    BATCH_RESULT result;
+    result.wood = wood.begin();
+    result.bark = bark.begin();
+    result.branch = branch.begin();
+    result.foliage = foliage.begin();
+    result.total = total.begin();
+    result.above_ground_biomass = above_ground_biomass.begin();
+
+    evaluate_batch( trees, result );
     
     Rcpp::DataFrame bcDF = Rcpp::DataFrame::create(
         Rcpp::Named("plot") = plot,
@@ -61,7 +84,7 @@ Rcpp::DataFrame compute_green_tons(
 {
     size_t n = fia_spp.size();
     
-    std::vector<double> green_tons( n, 0.0 );
+    NumericVector green_tons( n );
 
     for( size_t i = 0; i < n; i++ )
         green_tons[i] = compute_green_tons( fia_spp[i], vtotob[i], vtotib[i] );
@@ -80,27 +103,28 @@ Rcpp::DataFrame compute_volib(
         IntegerVector plot,
         IntegerVector tree,
         IntegerVector fia_spp, 
-        StringVector  division,        
+        StringVector  division_levels,
+        IntegerVector division,
         NumericVector dbh,
         NumericVector height ) 
 {
     size_t n = fia_spp.size();
     
-    std::vector<double> volib( n, 0.0 );
+    NumericVector volib( n );
     
-    for( size_t i = 0; i < n; i++ )
-    {
-        auto d = std::string( division[i] );
-        volib[i] = compute_volib( fia_spp[i], d, dbh[i], height[i] );
-        
-    }
+    std::vector<std::string> levels;
+    TREE_BATCH trees = tree_batch( fia_spp, levels, division_levels, division, dbh, height );
+
+    BATCH_RESULT result;
+    result.volib = volib.begin();
+
+    evaluate_batch( trees, result );
     
     Rcpp::DataFrame volibDF = Rcpp::DataFrame::create(
         Rcpp::Named("plot") = plot,
         Rcpp::Named("tree") = tree,
         Rcpp::Named("volib") = volib );
-
-    
+        
     return Rcpp::wrap(volibDF);
 }
 
@@ -110,26 +134,27 @@ Rcpp::DataFrame compute_volob(
         IntegerVector plot,
         IntegerVector tree,
         IntegerVector fia_spp, 
-        StringVector  division,        
+        StringVector  division_levels,
+        IntegerVector division,
         NumericVector dbh,
         NumericVector height ) 
 {
     size_t n = fia_spp.size();
     
-    std::vector<double> volob( n, 0.0 );
+    NumericVector volob( n );
     
-    for( size_t i = 0; i < n; i++ )
-    {
-        auto d = std::string( division[i] );
-        volob[i] = compute_volob( fia_spp[i], d, dbh[i], height[i] );
-        
-    }
+    std::vector<std::string> levels;
+    TREE_BATCH trees = tree_batch( fia_spp, levels, division_levels, division, dbh, height );
+
+    BATCH_RESULT result;
+    result.volob = volob.begin();
+
+    evaluate_batch( trees, result );
     
     Rcpp::DataFrame volobDF = Rcpp::DataFrame::create(
         Rcpp::Named("plot") = plot,
         Rcpp::Named("tree") = tree,
         Rcpp::Named("volob") = volob );
         
-        
     return Rcpp::wrap(volobDF);
 }
@@ -14,6 +14,7 @@
 #include <map>
 #include <math.h>
 #include <iostream>
+#include <stdexcept>
 #include "nsvb.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -94,6 +95,38 @@ double biomass( int fia_spp, const COEFS &coefs, double wood_sg, double dbh, dou
     return biomass;
 }
 
+// coefficients of a component for a species: division table -> species table -> Jenkins table
+// (nullptr for woodland species, 0.0); eq_spp receives the species code passed to biomass()
+static const COEFS *component_coefs( COMPONENT component, const std::string &division, int fia_spp, int jspp, int &eq_spp )
+{
+    eq_spp = fia_spp;
+
+    if( const COEF_TABLE *d = division_coef_table( component, division ) )
+        if( const COEFS *c = find_coefs( *d, fia_spp ) )
+            return c;
+
+    if( const COEFS *c = find_coefs( coef_table( COEF_SPECIES, component ), fia_spp ) )
+        return c;
+
+    eq_spp = jspp;
+    if( jspp >= 10 )
+        return nullptr;
+
+    const COEFS *c = find_coefs( coef_table( COEF_JENKINS, component ), jspp );
+    if( !c )
+        throw std::out_of_range( "no Jenkins coefficients for group " + std::to_string( jspp ) );
+    return c;
+}
+
+// biomass or volume of a component (0.0 for woodland species)
+static double component_value( COMPONENT component, const std::string &division, int fia_spp, const REFS &r, double dbh, double height )
+{
+    int eq_spp;
+    const COEFS *c = component_coefs( component, division, fia_spp, r.Jenkins_spcd, eq_spp );
+
+    return c ? biomass( eq_spp, *c, r.wood_sg, dbh, height ) : 0.0;
+}
+
 // compute biomass components in pounds given:
 //   FIA species code
 //   FIA ecological division. Recognized divisions:
@@ -109,92 +142,17 @@ BIOMASS_COMP biomass_components( int fia_spp, std::string division, double vtoti
         BIOMASS_COMP bc;
 
         // use other live tree species code if species not found
-        if( refs.find( fia_spp ) == refs.end() )
+        if( !find_refs( fia_spp ) )
             fia_spp = 999;
 
-        const REFS &r = refs.at( fia_spp );
-        int jspp = r.Jenkins_spcd;
+        const REFS &r = *find_refs( fia_spp );
 
         bc.wood = vtotib * r.wood_sg * 62.4;
 
-        bool found = false;
-        if( division_bark_coefs.find( division ) != division_bark_coefs.end() )
-        {
-            if( division_bark_coefs.at(division).find(fia_spp) != division_bark_coefs.at(division).end() )
-            {
-                bc.bark = biomass( fia_spp, division_bark_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-                found = true;
-            }
-        }
-
-        if( !found )
-        {
-            if( bark_coefs.find(fia_spp) != bark_coefs.end() )
-                bc.bark = biomass( fia_spp, bark_coefs.at(fia_spp), r.wood_sg, dbh, height );
-            else 
-                bc.bark = jspp < 10 ? biomass( jspp, jenkins_bark_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
-        }
-
-        ///////////////
-
-        found = false;
-        if( division_branch_coefs.find( division ) != division_branch_coefs.end() )
-        {
-            if( division_branch_coefs.at(division).find(fia_spp) != division_branch_coefs.at(division).end() )
-            {
-                bc.branch = biomass( fia_spp, division_branch_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-                found = true;
-            }
-        }
-
-        if( !found )
-        {
-            if( branch_coefs.find(fia_spp) != branch_coefs.end() )
-                bc.branch = biomass( fia_spp, branch_coefs.at(fia_spp), r.wood_sg, dbh, height );
-            else 
-                bc.branch = jspp < 10 ? biomass( jspp, jenkins_branch_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
-        }
-
-        ///////////////
-        
-        found = false;
-        if( division_foliage_coefs.find( division ) != division_foliage_coefs.end() )
-        {
-            if( division_foliage_coefs.at(division).find(fia_spp) != division_foliage_coefs.at(division).end() )
-            {
-                bc.foliage = biomass( fia_spp, division_foliage_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-                found = true;
-            }
-        } 
-        
-        if( !found )
-        {
-            if( foliage_coefs.find(fia_spp) != foliage_coefs.end() )
-                bc.foliage = biomass( fia_spp, foliage_coefs.at(fia_spp), r.wood_sg, dbh, height );
-            else
-                bc.foliage = jspp < 10 ? biomass( jspp, jenkins_foliage_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
-        }
-
-        ///////////////
-        
-        found = false;
-        if( division_total_coefs.find( division ) != division_total_coefs.end() )
-        {
-            if( division_total_coefs.at(division).find(fia_spp) != division_total_coefs.at(division).end() )
-            {
-                bc.total = biomass( fia_spp, division_total_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-                found = true;
-            }    
-        }
-        
-        if( !found )
-        {
-            if( total_coefs.find(fia_spp) != total_coefs.end() )
-                bc.total = biomass( fia_spp, total_coefs.at(fia_spp), r.wood_sg, dbh, height );
-            else {
-                bc.total = jspp < 10 ? biomass( jspp, jenkins_total_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
-            }
-        }
+        bc.bark = component_value( COMP_BARK, division, fia_spp, r, dbh, height );
+        bc.branch = component_value( COMP_BRANCH, division, fia_spp, r, dbh, height );
+        bc.foliage = component_value( COMP_FOLIAGE, division, fia_spp, r, dbh, height );
+        bc.total = component_value( COMP_TOTAL, division, fia_spp, r, dbh, height );
 
         //////////////////////////////////////////////
         double TotalC = bc.wood + bc.bark + bc.branch;
@@ -234,10 +192,10 @@ double compute_green_tons( int fia_spp, double cfvolob, double cfvolib )
 
     try {
         // use other live tree species code if species not found
-        if( refs.find( fia_spp ) == refs.end() )
+        if( !find_refs( fia_spp ) )
             fia_spp = 999;
 
-        const REFS &r = refs.at( fia_spp );
+        const REFS &r = *find_refs( fia_spp );
 
         green_tons = (cfvolib * ((r.wood_sg*1000.0) * (1.0 + (r.mc_pct_green_wood/100.0))) * 2.2046 / 35.3145 +
                         (cfvolob-cfvolib) * ((r.bark_sg*1000.0) * (1.0 + (r.mc_pct_green_bark/100.0))) * 2.2046 / 35.3145) / 2000.0;
@@ -260,24 +218,12 @@ double compute_volib( int fia_spp, std::string division, double dbh, double heig
 {
     try {
         // use other live tree species code if species not found
-        if( refs.find( fia_spp ) == refs.end() )
+        if( !find_refs( fia_spp ) )
             fia_spp = 999;
 
-        const REFS &r = refs.at( fia_spp );
-    
-        int jspp = r.Jenkins_spcd;
-
-        if( division_volib_coefs.find( division ) != division_volib_coefs.end() )
-        {
-            if( division_volib_coefs.at(division).find(fia_spp) != division_volib_coefs.at(division).end() )
-                return biomass( fia_spp, division_volib_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-        }
-        
-        if( volib_coefs.find(fia_spp) != volib_coefs.end() )
-            return biomass( fia_spp, volib_coefs.at(fia_spp), r.wood_sg, dbh, height );
-        else 
-            return jspp < 10 ? biomass( jspp, jenkins_volib_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
+        const REFS &r = *find_refs( fia_spp );
 
+        return component_value( COMP_VOLIB, division, fia_spp, r, dbh, height );
     } catch( const std::exception &e ) {
         throw;
     }
@@ -296,22 +242,12 @@ double compute_volob( int fia_spp, std::string division, double dbh, double heig
 {
     try {
         // use other live tree species code if species not found
-        if( refs.find( fia_spp ) == refs.end() )
+        if( !find_refs( fia_spp ) )
             fia_spp = 999;
-            
-        const REFS &r = refs.at( fia_spp );
-        int jspp = r.Jenkins_spcd;
-
-        if( division_volob_coefs.find( division ) != division_volob_coefs.end() )
-        {
-            if( division_volob_coefs.at(division).find(fia_spp) != division_volob_coefs.at(division).end() )
-                return biomass( fia_spp, division_volob_coefs.at(division).at(fia_spp), r.wood_sg, dbh, height );
-        }
-        
-        if( volob_coefs.find(fia_spp) != volob_coefs.end() )
-            return biomass( fia_spp, volob_coefs.at(fia_spp), r.wood_sg, dbh, height );
-        else
-            return jspp < 10 ? biomass( jspp, jenkins_volob_coefs.at(jspp), r.wood_sg, dbh, height ) : 0.0;
+
+        const REFS &r = *find_refs( fia_spp );
+
+        return component_value( COMP_VOLOB, division, fia_spp, r, dbh, height );
     } catch( const std::exception &e ) {
         throw;
     }        
@@ -14,7 +14,8 @@
 #ifndef NSVB
 #define NSVB
 
-#include "nsvb_coef.hpp"
+#include <string>
+#include "nsvb_coef_blob.hpp"
 
 // biomass components (lbs)
 struct BIOMASS_COMP {
@@ -0,0 +1,426 @@
+// National Scale Volume and Biomass estimators (NSVB) Arrow C Data Interface
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nsvb_arrow.h"
+#include "nsvb_batch.hpp"
+
+static thread_local std::string last_error;
+
+// output columns in the order they are exported
+static const char *result_names[] = { "volib", "volob", "wood", "bark", "branch", "foliage", "total", "above_ground_biomass" };
+constexpr int RESULT_COLUMNS = 8;
+
+// a column of the input struct array
+struct INPUT_COLUMN {
+    const ArrowArray *array = nullptr;
+    const ArrowSchema *schema = nullptr;
+    int64_t offset = 0;                 // struct offset + column offset
+
+    // true when row i is not null
+    bool valid( int64_t i ) const
+    {
+        const uint8_t *bits = static_cast<const uint8_t *>( array->buffers[0] );
+        if( !bits || array->null_count == 0 )
+            return true;
+
+        int64_t j = offset + i;
+        return ( bits[j >> 3] >> ( j & 7 ) ) & 1;
+    }
+
+    bool has_nulls() const { return array && array->n_buffers > 0 && array->buffers[0] && array->null_count != 0; }
+
+    template <typename T>
+    const T *values() const { return static_cast<const T *>( array->buffers[1] ) + offset; }
+};
+
+// find a column of the struct array by name
+static INPUT_COLUMN find_column( const ArrowArray *input, const ArrowSchema *schema, const char *name, bool required )
+{
+    INPUT_COLUMN c;
+
+    for( int64_t i = 0; i < schema->n_children; i++ )
+    {
+        if( schema->children[i]->name && !std::strcmp( schema->children[i]->name, name ) )
+        {
+            c.array = input->children[i];
+            c.schema = schema->children[i];
+            c.offset = input->offset + c.array->offset;
+
+            if( c.array->length < input->offset + input->length )
+                throw std::invalid_argument( std::string( "column " ) + name + " is shorter than the struct array" );
+            return c;
+        }
+    }
+
+    if( required )
+        throw std::invalid_argument( std::string( "missing column " ) + name );
+
+    return c;
+}
+
+// floating point column as doubles (read in place when float64)
+static const double *double_column( const INPUT_COLUMN &c, int64_t n, std::vector<double> &storage )
+{
+    std::string_view format = c.schema->format;
+
+    if( format == "g" )
+        return c.values<double>();
+
+    if( format == "f" )
+    {
+        storage.assign( c.values<float>(), c.values<float>() + n );
+        return storage.data();
+    }
+
+    throw std::invalid_argument( std::string( "column " ) + c.schema->name + " must be float64 or float32" );
+}
+
+// integer column as ints (read in place when int32)
+static const int *int_column( const INPUT_COLUMN &c, int64_t n, std::vector<int> &storage )
+{
+    std::string_view format = c.schema->format;
+
+    if( format == "i" )
+        return c.values<int32_t>();
+
+    if( format == "s" )
+        storage.assign( c.values<int16_t>(), c.values<int16_t>() + n );
+    else if( format == "l" )
+        storage.assign( c.values<int64_t>(), c.values<int64_t>() + n );
+    else
+        throw std::invalid_argument( std::string( "column " ) + c.schema->name + " must be int16, int32 or int64" );
+
+    return storage.data();
+}
+
+// string i of a utf8 ("u") or large utf8 ("U") array (offset already applied)
+static std::string_view string_value( const ArrowArray *a, std::string_view format, int64_t i )
+{
+    const char *data = static_cast<const char *>( a->buffers[2] );
+
+    if( format == "u" )
+    {
+        const int32_t *o = static_cast<const int32_t *>( a->buffers[1] );
+        return std::string_view( data + o[i], o[i + 1] - o[i] );
+    }
+
+    const int64_t *o = static_cast<const int64_t *>( a->buffers[1] );
+    return std::string_view( data + o[i], o[i + 1] - o[i] );
+}
+
+// dictionary index i of an integer array
+static int64_t dictionary_index( const INPUT_COLUMN &c, std::string_view format, int64_t i )
+{
+    switch( format[0] ) {
+        case 'c': return c.values<int8_t>()[i];
+        case 'C': return c.values<uint8_t>()[i];
+        case 's': return c.values<int16_t>()[i];
+        case 'S': return c.values<uint16_t>()[i];
+        case 'i': return c.values<int32_t>()[i];
+        case 'I': return c.values<uint32_t>()[i];
+        case 'l': return c.values<int64_t>()[i];
+        default:  return static_cast<int64_t>( c.values<uint64_t>()[i] );
+    }
+}
+
+// division codes of a string or dictionary encoded string column (null: blank)
+static void division_column( const INPUT_COLUMN &c, int64_t n, std::vector<DIVISION> &codes )
+{
+    codes.assign( n, DIV_NONE );
+
+    if( c.schema->dictionary )
+    {
+        // map each dictionary entry once
+        std::string_view index_format = c.schema->format;
+        std::string_view value_format = c.schema->dictionary->format;
+        const ArrowArray *dictionary = c.array->dictionary;
+
+        if( index_format.size() != 1 || std::string_view( "cCsSiIlL" ).find( index_format[0] ) == std::string_view::npos )
+            throw std::invalid_argument( "division dictionary indices must be integers" );
+        if( ( value_format != "u" && value_format != "U" ) || !dictionary )
+            throw std::invalid_argument( "division dictionary must hold utf8 strings" );
+
+        INPUT_COLUMN values;
+        values.array = dictionary;
+        values.schema = c.schema->dictionary;
+        values.offset = dictionary->offset;
+
+        std::vector<DIVISION> entries( dictionary->length, DIV_NONE );
+        for( int64_t d = 0; d < dictionary->length; d++ )
+            if( values.valid( d ) )
+                entries[d] = division_code( string_value( dictionary, value_format, values.offset + d ) );
+
+        for( int64_t i = 0; i < n; i++ )
+        {
+            if( !c.valid( i ) )
+                continue;
+
+            int64_t d = dictionary_index( c, index_format, i );
+            if( d < 0 || d >= dictionary->length )
+                throw std::invalid_argument( "division dictionary index out of range" );
+            codes[i] = entries[d];
+        }
+        return;
+    }
+
+    std::string_view format = c.schema->format;
+    if( format != "u" && format != "U" )
+        throw std::invalid_argument( "column division must be utf8, large utf8 or a dictionary of them" );
+
+    for( int64_t i = 0; i < n; i++ )
+        if( c.valid( i ) )
+            codes[i] = division_code( string_value( c.array, format, c.offset + i ) );
+}
+
+// result buffers shared by the exported struct array and its children
+struct RESULT_BUFFERS {
+    double *columns[RESULT_COLUMNS] = {};
+    uint8_t *validity = nullptr;
+    void *block = nullptr;
+
+    explicit RESULT_BUFFERS( int64_t n, bool nullable )
+    {
+        // one 64 byte aligned block holding every column (and the validity bitmap)
+        std::size_t column_bytes = ( n * sizeof( double ) + 63 ) & ~std::size_t( 63 );
+        std::size_t validity_bytes = nullable ? ( ( n + 7 ) / 8 + 63 ) & ~std::size_t( 63 ) : 0;
+
+        block = std::aligned_alloc( 64, RESULT_COLUMNS * column_bytes + validity_bytes + 64 );
+        if( !block )
+            throw std::bad_alloc();
+
+        char *p = static_cast<char *>( block );
+        for( auto &c : columns )
+        {
+            c = reinterpret_cast<double *>( p );
+            p += column_bytes;
+        }
+        if( nullable )
+            validity = reinterpret_cast<uint8_t *>( p );
+    }
+
+    ~RESULT_BUFFERS() { std::free( block ); }
+
+    RESULT_BUFFERS( const RESULT_BUFFERS & ) = delete;
+    RESULT_BUFFERS &operator=( const RESULT_BUFFERS & ) = delete;
+};
+
+// private data of an exported array
+struct EXPORTED_ARRAY {
+    std::shared_ptr<RESULT_BUFFERS> buffers;
+    const void *pointers[2] = {};
+    ArrowArray child_arrays[RESULT_COLUMNS] = {};
+    ArrowArray *children[RESULT_COLUMNS] = {};
+};
+
+static void release_array( ArrowArray *a )
+{
+    auto *p = static_cast<EXPORTED_ARRAY *>( a->private_data );
+
+    for( int64_t i = 0; i < a->n_children; i++ )
+        if( a->children[i]->release )
+            a->children[i]->release( a->children[i] );
+
+    delete p;
+    a->release = nullptr;
+}
+
+// private data of an exported schema
+struct EXPORTED_SCHEMA {
+    ArrowSchema child_schemas[RESULT_COLUMNS] = {};
+    ArrowSchema *children[RESULT_COLUMNS] = {};
+};
+
+static void release_child_schema( ArrowSchema *s )
+{
+    s->release = nullptr;
+}
+
+static void release_schema( ArrowSchema *s )
+{
+    auto *p = static_cast<EXPORTED_SCHEMA *>( s->private_data );
+
+    for( int64_t i = 0; i < s->n_children; i++ )
+        if( s->children[i]->release )
+            s->children[i]->release( s->children[i] );
+
+    delete p;
+    s->release = nullptr;
+}
+
+// export the result columns as a struct array
+static void export_result( const std::shared_ptr<RESULT_BUFFERS> &buffers, int64_t n, int64_t null_count,
+                           ArrowArray *out, ArrowSchema *out_schema )
+{
+    auto schema = std::make_unique<EXPORTED_SCHEMA>();
+    for( int c = 0; c < RESULT_COLUMNS; c++ )
+    {
+        ArrowSchema &s = schema->child_schemas[c];
+        s.format = "g";
+        s.name = result_names[c];
+        s.flags = ARROW_FLAG_NULLABLE;
+        s.release = release_child_schema;
+        schema->children[c] = &s;
+    }
+
+    auto array = std::make_unique<EXPORTED_ARRAY>();
+    array->buffers = buffers;
+    for( int c = 0; c < RESULT_COLUMNS; c++ )
+    {
+        auto child = std::make_unique<EXPORTED_ARRAY>();
+        child->buffers = buffers;
+        child->pointers[0] = buffers->validity;
+        child->pointers[1] = buffers->columns[c];
+
+        ArrowArray &a = array->child_arrays[c];
+        a.length = n;
+        a.null_count = null_count;
+        a.n_buffers = 2;
+        a.buffers = child->pointers;
+        a.release = release_array;
+        a.private_data = child.release();
+        array->children[c] = &a;
+    }
+
+    *out_schema = ArrowSchema{};
+    out_schema->format = "+s";
+    out_schema->name = "";
+    out_schema->n_children = RESULT_COLUMNS;
+    out_schema->children = schema->children;
+    out_schema->release = release_schema;
+    out_schema->private_data = schema.release();
+
+    *out = ArrowArray{};
+    out->length = n;
+    out->n_buffers = 1;
+    out->buffers = array->pointers;
+    out->n_children = RESULT_COLUMNS;
+    out->children = array->children;
+    out->release = release_array;
+    out->private_data = array.release();
+}
+
+// evaluate volumes and biomass components for a struct array of trees
+int nsvb_arrow_evaluate( const ArrowArray *input, const ArrowSchema *input_schema,
+                         ArrowArray *out, ArrowSchema *out_schema, unsigned threads )
+{
+    last_error.clear();
+
+    try {
+        if( !input || !input_schema || !out || !out_schema || !input->release || !input_schema->release )
+            throw std::invalid_argument( "input and output arrays must be provided and the input not released" );
+        if( std::string_view( input_schema->format ) != "+s" || input_schema->n_children != input->n_children )
+            throw std::invalid_argument( "input must be a struct array" );
+
+        int64_t n = input->length;
+
+        INPUT_COLUMN fia_spp = find_column( input, input_schema, "fia_spp", true );
+        INPUT_COLUMN division = find_column( input, input_schema, "division", false );
+        INPUT_COLUMN dbh = find_column( input, input_schema, "dbh", true );
+        INPUT_COLUMN height = find_column( input, input_schema, "height", true );
+        INPUT_COLUMN vtotib = find_column( input, input_schema, "vtotib", false );
+
+        std::vector<int> spp_storage;
+        std::vector<double> dbh_storage, height_storage, vtotib_storage;
+        std::vector<DIVISION> codes;
+
+        TREE_BATCH trees;
+        trees.n = n;
+        trees.fia_spp = int_column( fia_spp, n, spp_storage );
+        trees.dbh = double_column( dbh, n, dbh_storage );
+        trees.height = double_column( height, n, height_storage );
+        if( vtotib.array )
+            trees.vtotib = double_column( vtotib, n, vtotib_storage );
+        std::vector<std::string> dictionary;
+        if( division.array && division.schema->dictionary && std::string_view( division.schema->format ) == "i" &&
+            !division.has_nulls() && division.array->dictionary )
+        {
+            // int32 indices are used in place with the dictionary entries
+            const ArrowArray *d = division.array->dictionary;
+            std::string_view value_format = division.schema->dictionary->format;
+            if( value_format != "u" && value_format != "U" )
+                throw std::invalid_argument( "division dictionary must hold utf8 strings" );
+
+            INPUT_COLUMN values;
+            values.array = d;
+            values.offset = d->offset;
+            for( int64_t e = 0; e < d->length; e++ )
+                dictionary.emplace_back( values.valid( e ) ? string_value( d, value_format, d->offset + e ) : std::string_view() );
+
+            // rejected as division_column() does rather than evaluated as blank divisions
+            const int32_t *index = division.values<int32_t>();
+            for( int64_t i = 0; i < n; i++ )
+                if( index[i] < 0 || index[i] >= d->length )
+                    throw std::invalid_argument( "division dictionary index out of range" );
+
+            trees.division_dictionary = dictionary.data();
+            trees.division_dictionary_size = dictionary.size();
+            trees.division_index = index;
+        } else if( division.array ) {
+            division_column( division, n, codes );
+            trees.division_codes = codes.data();
+        }
+
+        // a result is null when any of its numeric inputs is null
+        const INPUT_COLUMN *numeric[] = { &fia_spp, &dbh, &height, &vtotib };
+        bool nullable = false;
+        for( auto *c : numeric )
+            nullable = nullable || c->has_nulls();
+
+        auto buffers = std::make_shared<RESULT_BUFFERS>( n, nullable );
+
+        BATCH_RESULT result;
+        double **columns = buffers->columns;
+        result.volib = columns[0]; result.volob = columns[1]; result.wood = columns[2]; result.bark = columns[3];
+        result.branch = columns[4]; result.foliage = columns[5]; result.total = columns[6]; result.above_ground_biomass = columns[7];
+
+        BATCH_OPTIONS options;
+        options.threads = threads;
+        evaluate_batch( trees, result, options );
+
+        int64_t null_count = 0;
+        if( nullable )
+        {
+            std::memset( buffers->validity, 0, ( n + 7 ) / 8 );
+            for( int64_t i = 0; i < n; i++ )
+            {
+                bool v = true;
+                for( auto *c : numeric )
+                    v = v && ( !c->array || c->valid( i ) );
+
+                if( v )
+                    buffers->validity[i >> 3] |= uint8_t( 1u << ( i & 7 ) );
+                else
+                    null_count++;
+            }
+        }
+
+        export_result( buffers, n, null_count, out, out_schema );
+        return 0;
+    } catch( const std::invalid_argument &e ) {
+        last_error = e.what();
+        return EINVAL;
+    } catch( const std::bad_alloc & ) {
+        last_error = "out of memory";
+        return ENOMEM;
+    } catch( const std::exception &e ) {
+        last_error = e.what();
+        return EIO;
+    }
+}
+
+// message describing the error of the last nsvb_arrow_evaluate() on this thread ("" after a success)
+const char *nsvb_arrow_last_error( void )
+{
+    return last_error.c_str();
+}
@@ -0,0 +1,85 @@
+/* National Scale Volume and Biomass estimators (NSVB) Arrow C Data Interface
+ *
+ * C entry point evaluating a batch of trees held in Arrow arrays. Only the stable
+ * Arrow C Data Interface structures are used (https://arrow.apache.org/docs/format/CDataInterface.html),
+ * no Arrow library is required.
+ *
+ * Greg Johnson Biometrics LLC
+ * 10-18-2026
+ */
+
+#ifndef NSVB_ARROW_H
+#define NSVB_ARROW_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void ( *release )( struct ArrowSchema * );
+    void *private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void ( *release )( struct ArrowArray * );
+    void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+/* Evaluate volumes and biomass components for a struct array of trees.
+ *
+ * input columns (matched by name, any order):
+ *   fia_spp  : int16, int32 or int64                   FIA species code
+ *   division : utf8, large utf8 or dictionary of them  FIA ecological division (optional, null = blank)
+ *   dbh      : float64 or float32                      dbh (inches)
+ *   height   : float64 or float32                      total height (feet)
+ *   vtotib   : float64 or float32                      total inside bark volume (cubic feet) (optional)
+ *
+ * The input is borrowed: it is read in place and remains owned (and released) by the caller.
+ *
+ * On success *out and *out_schema receive a struct array (owned by the caller, free with their
+ * release callbacks) with float64 columns volib, volob, wood, bark, branch, foliage, total and
+ * above_ground_biomass. Results are written directly into the exported buffers. A row is null
+ * when its fia_spp, dbh, height or vtotib is null.
+ *
+ * threads: worker threads (0: one per hardware thread)
+ *
+ * Returns 0 on success or an errno value (EINVAL for an unsupported input or a division dictionary
+ * index out of range) with a message available from nsvb_arrow_last_error().
+ */
+int nsvb_arrow_evaluate( const struct ArrowArray *input, const struct ArrowSchema *input_schema,
+                         struct ArrowArray *out, struct ArrowSchema *out_schema, unsigned threads );
+
+/* message describing the error of the last nsvb_arrow_evaluate() on this thread ("" after a success) */
+const char *nsvb_arrow_last_error( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,447 @@
+// National Scale Volume and Biomass estimators (NSVB) batch evaluation
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "nsvb_batch.hpp"
+#include "nsvb_numa.hpp"
+#include "nsvb_plan_cache.hpp"
+#include "nsvb_plan_table.hpp"
+#include "nsvb_timing.hpp"
+
+// run body( begin, end ) over [0,count) in ranges of grain items using worker threads
+void parallel_for( std::size_t count, unsigned threads, const std::function<void( std::size_t, std::size_t )> &body,
+                   std::size_t grain )
+{
+    if( grain == 0 )
+        grain = 1;
+
+    std::size_t ranges = ( count + grain - 1 ) / grain;
+
+    if( threads == 0 )
+        threads = std::max( 1u, std::thread::hardware_concurrency() );
+    threads = static_cast<unsigned>( std::min<std::size_t>( threads, ranges ) );
+
+    if( threads <= 1 )
+    {
+        for( std::size_t begin = 0; begin < count; begin += grain )
+            body( begin, std::min( begin + grain, count ) );
+        return;
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&] {
+        try {
+            for( std::size_t r = next++; r < ranges; r = next++ )
+                body( r * grain, std::min( ( r + 1 ) * grain, count ) );
+        } catch( ... ) {
+            std::lock_guard<std::mutex> lock( error_mutex );
+            if( !error )
+                error = std::current_exception();
+            next = ranges;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for( unsigned t = 1; t < threads; t++ )
+        pool.emplace_back( worker );
+    worker();
+    for( auto &t : pool )
+        t.join();
+
+    if( error )
+        std::rethrow_exception( error );
+}
+
+// plans used by a thread, direct mapped by species, division and planted, in front of the
+// process plan cache, so each distinct combination is normally resolved once per process
+struct PLAN_MEMO {
+    static constexpr unsigned SIZE = 1024;
+
+    int fia_spp[SIZE] = {};
+    DIVISION division[SIZE] = {};
+    bool planted[SIZE] = {};
+    bool used[SIZE] = {};
+    NSVB_PLAN plans[SIZE];
+
+    const NSVB_PLAN &get( int spp, DIVISION d, bool p = false )
+    {
+        unsigned slot = ( ( static_cast<unsigned>( spp ) * 64u + d * 2u + p ) * 2654435761u >> 16 ) & ( SIZE - 1 );
+
+        if( !used[slot] || fia_spp[slot] != spp || division[slot] != d || planted[slot] != p )
+        {
+            plans[slot] = plan_cache().get( spp, d, p );
+            fia_spp[slot] = spp;
+            division[slot] = d;
+            planted[slot] = p;
+            used[slot] = true;
+        }
+
+        return plans[slot];
+    }
+};
+
+// planted flag of tree i
+static bool tree_planted( const TREE_BATCH &trees, std::size_t i )
+{
+    return trees.planted && trees.planted[i];
+}
+
+// division of tree i
+DIVISION tree_division( const TREE_BATCH &trees, const DIVISION *dictionary_codes, std::size_t i )
+{
+    if( trees.division_codes )
+        return trees.division_codes[i];
+
+    if( trees.division_index )
+    {
+        int d = trees.division_index[i];
+        return d >= 0 && static_cast<std::size_t>( d ) < trees.division_dictionary_size ? dictionary_codes[d] : DIV_NONE;
+    }
+
+    return trees.division ? division_code( trees.division[i] ) : DIV_NONE;
+}
+
+// division codes of the entries of a batch's division dictionary into codes[0 .. division_dictionary_size)
+void dictionary_codes( const TREE_BATCH &trees, DIVISION *codes )
+{
+    for( std::size_t d = 0; d < trees.division_dictionary_size; d++ )
+        codes[d] = division_code( trees.division_dictionary[d] );
+}
+
+// division codes of the entries of a batch's division dictionary
+std::vector<DIVISION> dictionary_codes( const TREE_BATCH &trees )
+{
+    std::vector<DIVISION> codes;
+
+    if( trees.division_index && !trees.division_codes )
+    {
+        codes.resize( trees.division_dictionary_size );
+        dictionary_codes( trees, codes.data() );
+    }
+
+    return codes;
+}
+
+// this thread's plans
+static PLAN_MEMO &thread_memo()
+{
+    static thread_local PLAN_MEMO memo;
+    return memo;
+}
+
+// resolve the plans of trees [begin,end) from the precomputed table when built, otherwise through this thread's memo
+static void resolve_plans( const TREE_BATCH &trees, const std::vector<DIVISION> &dictionary_codes,
+                           std::size_t begin, std::size_t end, NSVB_PLAN *plans, const PLAN_TABLE *table )
+{
+    if( table && !trees.planted )
+    {
+        for( std::size_t i = begin; i < end; i++ )
+            plans[i - begin] = table->get( trees.fia_spp[i], tree_division( trees, dictionary_codes.data(), i ) );
+        return;
+    }
+
+    PLAN_MEMO &memo = thread_memo();
+
+    for( std::size_t i = begin; i < end; i++ )
+        plans[i - begin] = memo.get( trees.fia_spp[i], tree_division( trees, dictionary_codes.data(), i ), tree_planted( trees, i ) );
+}
+
+// resolve the plans of trees [begin,end) of a batch into plans[0 .. end-begin)
+void resolve_plans( const TREE_BATCH &trees, const std::vector<DIVISION> &dictionary_codes, std::size_t begin, std::size_t end,
+                    NSVB_PLAN *plans )
+{
+    resolve_plans( trees, dictionary_codes, begin, end, plans, plan_table() );
+}
+
+// raw component estimates (before rebalance()) of n trees with resolved plans
+void evaluate_components( const NSVB_PLAN *plans, const double *dbh, const double *height, std::size_t n,
+                          double *const components[COMP_COUNT] )
+{
+    for( int c = 0; c < COMP_COUNT; c++ )
+        if( double *out = components[c] )
+            for( std::size_t i = 0; i < n; i++ )
+                out[i] = evaluate_component( plans[i], static_cast<COMPONENT>( c ), dbh[i], height[i] );
+}
+
+// evaluate trees [begin,end) of a batch (end - begin <= BATCH_CHUNK) with a plan table (nullptr: none)
+static void evaluate_chunk( const TREE_BATCH &trees, const std::vector<DIVISION> &dictionary_codes, const BATCH_RESULT &result,
+                            std::size_t begin, std::size_t end, const PLAN_TABLE *table )
+{
+    NSVB_PLAN plans[BATCH_CHUNK];
+    double vtotib[BATCH_CHUNK];
+    double raw[COMP_TOTAL + 1][BATCH_CHUNK];
+    BIOMASS_COMP bc[BATCH_CHUNK];
+
+    std::size_t n = end - begin;
+    const double *dbh = trees.dbh + begin;
+    const double *height = trees.height + begin;
+
+    bool want_biomass = result.wood || result.bark || result.branch || result.foliage || result.total || result.above_ground_biomass;
+    bool want_volib = result.volib || ( want_biomass && !trees.vtotib );
+
+    {
+        NSVB_TIME_STAGE( STAGE_RESOLVE_PLAN );
+
+        resolve_plans( trees, dictionary_codes, begin, end, plans, table );
+    }
+
+    {
+        NSVB_TIME_STAGE( STAGE_VOLUME );
+
+        double *volumes[COMP_COUNT] = {};
+        volumes[COMP_VOLIB] = want_volib ? vtotib : nullptr;
+        volumes[COMP_VOLOB] = result.volob ? result.volob + begin : nullptr;
+        evaluate_components( plans, dbh, height, n, volumes );
+
+        if( want_volib && result.volib )
+            std::copy( vtotib, vtotib + n, result.volib + begin );
+        if( trees.vtotib )
+            std::copy( trees.vtotib + begin, trees.vtotib + end, vtotib );
+    }
+
+    if( !want_biomass )
+        return;
+
+    {
+        NSVB_TIME_STAGE( STAGE_BIOMASS );
+
+        double *components[COMP_COUNT] = { raw[COMP_BARK], raw[COMP_BRANCH], raw[COMP_FOLIAGE], raw[COMP_TOTAL] };
+        evaluate_components( plans, dbh, height, n, components );
+
+        for( std::size_t i = 0; i < n; i++ )
+        {
+            bc[i].wood = vtotib[i] * plans[i].wood_sg * 62.4;
+            bc[i].bark = raw[COMP_BARK][i];
+            bc[i].branch = raw[COMP_BRANCH][i];
+            bc[i].foliage = raw[COMP_FOLIAGE][i];
+            bc[i].total = raw[COMP_TOTAL][i];
+        }
+    }
+
+    {
+        NSVB_TIME_STAGE( STAGE_REBALANCE );
+
+        for( std::size_t i = 0; i < n; i++ )
+        {
+            rebalance( bc[i] );
+
+            std::size_t j = begin + i;
+            if( result.wood ) result.wood[j] = bc[i].wood;
+            if( result.bark ) result.bark[j] = bc[i].bark;
+            if( result.branch ) result.branch[j] = bc[i].branch;
+            if( result.foliage ) result.foliage[j] = bc[i].foliage;
+            if( result.total ) result.total[j] = bc[i].total;
+            if( result.above_ground_biomass ) result.above_ground_biomass[j] = bc[i].above_ground_biomass;
+        }
+    }
+}
+
+// species codes sorted on: those of the reference table, up to its largest; others resolve as 999
+static int species_keys()
+{
+    static const int keys = ref_table().size() ? ( ref_table().end() - 1 )->fia_spp + 1 : 1000;
+    return keys;
+}
+
+// division codes of every tree of a batch
+static std::vector<DIVISION> tree_divisions( const TREE_BATCH &trees, const std::vector<DIVISION> &dictionary_codes )
+{
+    std::vector<DIVISION> divisions( trees.n );
+
+    for( std::size_t i = 0; i < trees.n; i++ )
+        divisions[i] = tree_division( trees, dictionary_codes.data(), i );
+
+    return divisions;
+}
+
+static std::vector<std::size_t> species_order( const TREE_BATCH &trees, const std::vector<DIVISION> &divisions )
+{
+    // sort key of each tree: division then species as resolved by resolve_plan()
+    const int species = species_keys();
+    std::vector<int> key( trees.n );
+    int spp = 0, resolved = 999;
+    for( std::size_t i = 0; i < trees.n; i++ )
+    {
+        if( i == 0 || trees.fia_spp[i] != spp )
+        {
+            spp = trees.fia_spp[i];
+            resolved = find_refs( spp ) ? spp : 999;
+        }
+        key[i] = divisions[i] * species + resolved;
+    }
+
+    std::vector<std::size_t> order( trees.n );
+    if( trees.n == 0 )
+        return order;
+
+    // counts span only the keys present; when those are spread wider than the batch a
+    // comparison sort is cheaper (both stable, so the orders agree)
+    int low = key[0], high = low;
+    for( std::size_t i = 1; i < trees.n; i++ )
+    {
+        low = std::min( low, key[i] );
+        high = std::max( high, key[i] );
+    }
+    std::size_t keys = static_cast<std::size_t>( high - low ) + 1;
+
+    if( keys > trees.n )
+    {
+        for( std::size_t i = 0; i < trees.n; i++ )
+            order[i] = i;
+        std::stable_sort( order.begin(), order.end(), [&]( std::size_t a, std::size_t b ) { return key[a] < key[b]; } );
+        return order;
+    }
+
+    std::vector<std::size_t> start( keys + 1, 0 );
+    for( std::size_t i = 0; i < trees.n; i++ )
+        start[key[i] - low + 1]++;
+    for( std::size_t k = 1; k < start.size(); k++ )
+        start[k] += start[k - 1];
+
+    for( std::size_t i = 0; i < trees.n; i++ )
+        order[start[key[i] - low]++] = i;
+
+    return order;
+}
+
+// order of trees grouping them by division then species
+std::vector<std::size_t> species_order( const TREE_BATCH &trees )
+{
+    return species_order( trees, tree_divisions( trees, dictionary_codes( trees ) ) );
+}
+
+// evaluate a batch in species order: each run of trees of one species and division is evaluated
+// with one plan, reading inputs and writing results at the trees' original positions. Trees are
+// taken in chunks evaluated stage by stage, as evaluate_chunk().
+static void evaluate_sorted( const TREE_BATCH &trees, const BATCH_RESULT &result, const BATCH_OPTIONS &options )
+{
+    std::vector<DIVISION> divisions = tree_divisions( trees, dictionary_codes( trees ) );
+    std::vector<std::size_t> order = species_order( trees, divisions );
+
+    bool want_biomass = result.wood || result.bark || result.branch || result.foliage || result.total || result.above_ground_biomass;
+    bool want_volib = result.volib || ( want_biomass && !trees.vtotib );
+
+    parallel_for( trees.n, options.threads, [&]( std::size_t begin, std::size_t end ) {
+        const PLAN_TABLE *table = trees.planted ? nullptr : plan_table();
+        NSVB_PLAN runs[BATCH_CHUNK];            // plan of each run of one species and division in the chunk
+        const NSVB_PLAN *plans[BATCH_CHUNK];
+        double vtotib[BATCH_CHUNK];
+        BIOMASS_COMP bc[BATCH_CHUNK];
+
+        for( std::size_t chunk = begin; chunk < end; chunk += BATCH_CHUNK )
+        {
+            std::size_t n = std::min( chunk + BATCH_CHUNK, end ) - chunk;
+            const std::size_t *tree = order.data() + chunk;
+
+            {
+                NSVB_TIME_STAGE( STAGE_RESOLVE_PLAN );
+
+                // plans are copied: a memo entry may be replaced by a later lookup
+                std::size_t r = 0;
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    std::size_t i = tree[k];
+                    if( k == 0 || trees.fia_spp[i] != trees.fia_spp[tree[k - 1]] || divisions[i] != divisions[tree[k - 1]]
+                        || tree_planted( trees, i ) != tree_planted( trees, tree[k - 1] ) )
+                        runs[r++] = table ? table->get( trees.fia_spp[i], divisions[i] )
+                                          : thread_memo().get( trees.fia_spp[i], divisions[i], tree_planted( trees, i ) );
+                    plans[k] = &runs[r - 1];
+                }
+            }
+
+            {
+                NSVB_TIME_STAGE( STAGE_VOLUME );
+
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    std::size_t i = tree[k];
+                    vtotib[k] = want_volib ? evaluate_component( *plans[k], COMP_VOLIB, trees.dbh[i], trees.height[i] ) : 0.0;
+                    if( result.volib )
+                        result.volib[i] = vtotib[k];
+                    if( result.volob )
+                        result.volob[i] = evaluate_component( *plans[k], COMP_VOLOB, trees.dbh[i], trees.height[i] );
+                    if( trees.vtotib )
+                        vtotib[k] = trees.vtotib[i];
+                }
+            }
+
+            if( !want_biomass )
+                continue;
+
+            {
+                NSVB_TIME_STAGE( STAGE_BIOMASS );
+
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    const NSVB_PLAN &p = *plans[k];
+                    double dbh = trees.dbh[tree[k]], height = trees.height[tree[k]];
+                    bc[k].wood = vtotib[k] * p.wood_sg * 62.4;
+                    bc[k].bark = evaluate_component( p, COMP_BARK, dbh, height );
+                    bc[k].branch = evaluate_component( p, COMP_BRANCH, dbh, height );
+                    bc[k].foliage = evaluate_component( p, COMP_FOLIAGE, dbh, height );
+                    bc[k].total = evaluate_component( p, COMP_TOTAL, dbh, height );
+                }
+            }
+
+            {
+                NSVB_TIME_STAGE( STAGE_REBALANCE );
+
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    rebalance( bc[k] );
+
+                    std::size_t i = tree[k];
+                    if( result.wood ) result.wood[i] = bc[k].wood;
+                    if( result.bark ) result.bark[i] = bc[k].bark;
+                    if( result.branch ) result.branch[i] = bc[k].branch;
+                    if( result.foliage ) result.foliage[i] = bc[k].foliage;
+                    if( result.total ) result.total[i] = bc[k].total;
+                    if( result.above_ground_biomass ) result.above_ground_biomass[i] = bc[k].above_ground_biomass;
+                }
+            }
+        }
+    } );
+}
+
+// evaluate volumes and biomass components for a batch of trees
+void evaluate_batch( const TREE_BATCH &trees, const BATCH_RESULT &result, const BATCH_OPTIONS &options )
+{
+    if( options.sort )
+    {
+        evaluate_sorted( trees, result, options );
+        return;
+    }
+
+    // map each dictionary entry once
+    std::vector<DIVISION> codes = dictionary_codes( trees );
+
+    // one captured reference keeps the body within std::function's local storage (no heap allocation)
+    struct {
+        const TREE_BATCH &trees;
+        const std::vector<DIVISION> &codes;
+        const BATCH_RESULT &result;
+    } batch{ trees, codes, result };
+
+    // each NUMA node's workers evaluate the trees of its slice with the node's copy of the plan table
+    if( options.numa && numa_nodes().size() > 1 )
+    {
+        numa_parallel_for( trees.n, options.threads, [&batch]( unsigned node, std::size_t begin, std::size_t end ) {
+            evaluate_chunk( batch.trees, batch.codes, batch.result, begin, end, plan_table( node ) );
+        } );
+        return;
+    }
+
+    parallel_for( trees.n, options.threads, [&batch]( std::size_t begin, std::size_t end ) {
+        evaluate_chunk( batch.trees, batch.codes, batch.result, begin, end, plan_table() );
+    } );
+}
@@ -0,0 +1,103 @@
+// National Scale Volume and Biomass estimators (NSVB) batch evaluation
+//
+// Evaluates columns of trees in chunks. Each chunk passes through the pipeline stages
+// resolve plan -> evaluate volume -> evaluate biomass -> rebalance, and results match
+// compute_volib(), compute_volob() and biomass_components() exactly.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_BATCH_HPP
+#define NSVB_BATCH_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "nsvb_plan.hpp"
+
+// Divisions may be given per tree (division), as a dictionary plus an index column (division_dictionary,
+// division_index) or as codes (division_codes); the first of division_codes, division_index and division
+// set is used. Dictionary entries are mapped to division codes once per batch.
+
+// trees evaluated per chunk of the pipeline
+constexpr std::size_t BATCH_CHUNK = 256;
+
+// column-oriented batch of trees; the columns are owned by the caller
+struct TREE_BATCH {
+    std::size_t n = 0;                          // number of trees
+    const int *fia_spp = nullptr;               // FIA species code
+    const std::string *division = nullptr;      // FIA ecological division (nullptr: blank for all trees)
+    const DIVISION *division_codes = nullptr;   // divisions already mapped with division_code() (used instead of division)
+    const std::string *division_dictionary = nullptr;   // distinct divisions (as R factor levels or Arrow dictionaries)
+    std::size_t division_dictionary_size = 0;
+    const int *division_index = nullptr;        // index of each tree's division in division_dictionary (out of range: blank)
+    const double *dbh = nullptr;                // dbh (inches)
+    const double *height = nullptr;             // total height (feet)
+    const double *vtotib = nullptr;             // total inside bark volume (cubic feet) (nullptr: computed with compute_volib() equations)
+    const bool *planted = nullptr;              // tree in a planted stand (nullptr: none; see resolve_plan())
+};
+
+// result columns of a batch; columns are owned by the caller and any may be nullptr when not wanted
+struct BATCH_RESULT {
+    double *volib = nullptr;                    // total cubic volume inside bark (cubic feet)
+    double *volob = nullptr;                    // total cubic volume outside bark (cubic feet)
+    double *wood = nullptr;                     // biomass components (pounds)
+    double *bark = nullptr;
+    double *branch = nullptr;
+    double *foliage = nullptr;
+    double *total = nullptr;
+    double *above_ground_biomass = nullptr;
+};
+
+// batch evaluation options
+struct BATCH_OPTIONS {
+    unsigned threads = 1;                       // worker threads (0: one per hardware thread)
+    bool sort = false;                          // evaluate in species_order() and scatter results back
+    bool numa = false;                          // pin workers per NUMA node, each evaluating the trees of its node's slice
+                                                // (see nsvb_numa.hpp; ignored when sort is set, which takes precedence)
+};
+
+// evaluate volumes and biomass components for a batch of trees
+void evaluate_batch( const TREE_BATCH &trees, const BATCH_RESULT &result, const BATCH_OPTIONS &options = {} );
+
+// division codes of the entries of a batch's division dictionary (empty unless division_index is
+// given without division_codes); map them once per batch and pass them to resolve_plans()
+std::vector<DIVISION> dictionary_codes( const TREE_BATCH &trees );
+
+// division codes of the entries of a batch's division dictionary into codes[0 .. division_dictionary_size)
+void dictionary_codes( const TREE_BATCH &trees, DIVISION *codes );
+
+// division of tree i of a batch given the codes of its dictionary entries (a dictionary index out
+// of range is a blank division, DIV_NONE)
+DIVISION tree_division( const TREE_BATCH &trees, const DIVISION *dictionary_codes, std::size_t i );
+
+// resolve the plans of trees [begin,end) of a batch into plans[0 .. end-begin), given the batch's dictionary_codes()
+void resolve_plans( const TREE_BATCH &trees, const std::vector<DIVISION> &dictionary_codes, std::size_t begin, std::size_t end,
+                    NSVB_PLAN *plans );
+
+// raw estimates (before rebalance()) of n trees with resolved plans into components[c][0 .. n) for each
+// COMPONENT c (nullptr: not wanted); the volume and biomass stages of evaluate_batch()
+void evaluate_components( const NSVB_PLAN *plans, const double *dbh, const double *height, std::size_t n,
+                          double *const components[COMP_COUNT] );
+
+// order of trees grouping them by division then species, species not in the reference table
+// grouped as 999 (a counting sort over the keys present, or
+// a comparison sort when those are spread wider than the batch; stable within a group);
+// the equation forms of a tree follow from its species and division, so each group shares one plan
+std::vector<std::size_t> species_order( const TREE_BATCH &trees );
+
+// a tree value as counted in plot and stand totals (rollup_plots(), plot_uncertainty(), TREE_LIST):
+// undefined (NaN) and infinite values are left out
+inline double total_value( double x )
+{
+    return std::isfinite( x ) ? x : 0.0;
+}
+
+// run body( begin, end ) over [0,count) in ranges of grain items using worker threads
+// (0: one per hardware thread). Exceptions thrown by body are rethrown in the caller.
+void parallel_for( std::size_t count, unsigned threads, const std::function<void( std::size_t, std::size_t )> &body,
+                   std::size_t grain = BATCH_CHUNK );
+
+#endif
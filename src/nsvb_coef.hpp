@@ -8,29 +8,11 @@
 
 #include <string>
 #include <unordered_map>
+#include "nsvb_coef_blob.hpp"
 
-// CRM2 coefficient structure
-struct COEFS {
-    int    equation;
-    bool   planted; 
-    double a;
-    double b;
-    double c;
-    double b2;
-    double a0;
-    double b0;
-    double b1;
-    double a1;
-    double c1;
-};
+// Source of the embedded coefficient blob: included only by tools/nsvb_coefgen.cpp (and tests
+// comparing the blob with these tables); the library reads the blob (nsvb_coef_blob.hpp).
 
-struct REFS {
-    int Jenkins_spcd;
-    double wood_sg;
-    double bark_sg;
-    double mc_pct_green_wood;
-    double mc_pct_green_bark;
-};
 
 const std::unordered_map<int,REFS> refs = {
     {10,{3,0.36,0.49,84,62.43}},            {11,{3,0.4,0.44,70,63.90909}},          {12,{3,0.33,0.4,118.54545,100.325}},   
@@ -0,0 +1,114 @@
+// National Scale Volume and Biomass estimators (NSVB) embedded coefficient tables
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <cstring>
+#include <stdexcept>
+#include "nsvb_coef_blob.hpp"
+
+// the blob embedded by nsvb_coef_blob.S (or the generated byte array)
+extern "C" const unsigned char nsvb_coef_blob[];
+
+// divisions with tables per component
+constexpr int MAX_DIVISIONS = 32;
+
+// views of the tables of the embedded blob
+struct COEF_TABLES {
+    REF_TABLE refs;
+    COEF_TABLE tables[COEF_KIND_COUNT][COMP_COUNT];
+    std::string_view division[COMP_COUNT][MAX_DIVISIONS];
+    COEF_TABLE division_tables[COMP_COUNT][MAX_DIVISIONS];
+    int divisions[COMP_COUNT] = {};
+
+    COEF_TABLES()
+    {
+        const COEF_BLOB_HEADER *h = reinterpret_cast<const COEF_BLOB_HEADER *>( nsvb_coef_blob );
+
+        if( std::memcmp( h->magic, COEF_BLOB_MAGIC, sizeof( h->magic ) ) || h->version != COEF_BLOB_VERSION )
+            throw std::runtime_error( "nsvb: coefficient blob is missing or of another version" );
+        if( h->byte_order != COEF_BLOB_BYTE_ORDER || h->coef_record_size != sizeof( COEF_RECORD ) || h->ref_record_size != sizeof( REF_RECORD ) )
+            throw std::runtime_error( "nsvb: coefficient blob was generated for another platform" );
+        if( h->bytes < sizeof( COEF_BLOB_HEADER ) ||
+            coef_blob_checksum( nsvb_coef_blob + sizeof( COEF_BLOB_HEADER ), h->bytes - sizeof( COEF_BLOB_HEADER ) ) != h->checksum )
+            throw std::runtime_error( "nsvb: coefficient blob checksum mismatch (the embedded tables are corrupt)" );
+
+        const COEF_TABLE_ENTRY *entry = reinterpret_cast<const COEF_TABLE_ENTRY *>( nsvb_coef_blob + sizeof( COEF_BLOB_HEADER ) );
+        for( std::uint32_t t = 0; t < h->tables; t++, entry++ )
+        {
+            const unsigned char *records = nsvb_coef_blob + entry->offset;
+            std::size_t record_size = entry->kind == COEF_REFS ? sizeof( REF_RECORD ) : sizeof( COEF_RECORD );
+
+            if( entry->kind >= COEF_KIND_COUNT || entry->component >= COMP_COUNT || entry->offset + entry->count * record_size > h->bytes )
+                throw std::runtime_error( "nsvb: coefficient blob table directory is corrupt" );
+
+            if( entry->kind == COEF_REFS )
+            {
+                refs = REF_TABLE( reinterpret_cast<const REF_RECORD *>( records ), entry->count );
+                continue;
+            }
+
+            COEF_TABLE table( reinterpret_cast<const COEF_RECORD *>( records ), entry->count );
+            if( entry->kind != COEF_DIVISION )
+            {
+                tables[entry->kind][entry->component] = table;
+                continue;
+            }
+
+            int &d = divisions[entry->component];
+            if( d == MAX_DIVISIONS )
+                throw std::runtime_error( "nsvb: coefficient blob has too many divisions" );
+            division[entry->component][d] = std::string_view( entry->division, strnlen( entry->division, sizeof( entry->division ) ) );
+            division_tables[entry->component][d++] = table;
+        }
+    }
+};
+
+// tables of the embedded blob (the header and checksum are checked on first use)
+static const COEF_TABLES &coef_tables()
+{
+    static const COEF_TABLES tables;
+    return tables;
+}
+
+// species reference data
+const REF_TABLE &ref_table()
+{
+    return coef_tables().refs;
+}
+
+// species, planted or Jenkins coefficients of a component
+const COEF_TABLE &coef_table( COEF_KIND kind, COMPONENT component )
+{
+    return coef_tables().tables[kind][component];
+}
+
+// coefficients of a component in a division, or nullptr when the division has no table
+const COEF_TABLE *division_coef_table( COMPONENT component, std::string_view division )
+{
+    const COEF_TABLES &t = coef_tables();
+
+    for( int d = 0; d < t.divisions[component]; d++ )
+        if( t.division[component][d] == division )
+            return &t.division_tables[component][d];
+
+    return nullptr;
+}
+
+// verify the embedded blob (throws on a bad header or checksum, as the first use of the tables)
+COEF_BLOB_INFO verify_coef_blob()
+{
+    coef_tables();
+
+    const COEF_BLOB_HEADER *h = reinterpret_cast<const COEF_BLOB_HEADER *>( nsvb_coef_blob );
+    COEF_BLOB_INFO info;
+
+    info.data = nsvb_coef_blob;
+    info.bytes = h->bytes;
+    info.version = h->version;
+    info.tables = h->tables;
+    info.checksum = h->checksum;
+    info.checksum_ok = coef_blob_checksum( nsvb_coef_blob + sizeof( COEF_BLOB_HEADER ), h->bytes - sizeof( COEF_BLOB_HEADER ) ) == h->checksum;
+
+    return info;
+}
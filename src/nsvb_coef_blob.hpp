@@ -0,0 +1,176 @@
+// National Scale Volume and Biomass estimators (NSVB) embedded coefficient tables
+//
+// The coefficient tables of nsvb_coef.hpp are converted at build time by tools/nsvb_coefgen.cpp
+// into a compact binary blob (header, table directory, records sorted by species) that is
+// embedded in the library (src/nsvb_coef_blob.S, or a generated byte array where the assembler
+// is not available). The records are read in place: first use only checks the header and
+// points views at the tables, so nothing is parsed, copied or allocated.
+//
+// Blob layout (native byte order and alignment, 8 byte aligned records):
+//   COEF_BLOB_HEADER
+//   COEF_TABLE_ENTRY x tables
+//   REF_RECORD or COEF_RECORD arrays, sorted by fia_spp
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_COEF_BLOB_HPP
+#define NSVB_COEF_BLOB_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// CRM2 coefficient structure
+struct COEFS {
+    int    equation;
+    bool   planted;
+    double a;
+    double b;
+    double c;
+    double b2;
+    double a0;
+    double b0;
+    double b1;
+    double a1;
+    double c1;
+};
+
+struct REFS {
+    int Jenkins_spcd;
+    double wood_sg;
+    double bark_sg;
+    double mc_pct_green_wood;
+    double mc_pct_green_bark;
+};
+
+// equations resolved in a plan
+enum COMPONENT {
+    COMP_BARK = 0,
+    COMP_BRANCH,
+    COMP_FOLIAGE,
+    COMP_TOTAL,
+    COMP_VOLIB,
+    COMP_VOLOB,
+    COMP_COUNT
+};
+
+// kinds of tables in the blob
+enum COEF_KIND : std::uint32_t {
+    COEF_REFS = 0,          // species reference data (REF_RECORD)
+    COEF_SPECIES,           // species coefficients of a component
+    COEF_PLANTED,           // planted stand coefficients of a component
+    COEF_JENKINS,           // Jenkins group coefficients of a component
+    COEF_DIVISION,          // coefficients of a component in an ecological division
+    COEF_KIND_COUNT
+};
+
+constexpr char COEF_BLOB_MAGIC[8] = { 'N', 'S', 'V', 'B', 'C', 'O', 'E', 'F' };
+constexpr std::uint32_t COEF_BLOB_VERSION = 1;
+constexpr std::uint32_t COEF_BLOB_BYTE_ORDER = 0x01020304;
+
+struct COEF_BLOB_HEADER {
+    char magic[8];                  // COEF_BLOB_MAGIC
+    std::uint32_t version;          // COEF_BLOB_VERSION
+    std::uint32_t byte_order;       // COEF_BLOB_BYTE_ORDER as written
+    std::uint32_t coef_record_size; // sizeof( COEF_RECORD )
+    std::uint32_t ref_record_size;  // sizeof( REF_RECORD )
+    std::uint32_t tables;           // entries in the table directory
+    std::uint32_t checksum;         // coef_blob_checksum() of the bytes after the header
+    std::uint64_t bytes;            // size of the blob
+};
+
+struct COEF_TABLE_ENTRY {
+    std::uint32_t kind;             // COEF_KIND
+    std::uint32_t component;        // COMPONENT (0 for COEF_REFS)
+    char division[8];               // division of a COEF_DIVISION table (NUL padded)
+    std::uint64_t offset;           // first record, from the start of the blob
+    std::uint64_t count;            // records
+};
+
+struct COEF_RECORD {
+    std::int32_t fia_spp;           // FIA species code (Jenkins group for COEF_JENKINS)
+    COEFS coefs;
+};
+
+struct REF_RECORD {
+    std::int32_t fia_spp;
+    REFS refs;
+};
+
+// view of a table of records sorted by species
+template <typename RECORD>
+class SPECIES_TABLE {
+public:
+    SPECIES_TABLE() = default;
+    SPECIES_TABLE( const RECORD *records, std::size_t count ) : first( records ), n( count ) {}
+
+    const RECORD *begin() const { return first; }
+    const RECORD *end() const { return first + n; }
+    std::size_t size() const { return n; }
+
+    // record of a species, or nullptr
+    const RECORD *find( int fia_spp ) const
+    {
+        const RECORD *r = std::lower_bound( first, first + n, fia_spp, []( const RECORD &x, int spp ) { return x.fia_spp < spp; } );
+        return r != first + n && r->fia_spp == fia_spp ? r : nullptr;
+    }
+
+private:
+    const RECORD *first = nullptr;
+    std::size_t n = 0;
+};
+
+using COEF_TABLE = SPECIES_TABLE<COEF_RECORD>;
+using REF_TABLE = SPECIES_TABLE<REF_RECORD>;
+
+// species reference data
+const REF_TABLE &ref_table();
+
+// reference data of a species, or nullptr
+inline const REFS *find_refs( int fia_spp )
+{
+    const REF_RECORD *r = ref_table().find( fia_spp );
+    return r ? &r->refs : nullptr;
+}
+
+// species, planted or Jenkins coefficients of a component
+const COEF_TABLE &coef_table( COEF_KIND kind, COMPONENT component );
+
+// coefficients of a component in a division, or nullptr when the division has no table
+const COEF_TABLE *division_coef_table( COMPONENT component, std::string_view division );
+
+// coefficients of a species in a table, or nullptr
+inline const COEFS *find_coefs( const COEF_TABLE &table, int fia_spp )
+{
+    const COEF_RECORD *r = table.find( fia_spp );
+    return r ? &r->coefs : nullptr;
+}
+
+// checksum of blob bytes (FNV-1a, 32 bit)
+inline std::uint32_t coef_blob_checksum( const unsigned char *data, std::size_t bytes )
+{
+    std::uint32_t hash = 2166136261u;
+
+    for( std::size_t i = 0; i < bytes; i++ )
+        hash = ( hash ^ data[i] ) * 16777619u;
+
+    return hash;
+}
+
+// embedded blob
+struct COEF_BLOB_INFO {
+    const unsigned char *data = nullptr;
+    std::uint64_t bytes = 0;
+    std::uint32_t version = 0;
+    std::uint32_t tables = 0;
+    std::uint32_t checksum = 0;     // checksum in the header
+    bool checksum_ok = false;       // checksum of the bytes equals the header
+};
+
+// verify the embedded blob; like the first use of the tables, throws std::runtime_error when its
+// header or checksum does not match
+COEF_BLOB_INFO verify_coef_blob();
+
+#endif
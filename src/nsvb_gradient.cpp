@@ -0,0 +1,99 @@
+// National Scale Volume and Biomass estimators (NSVB) analytic derivatives
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include "nsvb_gradient.hpp"
+
+// derivative of a rebalanced component x * total / sum
+static double rebalanced_derivative( double x, double dx, double total, double dtotal, double sum, double dsum )
+{
+    return ( dx * total + x * dtotal ) / sum - x * total * dsum / ( sum * sum );
+}
+
+// values and derivatives of a tree
+TREE_GRADIENT tree_gradient( const NSVB_PLAN &plan, double dbh, double height, const double *vtotib )
+{
+    TREE_GRADIENT g;
+
+    g.volib = component_gradient( plan, COMP_VOLIB, dbh, height );
+    g.volob = component_gradient( plan, COMP_VOLOB, dbh, height );
+    g.bark = component_gradient( plan, COMP_BARK, dbh, height );
+    g.branch = component_gradient( plan, COMP_BRANCH, dbh, height );
+    g.foliage = component_gradient( plan, COMP_FOLIAGE, dbh, height );
+    g.total = component_gradient( plan, COMP_TOTAL, dbh, height );
+
+    // wood as in biomass_components() (same order of multiplication)
+    double f = plan.wood_sg * 62.4;
+    if( vtotib )
+        g.wood.value = *vtotib * plan.wood_sg * 62.4;
+    else
+    {
+        g.wood.value = g.volib.value * plan.wood_sg * 62.4;
+        g.wood.d_dbh = g.volib.d_dbh * f;
+        g.wood.d_height = g.volib.d_height * f;
+    }
+
+    // rebalance (values with the same arithmetic as biomass_components())
+    BIOMASS_COMP bc;
+    bc.wood = g.wood.value;
+    bc.bark = g.bark.value;
+    bc.branch = g.branch.value;
+    bc.foliage = g.foliage.value;
+    bc.total = g.total.value;
+    rebalance( bc );
+
+    double sum = g.wood.value + g.bark.value + g.branch.value;
+    double sum_dbh = g.wood.d_dbh + g.bark.d_dbh + g.branch.d_dbh;
+    double sum_height = g.wood.d_height + g.bark.d_height + g.branch.d_height;
+
+    for( GRADIENT *x : { &g.wood, &g.bark, &g.branch } )
+    {
+        x->d_dbh = rebalanced_derivative( x->value, x->d_dbh, g.total.value, g.total.d_dbh, sum, sum_dbh );
+        x->d_height = rebalanced_derivative( x->value, x->d_height, g.total.value, g.total.d_height, sum, sum_height );
+    }
+    g.wood.value = bc.wood;
+    g.bark.value = bc.bark;
+    g.branch.value = bc.branch;
+
+    g.above_ground_biomass.value = bc.above_ground_biomass;
+    g.above_ground_biomass.d_dbh = g.total.d_dbh + g.foliage.d_dbh;
+    g.above_ground_biomass.d_height = g.total.d_height + g.foliage.d_height;
+
+    return g;
+}
+
+// store one field of a tree's gradient in the result columns that are wanted
+static void store( const BATCH_RESULT &r, std::size_t j, const TREE_GRADIENT &g, double GRADIENT::*field )
+{
+    if( r.volib ) r.volib[j] = g.volib.*field;
+    if( r.volob ) r.volob[j] = g.volob.*field;
+    if( r.wood ) r.wood[j] = g.wood.*field;
+    if( r.bark ) r.bark[j] = g.bark.*field;
+    if( r.branch ) r.branch[j] = g.branch.*field;
+    if( r.foliage ) r.foliage[j] = g.foliage.*field;
+    if( r.total ) r.total[j] = g.total.*field;
+    if( r.above_ground_biomass ) r.above_ground_biomass[j] = g.above_ground_biomass.*field;
+}
+
+// evaluate a batch with derivatives
+void evaluate_batch_gradient( const TREE_BATCH &trees, const BATCH_RESULT &value, const BATCH_RESULT &d_dbh,
+                              const BATCH_RESULT &d_height, const BATCH_OPTIONS &options )
+{
+    std::vector<DIVISION> codes = dictionary_codes( trees );
+
+    parallel_for( trees.n, options.threads, [&]( std::size_t begin, std::size_t end ) {
+        NSVB_PLAN plans[BATCH_CHUNK];
+
+        resolve_plans( trees, codes, begin, end, plans );
+
+        for( std::size_t i = begin; i < end; i++ )
+        {
+            TREE_GRADIENT g = tree_gradient( plans[i - begin], trees.dbh[i], trees.height[i], trees.vtotib ? trees.vtotib + i : nullptr );
+
+            store( value, i, g, &GRADIENT::value );
+            store( d_dbh, i, g, &GRADIENT::d_dbh );
+            store( d_height, i, g, &GRADIENT::d_height );
+        }
+    } );
+}
@@ -0,0 +1,78 @@
+// National Scale Volume and Biomass estimators (NSVB) analytic derivatives
+//
+// Every equation form is a power law in dbh and height (form 50 with an exp(-b2 * dbh) term),
+// so the partial derivatives follow from the value:
+//      d/d dbh = value * ( b / dbh - b2 )      d/d height = value * c / height
+// with b = b0 or b1 on either side of k for form 4. The rebalanced components
+// x * total / ( wood + bark + branch ) are differentiated with the quotient rule.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_GRADIENT_HPP
+#define NSVB_GRADIENT_HPP
+
+#include "nsvb_batch.hpp"
+
+// value of an estimate and its partial derivatives
+struct GRADIENT {
+    double value = 0.0;
+    double d_dbh = 0.0;             // per inch
+    double d_height = 0.0;          // per foot
+};
+
+// values and derivatives of the volumes and biomass components of a tree
+struct TREE_GRADIENT {
+    GRADIENT volib;
+    GRADIENT volob;
+    GRADIENT wood;
+    GRADIENT bark;
+    GRADIENT branch;
+    GRADIENT foliage;
+    GRADIENT total;
+    GRADIENT above_ground_biomass;
+};
+
+// value and derivatives of a component of a plan (value identical to evaluate_component())
+inline GRADIENT component_gradient( const NSVB_PLAN &plan, COMPONENT component, double dbh, double height )
+{
+    GRADIENT g;
+    const COEFS *c = plan.coefs[component];
+
+    if( !c )
+        return g;
+
+    g.value = biomass( plan.eq_spp[component], *c, plan.wood_sg, dbh, height );
+
+    switch( c->equation ) {
+        case 3:
+        case 31:
+            g.d_dbh = g.value * c->b / dbh;
+            g.d_height = g.value * c->c / height;
+            break;
+        case 4: {
+            double k = plan.eq_spp[component] < 300 ? 9.0 : 11.0;
+
+            g.d_dbh = g.value * ( dbh < k ? c->b0 : c->b1 ) / dbh;
+            g.d_height = g.value * c->c / height;
+            break; }
+        case 50:
+            g.d_dbh = g.value * ( c->b / dbh - c->b2 );
+            g.d_height = g.value * c->c / height;
+            break;
+    }
+
+    return g;
+}
+
+// values and derivatives of a tree
+//  vtotib : total inside bark volume (nullptr: computed with the volib equation and differentiated through wood)
+// values are identical to compute_volib(), compute_volob() and biomass_components()
+TREE_GRADIENT tree_gradient( const NSVB_PLAN &plan, double dbh, double height, const double *vtotib = nullptr );
+
+// evaluate a batch with derivatives; value, d_dbh and d_height are result columns as for evaluate_batch()
+// (any column may be nullptr). When trees.vtotib is given wood does not depend on dbh or height.
+void evaluate_batch_gradient( const TREE_BATCH &trees, const BATCH_RESULT &value, const BATCH_RESULT &d_dbh,
+                              const BATCH_RESULT &d_height, const BATCH_OPTIONS &options = {} );
+
+#endif
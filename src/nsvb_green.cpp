@@ -0,0 +1,143 @@
+// National Scale Volume and Biomass estimators (NSVB) green weight
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nsvb_batch.hpp"
+#include "nsvb_green.hpp"
+
+// items evaluated per chunk: factors of a chunk are gathered into local columns first
+constexpr std::size_t GREEN_CHUNK = BATCH_CHUNK;
+
+// green weight factors of every species code up to the largest in refs
+class GREEN_TABLE {
+public:
+    GREEN_TABLE()
+    {
+        const REF_TABLE &refs = ref_table();
+        other = green_factors( *find_refs( 999 ) );
+        factors.assign( refs.size() ? refs.end()[-1].fia_spp + 1 : 0, other );
+        for( const REF_RECORD &r : refs )
+            if( r.fia_spp >= 0 )
+                factors[r.fia_spp] = green_factors( r.refs );
+    }
+
+    const GREEN_FACTORS &get( int fia_spp ) const
+    {
+        return fia_spp >= 0 && static_cast<std::size_t>( fia_spp ) < factors.size() ? factors[fia_spp] : other;
+    }
+
+private:
+    std::vector<GREEN_FACTORS> factors;
+    GREEN_FACTORS other;                    // species 999
+};
+
+static const GREEN_TABLE &green_table()
+{
+    static const GREEN_TABLE table;
+    return table;
+}
+
+// green weight factors of a species
+const GREEN_FACTORS &species_green_factors( int fia_spp )
+{
+    return green_table().get( fia_spp );
+}
+
+// gather the factors of items [begin,end)
+static void gather_factors( const GREEN_TABLE &table, const int *fia_spp, std::size_t begin, std::size_t end, double *wood, double *bark )
+{
+    for( std::size_t i = begin; i < end; i++ )
+    {
+        const GREEN_FACTORS &f = table.get( fia_spp[i] );
+        wood[i - begin] = f.wood;
+        bark[i - begin] = f.bark;
+    }
+}
+
+// green tons outside bark of n stems or logs
+void compute_green_tons( std::size_t n, const int *fia_spp, const double *cfvolob, const double *cfvolib, double *tons )
+{
+    const GREEN_TABLE &table = green_table();
+    double wood[GREEN_CHUNK], bark[GREEN_CHUNK];
+
+    for( std::size_t begin = 0; begin < n; begin += GREEN_CHUNK )
+    {
+        std::size_t end = std::min( n, begin + GREEN_CHUNK ), m = end - begin;
+        gather_factors( table, fia_spp, begin, end, wood, bark );
+
+        const double *vob = cfvolob + begin, *vib = cfvolib + begin;
+        double *t = tons + begin;
+        for( std::size_t i = 0; i < m; i++ )
+            t[i] = vib[i] * wood[i] + ( vob[i] - vib[i] ) * bark[i];
+    }
+}
+
+// green tons of n logs summed by product class
+void green_tons_by_class( std::size_t n, const int *fia_spp, const double *cfvolob, const double *cfvolib, const int *product,
+                          std::size_t classes, double *class_tons, double *tons )
+{
+    double chunk[GREEN_CHUNK];
+
+    for( std::size_t begin = 0; begin < n; begin += GREEN_CHUNK )
+    {
+        std::size_t end = std::min( n, begin + GREEN_CHUNK );
+        double *t = tons ? tons + begin : chunk;
+        compute_green_tons( end - begin, fia_spp + begin, cfvolob + begin, cfvolib + begin, t );
+
+        for( std::size_t i = begin; i < end; i++ )
+        {
+            int c = product[i];
+            if( c >= 0 && static_cast<std::size_t>( c ) < classes && !std::isnan( t[i - begin] ) )
+                class_tons[c] += t[i - begin];
+        }
+    }
+}
+
+// add n log values to a stem sum in order, leaving out NaN
+static double sum_logs( double sum, const double *x, std::size_t n )
+{
+    for( std::size_t i = 0; i < n; i++ )
+        if( !std::isnan( x[i] ) )
+            sum += x[i];
+    return sum;
+}
+
+// green tons and volumes of the logs of merchandized stems
+void evaluate_stem_logs( const STEM_LOGS &stems, const STEM_LOGS_RESULT &result )
+{
+    for( std::size_t s = 0; s < stems.stems; s++ )
+        if( stems.offsets[s + 1] < stems.offsets[s] )
+            throw std::runtime_error( "evaluate_stem_logs: log offsets of stem " + std::to_string( s ) + " decrease" );
+
+    const GREEN_TABLE &table = green_table();
+    double chunk[GREEN_CHUNK];
+
+    for( std::size_t s = 0; s < stems.stems; s++ )
+    {
+        const GREEN_FACTORS f = table.get( stems.fia_spp[s] );
+        std::size_t begin = stems.offsets[s], end = stems.offsets[s + 1];
+        const double *vob = stems.cfvolob, *vib = stems.cfvolib;
+
+        // log tons, in chunks of a local column when they are not wanted
+        double tons = 0.0;
+        for( std::size_t first = begin; first < end; first += GREEN_CHUNK )
+        {
+            std::size_t last = std::min( end, first + GREEN_CHUNK );
+            double *t = result.log_tons ? result.log_tons + first : chunk;
+            for( std::size_t i = first; i < last; i++ )
+                t[i - first] = vib[i] * f.wood + ( vob[i] - vib[i] ) * f.bark;
+            if( result.stem_tons )
+                tons = sum_logs( tons, t, last - first );
+        }
+
+        if( result.stem_tons ) result.stem_tons[s] = tons;
+        if( result.stem_volob ) result.stem_volob[s] = sum_logs( 0.0, vob + begin, end - begin );
+        if( result.stem_volib ) result.stem_volib[s] = sum_logs( 0.0, vib + begin, end - begin );
+    }
+}
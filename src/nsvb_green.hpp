@@ -0,0 +1,77 @@
+// National Scale Volume and Biomass estimators (NSVB) green weight
+//
+// compute_green_tons() looks up a species and converts its specific gravities and green moisture
+// contents to weights on every call. Here the conversion is folded once per species into
+// GREEN_FACTORS (also kept in each NSVB_PLAN), held in a dense table by species code, so the
+// green tons of a stem or log are two multiply-adds (fused when the build targets FMA):
+//
+//     green tons = volib * wood + (volob - volib) * bark
+//
+// Batch functions gather the factors of a chunk of items, then evaluate the chunk in a loop free
+// of lookups and branches that the compiler vectorizes.
+//
+// Folding the constants changes the rounding only: results agree with compute_green_tons()
+// within 1e-15 of the size of the wood and bark terms (a few units in the last place), as
+// nsvb_validate checks.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_GREEN_HPP
+#define NSVB_GREEN_HPP
+
+#include <cstddef>
+#include "nsvb_plan.hpp"
+
+// green weight factors of a species (unknown species use 999, as compute_green_tons())
+const GREEN_FACTORS &species_green_factors( int fia_spp );
+
+// green tons outside bark given outside and inside bark volumes (cubic feet)
+inline double green_tons( const GREEN_FACTORS &f, double cfvolob, double cfvolib )
+{
+    return cfvolib * f.wood + ( cfvolob - cfvolib ) * f.bark;
+}
+
+// green tons of a tree evaluated with a plan
+inline double evaluate_green_tons( const NSVB_PLAN &plan, double cfvolob, double cfvolib )
+{
+    return green_tons( plan.green, cfvolob, cfvolib );
+}
+
+// green tons outside bark of n stems or logs (compute_green_tons() of each)
+//  fia_spp : FIA species code
+//  cfvolob, cfvolib : outside and inside bark volumes (cubic feet)
+//  tons : result
+void compute_green_tons( std::size_t n, const int *fia_spp, const double *cfvolob, const double *cfvolib, double *tons );
+
+// green tons of n logs summed by product class (log bucket)
+//  product : class of each log; logs of classes outside [0,classes) are left out
+//  class_tons : classes totals, added to (undefined (NaN) log weights are left out)
+//  tons : green tons of each log (nullptr: not wanted)
+void green_tons_by_class( std::size_t n, const int *fia_spp, const double *cfvolob, const double *cfvolib, const int *product,
+                          std::size_t classes, double *class_tons, double *tons = nullptr );
+
+// merchandized stems: the logs of stem s are [offsets[s], offsets[s + 1]) of the log columns
+struct STEM_LOGS {
+    std::size_t stems = 0;                      // number of stems
+    const int *fia_spp = nullptr;               // FIA species code of each stem
+    const std::size_t *offsets = nullptr;       // stems + 1 nondecreasing log offsets
+    const double *cfvolob = nullptr;            // outside bark volume of each log (cubic feet)
+    const double *cfvolib = nullptr;            // inside bark volume of each log (cubic feet)
+};
+
+// result columns of merchandized stems; columns are owned by the caller and any may be nullptr when not wanted
+struct STEM_LOGS_RESULT {
+    double *log_tons = nullptr;                 // green tons of each log
+    double *stem_tons = nullptr;                // green tons of each stem (sum of its logs)
+    double *stem_volob = nullptr;               // outside bark volume of each stem (sum of its logs)
+    double *stem_volib = nullptr;               // inside bark volume of each stem (sum of its logs)
+};
+
+// green tons and volumes of the logs of merchandized stems in one pass, the species factors
+// resolved once per stem. Log tons are those of compute_green_tons( n, ... ); stem totals are
+// summed in log order and leave out undefined (NaN) log values. Throws std::runtime_error when
+// offsets decrease.
+void evaluate_stem_logs( const STEM_LOGS &stems, const STEM_LOGS_RESULT &result );
+
+#endif
@@ -0,0 +1,166 @@
+// National Scale Volume and Biomass estimators (NSVB) inverse solvers
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cmath>
+#include "nsvb_inverse.hpp"
+
+// equation solved in closed form (or used for the starting value) for a target
+static COMPONENT target_component( INVERSE_TARGET target )
+{
+    switch( target ) {
+        case INVERSE_VOLIB: return COMP_VOLIB;
+        case INVERSE_VOLOB: return COMP_VOLOB;
+        default: return COMP_TOTAL;
+    }
+}
+
+// value and derivatives of a target quantity of a plan
+GRADIENT target_gradient( const NSVB_PLAN &plan, INVERSE_TARGET target, double dbh, double height )
+{
+    GRADIENT g = component_gradient( plan, target_component( target ), dbh, height );
+
+    if( target == INVERSE_AGB )
+    {
+        GRADIENT foliage = component_gradient( plan, COMP_FOLIAGE, dbh, height );
+
+        g.value += foliage.value;
+        g.d_dbh += foliage.d_dbh;
+        g.d_height += foliage.d_height;
+    }
+
+    return g;
+}
+
+// height at which a single equation reaches value (all forms are A( dbh ) * height^c, and c
+// may be negative)
+static double closed_form_height( const NSVB_PLAN &plan, COMPONENT component, double value, double dbh )
+{
+    const COEFS *c = plan.coefs[component];
+    if( !c || c->c == 0.0 )
+        return NAN;
+
+    double y1 = evaluate_component( plan, component, dbh, 1.0 );
+
+    return y1 > 0.0 ? std::pow( value / y1, 1.0 / c->c ) : NAN;
+}
+
+// dbh at which a single equation reaches value; for form 50 the exp(-b2 * dbh) term is
+// ignored, giving a starting value for Newton's method
+static double closed_form_dbh( const NSVB_PLAN &plan, COMPONENT component, double value, double height )
+{
+    const COEFS *c = plan.coefs[component];
+    if( !c )
+        return NAN;
+
+    double b = c->b;
+    double scale = 1.0;
+    double y = evaluate_component( plan, component, 1.0, height );
+
+    if( c->equation == 4 )
+    {
+        double k = plan.eq_spp[component] < 300 ? 9.0 : 11.0;
+        double yk = evaluate_component( plan, component, k, height );
+
+        if( value < yk )
+            b = c->b0;
+        else
+        {
+            b = c->b1;
+            scale = k;
+            y = yk;
+        }
+    }
+    else if( c->equation == 50 )
+        y *= std::exp( c->b2 );
+
+    return y > 0.0 && b > 0.0 ? scale * std::pow( value / y, 1.0 / b ) : NAN;
+}
+
+// Newton's method on log( value ) against log( dbh ) or log( height ), which is linear for
+// a power law and so converges in a few steps from the closed form of the total equation
+static double newton( const NSVB_PLAN &plan, INVERSE_TARGET target, double value, double x, bool solve_dbh, double known,
+                      const INVERSE_OPTIONS &options )
+{
+    if( !( x > 0.0 ) || !std::isfinite( x ) )
+        x = solve_dbh ? 10.0 : 50.0;
+
+    for( int iteration = 0; iteration < options.max_iterations; iteration++ )
+    {
+        GRADIENT g = solve_dbh ? target_gradient( plan, target, x, known ) : target_gradient( plan, target, known, x );
+        if( !( g.value > 0.0 ) )
+            return NAN;
+
+        double r = std::log( g.value / value );
+        if( std::fabs( r ) <= options.tolerance )
+            return x;
+
+        // d log( value ) / d log( x ); zero at the maximum of form 50
+        double slope = x * ( solve_dbh ? g.d_dbh : g.d_height ) / g.value;
+        if( slope == 0.0 || !std::isfinite( slope ) )
+            return NAN;
+
+        x *= std::exp( std::clamp( -r / slope, -2.0, 2.0 ) );
+    }
+
+    return NAN;
+}
+
+// height (feet) at which a tree of a given dbh reaches target_value
+double solve_height( const NSVB_PLAN &plan, INVERSE_TARGET target, double target_value, double dbh, const INVERSE_OPTIONS &options )
+{
+    if( !( target_value > 0.0 ) )
+        return NAN;
+
+    double height = closed_form_height( plan, target_component( target ), target_value, dbh );
+
+    return target == INVERSE_AGB ? newton( plan, target, target_value, height, false, dbh, options ) : height;
+}
+
+// dbh (inches) at which a tree of a given height reaches target_value
+double solve_dbh( const NSVB_PLAN &plan, INVERSE_TARGET target, double target_value, double height, const INVERSE_OPTIONS &options )
+{
+    if( !( target_value > 0.0 ) )
+        return NAN;
+
+    COMPONENT component = target_component( target );
+    double dbh = closed_form_dbh( plan, component, target_value, height );
+
+    if( target == INVERSE_AGB || ( plan.coefs[component] && plan.coefs[component]->equation == 50 ) )
+        return newton( plan, target, target_value, dbh, true, height, options );
+
+    return dbh;
+}
+
+// batch solvers
+void solve_height( const TREE_BATCH &trees, INVERSE_TARGET target, const double *target_value, double *height,
+                   const INVERSE_OPTIONS &options )
+{
+    std::vector<DIVISION> codes = dictionary_codes( trees );
+
+    parallel_for( trees.n, options.threads, [&]( std::size_t begin, std::size_t end ) {
+        NSVB_PLAN plans[BATCH_CHUNK];
+
+        resolve_plans( trees, codes, begin, end, plans );
+
+        for( std::size_t i = begin; i < end; i++ )
+            height[i] = solve_height( plans[i - begin], target, target_value[i], trees.dbh[i], options );
+    } );
+}
+
+void solve_dbh( const TREE_BATCH &trees, INVERSE_TARGET target, const double *target_value, double *dbh,
+                const INVERSE_OPTIONS &options )
+{
+    std::vector<DIVISION> codes = dictionary_codes( trees );
+
+    parallel_for( trees.n, options.threads, [&]( std::size_t begin, std::size_t end ) {
+        NSVB_PLAN plans[BATCH_CHUNK];
+
+        resolve_plans( trees, codes, begin, end, plans );
+
+        for( std::size_t i = begin; i < end; i++ )
+            dbh[i] = solve_dbh( plans[i - begin], target, target_value[i], trees.height[i], options );
+    } );
+}
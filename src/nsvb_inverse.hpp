@@ -0,0 +1,52 @@
+// National Scale Volume and Biomass estimators (NSVB) inverse solvers
+//
+// Solve for the height (given dbh) or the dbh (given height) at which a tree reaches a target
+// volume or biomass. The equations are monotone power laws in dbh and height, so:
+//  - height for a single equation: value = A( dbh ) * height^c, solved in closed form
+//  - dbh for forms 3 and 31: value = A( height ) * dbh^b, closed form; form 4 picks the b0 or
+//    b1 branch by comparing the target with the value at k
+//  - dbh for form 50 and above ground biomass (total + foliage): Newton's method in log space
+//    using the analytic derivatives of nsvb_gradient.hpp, started from the closed form of the
+//    total equation
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_INVERSE_HPP
+#define NSVB_INVERSE_HPP
+
+#include "nsvb_gradient.hpp"
+
+// quantities that can be inverted
+enum INVERSE_TARGET {
+    INVERSE_VOLIB = 0,              // total cubic volume inside bark (cubic feet)
+    INVERSE_VOLOB,                  // total cubic volume outside bark (cubic feet)
+    INVERSE_TOTAL,                  // total biomass (pounds)
+    INVERSE_AGB                     // above ground biomass (total + foliage) (pounds)
+};
+
+// solver options
+struct INVERSE_OPTIONS {
+    unsigned threads = 1;           // worker threads (0: one per hardware thread)
+    double tolerance = 1e-12;       // relative error of the value at the solution for Newton's method
+    int max_iterations = 50;
+};
+
+// value and derivatives of a target quantity of a plan
+GRADIENT target_gradient( const NSVB_PLAN &plan, INVERSE_TARGET target, double dbh, double height );
+
+// height (feet) at which a tree of a given dbh reaches target_value (NaN when there is no solution,
+// e.g. woodland species or a target that is zero)
+double solve_height( const NSVB_PLAN &plan, INVERSE_TARGET target, double target_value, double dbh, const INVERSE_OPTIONS &options = {} );
+
+// dbh (inches) at which a tree of a given height reaches target_value (NaN when there is no solution)
+double solve_dbh( const NSVB_PLAN &plan, INVERSE_TARGET target, double target_value, double height, const INVERSE_OPTIONS &options = {} );
+
+// batch solvers; trees.dbh (for solve_height) or trees.height (for solve_dbh) hold the known
+// measurement, target_value one target per tree and the solutions are written to height or dbh
+void solve_height( const TREE_BATCH &trees, INVERSE_TARGET target, const double *target_value, double *height,
+                   const INVERSE_OPTIONS &options = {} );
+void solve_dbh( const TREE_BATCH &trees, INVERSE_TARGET target, const double *target_value, double *dbh,
+                const INVERSE_OPTIONS &options = {} );
+
+#endif
@@ -0,0 +1,274 @@
+// National Scale Volume and Biomass estimators (NSVB) NUMA aware scheduling
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include "nsvb_numa.hpp"
+
+#if defined( __linux__ )
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#if defined( __linux__ )
+// numbers of a sysfs list ("0-3,8,10-11"), empty when the file is missing
+static std::vector<int> read_list( const std::string &path )
+{
+    std::ifstream is( path );
+    std::string text;
+    std::vector<int> numbers;
+
+    if( !std::getline( is, text ) )
+        return numbers;
+
+    std::size_t p = 0;
+    while( p < text.size() )
+    {
+        std::size_t comma = text.find( ',', p );
+        std::string item = text.substr( p, comma == std::string::npos ? std::string::npos : comma - p );
+        p = comma == std::string::npos ? text.size() : comma + 1;
+        if( item.empty() )
+            continue;
+
+        std::size_t dash = item.find( '-' );
+        int first = std::stoi( item.substr( 0, dash ) );
+        int last = dash == std::string::npos ? first : std::stoi( item.substr( dash + 1 ) );
+        for( int n = first; n <= last; n++ )
+            numbers.push_back( n );
+    }
+
+    return numbers;
+}
+
+static std::vector<NUMA_NODE> read_nodes()
+{
+    std::vector<NUMA_NODE> nodes;
+
+    cpu_set_t allowed;
+    CPU_ZERO( &allowed );
+    if( sched_getaffinity( 0, sizeof( allowed ), &allowed ) )
+        return nodes;
+
+    try {
+        for( int id : read_list( "/sys/devices/system/node/online" ) )
+        {
+            NUMA_NODE node;
+            node.id = id;
+            for( int cpu : read_list( "/sys/devices/system/node/node" + std::to_string( id ) + "/cpulist" ) )
+                if( cpu < CPU_SETSIZE && CPU_ISSET( cpu, &allowed ) )
+                    node.cpus.push_back( cpu );
+            if( !node.cpus.empty() && nodes.size() < NUMA_MAX_NODES )
+                nodes.push_back( node );
+        }
+    } catch( const std::exception & ) {
+        nodes.clear();
+    }
+
+    // without the topology: one node of the CPUs allowed
+    if( nodes.empty() )
+    {
+        NUMA_NODE node;
+        for( int cpu = 0; cpu < CPU_SETSIZE; cpu++ )
+            if( CPU_ISSET( cpu, &allowed ) )
+                node.cpus.push_back( cpu );
+        nodes.push_back( node );
+    }
+
+    return nodes;
+}
+#else
+static std::vector<NUMA_NODE> read_nodes()
+{
+    NUMA_NODE node;
+    for( unsigned cpu = 0; cpu < std::max( 1u, std::thread::hardware_concurrency() ); cpu++ )
+        node.cpus.push_back( static_cast<int>( cpu ) );
+
+    return { node };
+}
+#endif
+
+// nodes of this machine having CPUs available to the process
+const std::vector<NUMA_NODE> &numa_nodes()
+{
+    static const std::vector<NUMA_NODE> nodes = read_nodes();
+    return nodes;
+}
+
+// pin the calling thread to the CPUs of a node
+bool pin_to_node( const NUMA_NODE &node )
+{
+#if defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for( int cpu : node.cpus )
+        if( cpu >= 0 && cpu < CPU_SETSIZE )
+            CPU_SET( cpu, &set );
+
+    return !node.cpus.empty() && sched_setaffinity( 0, sizeof( set ), &set ) == 0;
+#else
+    (void) node;
+    return false;
+#endif
+}
+
+// split [0,count) into one slice per node in proportion to its workers
+std::vector<NUMA_SLICE> numa_partition( const std::vector<NUMA_NODE> &nodes, std::size_t count, unsigned threads, std::size_t grain )
+{
+    std::vector<NUMA_SLICE> slices( nodes.size() );
+    if( nodes.empty() )
+        return slices;
+
+    if( grain == 0 )
+        grain = 1;
+
+    std::size_t cpus = 0;
+    for( const auto &node : nodes )
+        cpus += std::max<std::size_t>( 1, node.cpus.size() );
+    if( threads == 0 )
+        threads = static_cast<unsigned>( cpus );
+
+    // each thread goes to the node with the fewest threads per CPU
+    for( unsigned t = 0; t < threads; t++ )
+    {
+        std::size_t best = 0;
+        for( std::size_t k = 1; k < nodes.size(); k++ )
+            if( slices[k].threads * std::max<std::size_t>( 1, nodes[best].cpus.size() )
+                < slices[best].threads * std::max<std::size_t>( 1, nodes[k].cpus.size() ) )
+                best = k;
+        slices[best].threads++;
+    }
+
+    // ranges of grain items in proportion to the threads
+    std::size_t ranges = ( count + grain - 1 ) / grain;
+    std::size_t before = 0;
+    for( auto &slice : slices )
+    {
+        slice.begin = std::min( ranges * before / threads * grain, count );
+        before += slice.threads;
+        slice.end = std::min( ranges * before / threads * grain, count );
+    }
+
+    return slices;
+}
+
+// run body( node, begin, end ) over [0,count) with each node's workers pinned to the node
+void numa_parallel_for( std::size_t count, unsigned threads, const std::function<void( unsigned, std::size_t, std::size_t )> &body,
+                        std::size_t grain, const std::vector<NUMA_NODE> &nodes )
+{
+    if( nodes.size() <= 1 )
+    {
+        parallel_for( count, threads, [&body]( std::size_t begin, std::size_t end ) { body( 0, begin, end ); }, grain );
+        return;
+    }
+
+    if( grain == 0 )
+        grain = 1;
+
+    std::vector<NUMA_SLICE> slices = numa_partition( nodes, count, threads, grain );
+    std::vector<std::atomic<std::size_t>> next( slices.size() );
+    for( std::size_t k = 0; k < slices.size(); k++ )
+        next[k] = slices[k].begin;
+
+    std::atomic<bool> stop{ false };
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]( unsigned k ) {
+        pin_to_node( nodes[k] );
+        try {
+            for( std::size_t begin = next[k].fetch_add( grain ); begin < slices[k].end && !stop; begin = next[k].fetch_add( grain ) )
+                body( k, begin, std::min( begin + grain, slices[k].end ) );
+        } catch( ... ) {
+            std::lock_guard<std::mutex> lock( error_mutex );
+            if( !error )
+                error = std::current_exception();
+            stop = true;
+        }
+    };
+
+    // the calling thread only waits, so its affinity is left alone
+    std::vector<std::thread> pool;
+    for( unsigned k = 0; k < slices.size(); k++ )
+        for( unsigned t = 0; t < slices[k].threads && slices[k].begin < slices[k].end; t++ )
+            pool.emplace_back( worker, k );
+    for( auto &t : pool )
+        t.join();
+
+    if( error )
+        std::rethrow_exception( error );
+}
+
+NUMA_BUFFER::NUMA_BUFFER( std::size_t count, std::size_t element_size, unsigned threads, const std::vector<NUMA_NODE> &nodes )
+    : size( count * element_size )
+{
+    if( size == 0 )
+        return;
+
+#if defined( __linux__ )
+    // anonymous pages are not backed until first written
+    memory = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( memory == MAP_FAILED )
+    {
+        memory = nullptr;
+        throw std::bad_alloc();
+    }
+#else
+    memory = ::operator new( size, std::align_val_t( 64 ) );
+#endif
+
+    unsigned char *bytes = static_cast<unsigned char *>( memory );
+    numa_parallel_for( count, threads, [&]( unsigned, std::size_t begin, std::size_t end ) {
+        std::memset( bytes + begin * element_size, 0, ( end - begin ) * element_size );
+    }, BATCH_CHUNK, nodes );
+}
+
+NUMA_BUFFER::~NUMA_BUFFER()
+{
+    if( !memory )
+        return;
+
+#if defined( __linux__ )
+    munmap( memory, size );
+#else
+    ::operator delete( memory, std::align_val_t( 64 ) );
+#endif
+}
+
+NUMA_BUFFER::NUMA_BUFFER( NUMA_BUFFER &&other ) noexcept
+    : memory( std::exchange( other.memory, nullptr ) ), size( std::exchange( other.size, 0 ) )
+{
+}
+
+NUMA_BUFFER &NUMA_BUFFER::operator=( NUMA_BUFFER &&other ) noexcept
+{
+    std::swap( memory, other.memory );
+    std::swap( size, other.size );
+    return *this;
+}
+
+// every result column of a batch of n trees
+NUMA_RESULT::NUMA_RESULT( std::size_t n, unsigned threads )
+{
+    double *BATCH_RESULT::*members[] = {
+        &BATCH_RESULT::volib, &BATCH_RESULT::volob, &BATCH_RESULT::wood, &BATCH_RESULT::bark,
+        &BATCH_RESULT::branch, &BATCH_RESULT::foliage, &BATCH_RESULT::total, &BATCH_RESULT::above_ground_biomass
+    };
+
+    buffers.reserve( std::size( members ) );
+    for( auto member : members )
+    {
+        buffers.emplace_back( n, sizeof( double ), threads );
+        columns.*member = buffers.back().as<double>();
+    }
+}
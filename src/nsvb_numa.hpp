@@ -0,0 +1,94 @@
+// National Scale Volume and Biomass estimators (NSVB) NUMA aware scheduling
+//
+// On machines with several NUMA nodes a batch is split into one contiguous slice per node, in
+// proportion to the workers run on the node, and each node's workers are pinned to its CPUs and
+// only process its slice. NUMA_BUFFER allocates columns without touching them and then writes
+// each node's slice from a worker on that node, so the kernel's first touch placement puts the
+// pages where they are processed; result (and, when a loader uses it, input) columns therefore
+// stay local. The small read only plan table is replicated per node (plan_table( node )).
+//
+// The topology is read from /sys/devices/system/node on Linux; elsewhere, or with one node,
+// numa_parallel_for() behaves as parallel_for().
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_NUMA_HPP
+#define NSVB_NUMA_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "nsvb_batch.hpp"
+
+// nodes with per node replicas
+constexpr unsigned NUMA_MAX_NODES = 64;
+
+// a NUMA node and its CPUs this process may run on
+struct NUMA_NODE {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// nodes of this machine having CPUs available to the process (one node with every CPU where the
+// topology is unknown); read once
+const std::vector<NUMA_NODE> &numa_nodes();
+
+// pin the calling thread to the CPUs of a node (false where not supported)
+bool pin_to_node( const NUMA_NODE &node );
+
+// the slice of a node: items [begin,end) processed by threads workers
+struct NUMA_SLICE {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    unsigned threads = 0;
+};
+
+// split [0,count) into one slice per node in proportion to its workers, at multiples of grain;
+// threads (0: every available CPU) are spread over the nodes by CPUs
+std::vector<NUMA_SLICE> numa_partition( const std::vector<NUMA_NODE> &nodes, std::size_t count, unsigned threads,
+                                        std::size_t grain = BATCH_CHUNK );
+
+// run body( node, begin, end ) over [0,count) in ranges of grain items, each node's workers pinned
+// to the node and processing its numa_partition() slice (node indexes nodes). Exceptions thrown by
+// body are rethrown in the caller.
+void numa_parallel_for( std::size_t count, unsigned threads, const std::function<void( unsigned, std::size_t, std::size_t )> &body,
+                        std::size_t grain = BATCH_CHUNK, const std::vector<NUMA_NODE> &nodes = numa_nodes() );
+
+// untouched memory for count elements, zeroed slice by slice by workers on the nodes that will
+// process them with numa_parallel_for( count, threads, ... )
+class NUMA_BUFFER {
+public:
+    NUMA_BUFFER( std::size_t count, std::size_t element_size, unsigned threads = 0,
+                 const std::vector<NUMA_NODE> &nodes = numa_nodes() );
+    ~NUMA_BUFFER();
+
+    NUMA_BUFFER( NUMA_BUFFER &&other ) noexcept;
+    NUMA_BUFFER &operator=( NUMA_BUFFER &&other ) noexcept;
+    NUMA_BUFFER( const NUMA_BUFFER & ) = delete;
+    NUMA_BUFFER &operator=( const NUMA_BUFFER & ) = delete;
+
+    template <typename T>
+    T *as() const { return static_cast<T *>( memory ); }
+
+    std::size_t bytes() const { return size; }
+
+private:
+    void *memory = nullptr;
+    std::size_t size = 0;
+};
+
+// every result column of a batch of n trees in NUMA_BUFFERs placed for evaluate_batch() with
+// BATCH_OPTIONS::numa and the same number of threads
+class NUMA_RESULT {
+public:
+    explicit NUMA_RESULT( std::size_t n, unsigned threads = 0 );
+
+    const BATCH_RESULT &result() const { return columns; }
+
+private:
+    std::vector<NUMA_BUFFER> buffers;
+    BATCH_RESULT columns;
+};
+
+#endif
@@ -0,0 +1,79 @@
+// National Scale Volume and Biomass estimators (NSVB) resolved coefficient plans
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <stdexcept>
+#include <string>
+#include "nsvb_plan.hpp"
+
+static const char *division_names[DIV_COUNT] = {
+    "",
+    "130", "210", "220", "230", "240", "250", "260", "310", "330", "340",
+    "M130", "M210", "M220", "M230", "M240", "M260", "M310", "M330", "M340"
+};
+
+// map a division string to its code (DIV_NONE if not recognized)
+DIVISION division_code( std::string_view division )
+{
+    for( int d = 1; d < DIV_COUNT; d++ )
+        if( division == division_names[d] )
+            return static_cast<DIVISION>( d );
+
+    return DIV_NONE;
+}
+
+// division string of a code ("" for DIV_NONE)
+const char *division_name( DIVISION division )
+{
+    return division < DIV_COUNT ? division_names[division] : "";
+}
+
+// select the coefficients of one component following the fallback chain of nsvb.cpp:
+//   division table -> species table -> Jenkins table -> 0.0 for woodland species
+// preceded by the planted table for trees in planted stands
+static void resolve_component( NSVB_PLAN &plan, COMPONENT component, int jspp, std::string_view division, bool planted )
+{
+    const COEFS *c = planted ? find_coefs( coef_table( COEF_PLANTED, component ), plan.fia_spp ) : nullptr;
+
+    if( !c && !division.empty() )
+        if( const COEF_TABLE *d = division_coef_table( component, division ) )
+            c = find_coefs( *d, plan.fia_spp );
+
+    if( !c )
+        c = find_coefs( coef_table( COEF_SPECIES, component ), plan.fia_spp );
+
+    if( c )
+    {
+        plan.coefs[component] = c;
+        plan.eq_spp[component] = plan.fia_spp;
+    } else if( jspp < 10 ) {
+        plan.coefs[component] = find_coefs( coef_table( COEF_JENKINS, component ), jspp );
+        if( !plan.coefs[component] )
+            throw std::out_of_range( "resolve_plan: no Jenkins coefficients for group " + std::to_string( jspp ) );
+        plan.eq_spp[component] = jspp;
+    } else {
+        plan.coefs[component] = nullptr;
+        plan.eq_spp[component] = jspp;
+    }
+}
+
+// resolve the coefficients for a species in a division
+NSVB_PLAN resolve_plan( int fia_spp, DIVISION division, bool planted )
+{
+    NSVB_PLAN plan;
+
+    // use other live tree species code if species not found
+    plan.fia_spp = find_refs( fia_spp ) ? fia_spp : 999;
+
+    const REFS &r = *find_refs( plan.fia_spp );
+    plan.wood_sg = r.wood_sg;
+    plan.green = green_factors( r );
+
+    std::string_view d = division_name( division );
+
+    for( int c = 0; c < COMP_COUNT; c++ )
+        resolve_component( plan, static_cast<COMPONENT>( c ), r.Jenkins_spcd, d, planted );
+
+    return plan;
+}
@@ -0,0 +1,104 @@
+// National Scale Volume and Biomass estimators (NSVB) resolved coefficient plans
+//
+// A plan holds the coefficients selected for a species and ecological division by the
+// fallback chain used in nsvb.cpp (division table -> species table -> Jenkins table -> woodland 0.0)
+// so a tree can be evaluated without any table lookups.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_PLAN_HPP
+#define NSVB_PLAN_HPP
+
+#include <string_view>
+#include "nsvb.hpp"
+
+// FIA ecological divisions found in the coefficient tables
+// DIV_NONE is used for a blank or unrecognized division
+enum DIVISION : unsigned char {
+    DIV_NONE = 0,
+    DIV_130, DIV_210, DIV_220, DIV_230, DIV_240, DIV_250, DIV_260, DIV_310, DIV_330, DIV_340,
+    DIV_M130, DIV_M210, DIV_M220, DIV_M230, DIV_M240, DIV_M260, DIV_M310, DIV_M330, DIV_M340,
+    DIV_COUNT
+};
+
+// green weight per unit volume (tons per cubic foot) of a species, folded from its specific
+// gravities and green moisture contents as in compute_green_tons()
+struct GREEN_FACTORS {
+    double wood = 0.0;                      // per cubic foot inside bark
+    double bark = 0.0;                      // per cubic foot of bark (outside less inside bark volume)
+};
+
+// green weight factors of species reference data
+inline GREEN_FACTORS green_factors( const REFS &r )
+{
+    GREEN_FACTORS f;
+    f.wood = ( r.wood_sg * 1000.0 ) * ( 1.0 + ( r.mc_pct_green_wood / 100.0 ) ) * 2.2046 / 35.3145 / 2000.0;
+    f.bark = ( r.bark_sg * 1000.0 ) * ( 1.0 + ( r.mc_pct_green_bark / 100.0 ) ) * 2.2046 / 35.3145 / 2000.0;
+    return f;
+}
+
+// coefficients resolved for a species and division
+struct NSVB_PLAN {
+    const COEFS *coefs[COMP_COUNT] = {};    // nullptr when the component is 0.0 (woodland species)
+    int eq_spp[COMP_COUNT] = {};            // species code passed to biomass() (Jenkins group when falling back)
+    int fia_spp = 999;                      // species used (999 when not found)
+    double wood_sg = 0.0;                   // wood specific gravity
+    GREEN_FACTORS green;                    // green weight factors of the species
+};
+
+// map a division string to its code (DIV_NONE if not recognized)
+DIVISION division_code( std::string_view division );
+
+// division string of a code ("" for DIV_NONE)
+const char *division_name( DIVISION division );
+
+// resolve the coefficients for a species in a division
+//  planted: tree in a planted stand (planted coefficients, where a species has them, take precedence;
+//           the scalar functions in nsvb.hpp do not use them)
+NSVB_PLAN resolve_plan( int fia_spp, DIVISION division, bool planted = false );
+
+// evaluate a component of a plan (pounds or cubic feet)
+//  dbh (inches)
+//  height (feet)
+inline double evaluate_component( const NSVB_PLAN &plan, COMPONENT component, double dbh, double height )
+{
+    const COEFS *c = plan.coefs[component];
+
+    return c ? biomass( plan.eq_spp[component], *c, plan.wood_sg, dbh, height ) : 0.0;
+}
+
+// rebalance the wood, bark and branch components to the direct estimate of total biomass
+// and compute above ground biomass (same arithmetic as biomass_components())
+inline void rebalance( BIOMASS_COMP &bc )
+{
+    double TotalC = bc.wood + bc.bark + bc.branch;
+
+    double Diff = bc.total - TotalC;
+    double WoodR = bc.wood / TotalC;
+    double BarkR = bc.bark / TotalC;
+    double BranchR = bc.branch / TotalC;
+
+    bc.wood += Diff * WoodR;
+    bc.bark += Diff * BarkR;
+    bc.branch += Diff * BranchR;
+
+    bc.above_ground_biomass = bc.total + bc.foliage;
+}
+
+// biomass components of a plan given total inside bark volume (same results as biomass_components())
+inline BIOMASS_COMP evaluate_biomass( const NSVB_PLAN &plan, double vtotib, double dbh, double height )
+{
+    BIOMASS_COMP bc;
+
+    bc.wood = vtotib * plan.wood_sg * 62.4;
+    bc.bark = evaluate_component( plan, COMP_BARK, dbh, height );
+    bc.branch = evaluate_component( plan, COMP_BRANCH, dbh, height );
+    bc.foliage = evaluate_component( plan, COMP_FOLIAGE, dbh, height );
+    bc.total = evaluate_component( plan, COMP_TOTAL, dbh, height );
+    rebalance( bc );
+
+    return bc;
+}
+
+#endif
@@ -0,0 +1,85 @@
+// National Scale Volume and Biomass estimators (NSVB) concurrent plan cache
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include "nsvb_plan_cache.hpp"
+
+// key bit 0 is always set so no key is 0 (empty); bit 1 marks a slot whose plan is being written
+static constexpr std::uint64_t BUSY = 2;
+
+// slots examined for a key before it is treated as not cached (bounds lookups in a crowded table)
+static constexpr std::size_t MAX_PROBES = 32;
+
+static std::uint64_t plan_key( int fia_spp, DIVISION division, bool planted )
+{
+    return static_cast<std::uint64_t>( static_cast<std::uint32_t>( fia_spp ) ) << 32 | static_cast<std::uint64_t>( division ) << 8
+         | static_cast<std::uint64_t>( planted ) << 2 | 1;
+}
+
+static std::size_t first_slot( std::uint64_t key, std::size_t mask )
+{
+    return static_cast<std::size_t>( ( key * 0x9E3779B97F4A7C15ull ) >> 32 ) & mask;
+}
+
+// cache of up to capacity plans (rounded up to a power of two)
+PLAN_CACHE::PLAN_CACHE( std::size_t capacity )
+{
+    std::size_t size = 16;
+    while( size < capacity )
+        size *= 2;
+
+    slots = std::make_unique<SLOT[]>( size );
+    mask = size - 1;
+}
+
+// cached plan of a species in a division, or nullptr (wait-free)
+const NSVB_PLAN *PLAN_CACHE::find( int fia_spp, DIVISION division, bool planted ) const
+{
+    std::uint64_t key = plan_key( fia_spp, division, planted );
+
+    for( std::size_t probe = 0, s = first_slot( key, mask ); probe < MAX_PROBES && probe <= mask; probe++, s = ( s + 1 ) & mask )
+    {
+        std::uint64_t k = slots[s].key.load( std::memory_order_acquire );
+        if( k == key )
+            return &slots[s].plan;
+        if( k == 0 )
+            return nullptr;
+    }
+
+    return nullptr;
+}
+
+// plan of a species in a division, resolved and inserted on first use
+NSVB_PLAN PLAN_CACHE::get( int fia_spp, DIVISION division, bool planted )
+{
+    if( const NSVB_PLAN *cached = find( fia_spp, division, planted ) )
+        return *cached;
+
+    NSVB_PLAN plan = resolve_plan( fia_spp, division, planted );
+    std::uint64_t key = plan_key( fia_spp, division, planted );
+
+    // claim the first empty slot of the probe sequence unless another thread has claimed one for the key
+    for( std::size_t probe = 0, s = first_slot( key, mask ); probe < MAX_PROBES && probe <= mask; probe++, s = ( s + 1 ) & mask )
+    {
+        std::uint64_t k = slots[s].key.load( std::memory_order_acquire );
+        if( k == 0 && slots[s].key.compare_exchange_strong( k, key | BUSY, std::memory_order_acquire ) )
+        {
+            slots[s].plan = plan;
+            slots[s].key.store( key, std::memory_order_release );
+            count.fetch_add( 1, std::memory_order_relaxed );
+            break;
+        }
+        if( k == key || k == ( key | BUSY ) )
+            break;
+    }
+
+    return plan;
+}
+
+// the process plan cache used by the batch engine
+PLAN_CACHE &plan_cache()
+{
+    static PLAN_CACHE cache;
+    return cache;
+}
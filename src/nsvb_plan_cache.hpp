@@ -0,0 +1,53 @@
+// National Scale Volume and Biomass estimators (NSVB) concurrent plan cache
+//
+// An insert-only open addressing hash table of resolved plans keyed by (fia_spp, division, planted)
+// shared by all threads. Slots are claimed with a compare and swap and a plan is published by
+// storing its key with release ordering, so lookups take no locks and finish in a bounded number
+// of probes (wait-free). Inserts are lock-free; a lookup racing an insert of the same key resolves
+// the plan itself. Entries are never removed or moved, so references stay valid for the life of
+// the cache. When the slots near a key's hash are full its plan is resolved but not cached.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_PLAN_CACHE_HPP
+#define NSVB_PLAN_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "nsvb_plan.hpp"
+
+class PLAN_CACHE {
+public:
+    // cache of up to capacity plans (rounded up to a power of two)
+    explicit PLAN_CACHE( std::size_t capacity = 8192 );
+
+    PLAN_CACHE( const PLAN_CACHE & ) = delete;
+    PLAN_CACHE &operator=( const PLAN_CACHE & ) = delete;
+
+    // cached plan of a species in a division, or nullptr (wait-free)
+    const NSVB_PLAN *find( int fia_spp, DIVISION division, bool planted = false ) const;
+
+    // plan of a species in a division, resolved and inserted on first use
+    NSVB_PLAN get( int fia_spp, DIVISION division, bool planted = false );
+
+    // plans cached
+    std::size_t size() const { return count.load( std::memory_order_relaxed ); }
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    struct SLOT {
+        std::atomic<std::uint64_t> key{ 0 };    // 0: empty; key | BUSY: plan being written; key: plan published
+        NSVB_PLAN plan;
+    };
+
+    std::unique_ptr<SLOT[]> slots;
+    std::size_t mask;
+    std::atomic<std::size_t> count{ 0 };
+};
+
+// the process plan cache used by the batch engine
+PLAN_CACHE &plan_cache();
+
+#endif
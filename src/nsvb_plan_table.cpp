@@ -0,0 +1,156 @@
+// National Scale Volume and Biomass estimators (NSVB) precomputed plan table
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "nsvb_batch.hpp"
+#include "nsvb_numa.hpp"
+#include "nsvb_plan_table.hpp"
+
+static bool same_plan( const NSVB_PLAN &a, const NSVB_PLAN &b )
+{
+    return std::equal( a.coefs, a.coefs + COMP_COUNT, b.coefs ) && std::equal( a.eq_spp, a.eq_spp + COMP_COUNT, b.eq_spp )
+        && a.fia_spp == b.fia_spp && a.wood_sg == b.wood_sg;
+}
+
+// resolve all species x divisions
+PLAN_TABLE::PLAN_TABLE( unsigned threads )
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<int> species;
+    for( const REF_RECORD &r : ref_table() )
+        species.push_back( r.fia_spp );
+
+    // each species' distinct plans and its row of pool indices (local to the species until merged)
+    std::vector<std::vector<NSVB_PLAN>> distinct( species.size() );
+    std::vector<std::uint16_t> row( species.size() * DIV_COUNT );
+
+    if( threads == 0 )
+        threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+    parallel_for( species.size(), threads, [&]( std::size_t begin, std::size_t end ) {
+        for( std::size_t s = begin; s < end; s++ )
+            for( int d = 0; d < DIV_COUNT; d++ )
+            {
+                NSVB_PLAN plan = resolve_plan( species[s], static_cast<DIVISION>( d ) );
+
+                auto &plans = distinct[s];
+                auto found = std::find_if( plans.begin(), plans.end(), [&]( const NSVB_PLAN &p ) { return same_plan( p, plan ); } );
+                row[s * DIV_COUNT + d] = static_cast<std::uint16_t>( found - plans.begin() );
+                if( found == plans.end() )
+                    plans.push_back( plan );
+            }
+    }, 8 );
+
+    // merge into one pool
+    species_index.assign( species.back() + 1, 0 );
+    table.resize( row.size() );
+    for( std::size_t s = 0; s < species.size(); s++ )
+    {
+        std::size_t base = pool.size();
+        pool.insert( pool.end(), distinct[s].begin(), distinct[s].end() );
+        for( int d = 0; d < DIV_COUNT; d++ )
+            table[s * DIV_COUNT + d] = static_cast<std::uint16_t>( base + row[s * DIV_COUNT + d] );
+
+        species_index[species[s]] = static_cast<std::uint16_t>( s );
+        if( species[s] == 999 )
+            other = static_cast<std::uint16_t>( s );
+    }
+    for( int spp = 0; spp < static_cast<int>( species_index.size() ); spp++ )
+        if( !find_refs( spp ) )
+            species_index[spp] = other;
+
+    summary.species = species.size();
+    summary.entries = table.size();
+    summary.plans = pool.size();
+    summary.bytes = species_index.size() * sizeof( std::uint16_t ) + table.size() * sizeof( std::uint16_t ) + pool.size() * sizeof( NSVB_PLAN );
+    summary.threads = threads;
+    summary.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// copy a table with the coefficients of its plans
+PLAN_TABLE::PLAN_TABLE( const PLAN_TABLE &t )
+    : species_index( t.species_index ), other( t.other ), table( t.table ), pool( t.pool ), summary( t.summary )
+{
+    // distinct coefficient records of the pool, then the plans pointed at the copies
+    std::vector<const COEFS *> used;
+    for( const NSVB_PLAN &p : pool )
+        for( const COEFS *c : p.coefs )
+            if( c )
+                used.push_back( c );
+    std::sort( used.begin(), used.end() );
+    used.erase( std::unique( used.begin(), used.end() ), used.end() );
+
+    coefs.reserve( used.size() );
+    for( const COEFS *c : used )
+        coefs.push_back( *c );
+    for( NSVB_PLAN &p : pool )
+        for( const COEFS *&c : p.coefs )
+            if( c )
+                c = &coefs[std::lower_bound( used.begin(), used.end(), c ) - used.begin()];
+
+    summary.bytes += coefs.size() * sizeof( COEFS );
+}
+
+static std::atomic<const PLAN_TABLE *> process_table{ nullptr };
+
+// build the process plan table used by the batch engine
+const PLAN_TABLE &precompute_plans( unsigned threads )
+{
+    static std::mutex build_mutex;
+    static std::unique_ptr<PLAN_TABLE> table;
+
+    std::lock_guard<std::mutex> lock( build_mutex );
+    if( !table )
+    {
+        table = std::make_unique<PLAN_TABLE>( threads );
+        process_table.store( table.get(), std::memory_order_release );
+    }
+
+    return *table;
+}
+
+// the process plan table, or nullptr before precompute_plans()
+const PLAN_TABLE *plan_table()
+{
+    return process_table.load( std::memory_order_acquire );
+}
+
+// the replica of the process plan table for a NUMA node
+const PLAN_TABLE *plan_table( unsigned node )
+{
+    static std::atomic<const PLAN_TABLE *> replicas[NUMA_MAX_NODES] = {};
+    static std::unique_ptr<PLAN_TABLE> copies[NUMA_MAX_NODES];
+    static std::mutex copy_mutex;
+
+    const PLAN_TABLE *table = plan_table();
+    if( !table || numa_nodes().size() <= 1 || node >= NUMA_MAX_NODES )
+        return table;
+
+    if( const PLAN_TABLE *replica = replicas[node].load( std::memory_order_acquire ) )
+        return replica;
+
+    std::lock_guard<std::mutex> lock( copy_mutex );
+    if( !copies[node] )
+    {
+        copies[node] = std::make_unique<PLAN_TABLE>( *table );
+        replicas[node].store( copies[node].get(), std::memory_order_release );
+    }
+
+    return copies[node].get();
+}
+
+// write a plan table report
+std::ostream &operator<<( std::ostream &os, const PLAN_TABLE_REPORT &report )
+{
+    return os << "plan table: " << report.species << " species x " << report.divisions << " divisions = " << report.entries
+              << " entries, " << report.plans << " distinct plans, " << report.bytes / 1024.0 << " KiB, built in "
+              << report.seconds * 1e3 << " ms on " << report.threads << " threads";
+}
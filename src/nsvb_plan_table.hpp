@@ -0,0 +1,74 @@
+// National Scale Volume and Biomass estimators (NSVB) precomputed plan table
+//
+// An optional startup step resolving every species in refs x every division (including blank)
+// in parallel. Plans are stored once per distinct result for a species (most divisions share
+// the species table plan) in a pool, and a dense species x division table of 16 bit pool
+// indices makes a lookup two array accesses. Once precompute_plans() has run the batch engine
+// looks plans up in the table instead of resolving them.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_PLAN_TABLE_HPP
+#define NSVB_PLAN_TABLE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "nsvb_plan.hpp"
+
+// size and build time of a plan table
+struct PLAN_TABLE_REPORT {
+    std::size_t species = 0;
+    std::size_t divisions = DIV_COUNT;
+    std::size_t entries = 0;            // species x divisions
+    std::size_t plans = 0;              // distinct plans in the pool
+    std::size_t bytes = 0;              // memory of the index, table and pool
+    unsigned threads = 0;
+    double seconds = 0.0;
+};
+
+class PLAN_TABLE {
+public:
+    // resolve all species x divisions with threads workers (0: one per hardware thread)
+    explicit PLAN_TABLE( unsigned threads = 0 );
+
+    // a copy holds its own copy of the coefficients its plans use (the table's plans point into
+    // the coefficient blob), so a copy made on a NUMA node evaluates from node-local memory only
+    PLAN_TABLE( const PLAN_TABLE &table );
+    PLAN_TABLE &operator=( const PLAN_TABLE & ) = delete;
+
+    // plan of a species in a division (unknown species use 999, as resolve_plan())
+    const NSVB_PLAN &get( int fia_spp, DIVISION division ) const
+    {
+        std::uint16_t s = fia_spp >= 0 && static_cast<std::size_t>( fia_spp ) < species_index.size() ? species_index[fia_spp] : other;
+
+        return pool[table[s * DIV_COUNT + division]];
+    }
+
+    const PLAN_TABLE_REPORT &report() const { return summary; }
+
+private:
+    std::vector<std::uint16_t> species_index;   // row of each fia_spp code (other for codes not in refs)
+    std::uint16_t other = 0;                    // row of species 999
+    std::vector<std::uint16_t> table;           // pool index by row * DIV_COUNT + division
+    std::vector<NSVB_PLAN> pool;
+    std::vector<COEFS> coefs;                   // coefficients of the pool's plans (copies only)
+    PLAN_TABLE_REPORT summary;
+};
+
+// build the process plan table used by the batch engine (once; later calls return the same table)
+const PLAN_TABLE &precompute_plans( unsigned threads = 0 );
+
+// the process plan table, or nullptr before precompute_plans()
+const PLAN_TABLE *plan_table();
+
+// the replica of the process plan table for a NUMA node (an index into numa_nodes()), copied with
+// its coefficients on first use by the calling thread, which should be pinned to the node so the
+// copy is local; the process table itself with one node, and nullptr before precompute_plans()
+const PLAN_TABLE *plan_table( unsigned node );
+
+// write a plan table report
+std::ostream &operator<<( std::ostream &os, const PLAN_TABLE_REPORT &report );
+
+#endif
@@ -0,0 +1,166 @@
+// National Scale Volume and Biomass estimators (NSVB) plot rollup
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include "nsvb_green.hpp"
+#include "nsvb_rollup.hpp"
+#include "nsvb_timing.hpp"
+
+// add the totals of b to a (same plot)
+void add_totals( PLOT_TOTALS &a, const PLOT_TOTALS &b )
+{
+    a.trees += b.trees;
+    a.tpa += b.tpa;
+    a.volib += b.volib;
+    a.volob += b.volob;
+    a.green_tons += b.green_tons;
+    a.biomass.wood += b.biomass.wood;
+    a.biomass.bark += b.biomass.bark;
+    a.biomass.branch += b.biomass.branch;
+    a.biomass.foliage += b.biomass.foliage;
+    a.biomass.total += b.biomass.total;
+    a.biomass.above_ground_biomass += b.biomass.above_ground_biomass;
+}
+
+// totals of plots in order of first appearance with a hash index by plot id
+struct PLOT_TABLE {
+    std::vector<PLOT_TOTALS> plots;
+    std::unordered_map<int,std::size_t> index;
+
+    void add( const PLOT_TOTALS &totals )
+    {
+        auto [at, inserted] = index.try_emplace( totals.plot, plots.size() );
+        if( inserted )
+            plots.push_back( totals );
+        else
+            add_totals( plots[at->second], totals );
+    }
+};
+
+// add trees [first, first + n) of a block to its plot runs, given their values (indexed from 0)
+static void aggregate( PLOT_TABLE &table, PLOT_TOTALS &run, const BATCH_RESULT &values, const TREE_BATCH &trees, const int *plot,
+                       const double *tpa, std::size_t begin, std::size_t first, std::size_t n )
+{
+    for( std::size_t k = 0; k < n; k++ )
+    {
+        std::size_t i = first + k;
+        if( i > begin && plot[i] != run.plot )
+        {
+            table.add( run );
+            run = PLOT_TOTALS();
+        }
+        run.plot = plot[i];
+
+        double w = tpa ? tpa[i] : 1.0;
+        double volib = values.volib[k], volob = values.volob[k];
+
+        run.trees++;
+        run.tpa += w;
+        run.volib += w * total_value( volib );
+        run.volob += w * total_value( volob );
+        run.green_tons += w * total_value( green_tons( species_green_factors( trees.fia_spp[i] ), volob, volib ) );
+        run.biomass.wood += w * total_value( values.wood[k] );
+        run.biomass.bark += w * total_value( values.bark[k] );
+        run.biomass.branch += w * total_value( values.branch[k] );
+        run.biomass.foliage += w * total_value( values.foliage[k] );
+        run.biomass.total += w * total_value( values.total[k] );
+        run.biomass.above_ground_biomass += w * total_value( values.above_ground_biomass[k] );
+    }
+}
+
+// totals of the trees of a block: runs of one plot are summed as segments then gathered by plot.
+// Trees are evaluated chunk by chunk unless results are given.
+static PLOT_TABLE rollup_block( const TREE_BATCH &trees, const std::vector<DIVISION> &codes, const BATCH_RESULT *results,
+                                const int *plot, const double *tpa, std::size_t begin, std::size_t end )
+{
+    PLOT_TABLE table;
+    PLOT_TOTALS run;
+    NSVB_PLAN plans[BATCH_CHUNK];
+    double columns[8][BATCH_CHUNK];
+
+    for( std::size_t chunk = begin; chunk < end; chunk += BATCH_CHUNK )
+    {
+        std::size_t n = std::min( chunk + BATCH_CHUNK, end ) - chunk;
+        BATCH_RESULT values;
+
+        if( results )
+            values = { results->volib + chunk, results->volob + chunk, results->wood + chunk, results->bark + chunk,
+                       results->branch + chunk, results->foliage + chunk, results->total + chunk, results->above_ground_biomass + chunk };
+        else
+        {
+            values = { columns[0], columns[1], columns[2], columns[3], columns[4], columns[5], columns[6], columns[7] };
+            resolve_plans( trees, codes, chunk, chunk + n, plans );
+
+            for( std::size_t k = 0; k < n; k++ )
+            {
+                const NSVB_PLAN &p = plans[k];
+                std::size_t i = chunk + k;
+                double dbh = trees.dbh[i], height = trees.height[i];
+                values.volib[k] = evaluate_component( p, COMP_VOLIB, dbh, height );
+                values.volob[k] = evaluate_component( p, COMP_VOLOB, dbh, height );
+                BIOMASS_COMP bc = evaluate_biomass( p, trees.vtotib ? trees.vtotib[i] : values.volib[k], dbh, height );
+                values.wood[k] = bc.wood;
+                values.bark[k] = bc.bark;
+                values.branch[k] = bc.branch;
+                values.foliage[k] = bc.foliage;
+                values.total[k] = bc.total;
+                values.above_ground_biomass[k] = bc.above_ground_biomass;
+            }
+        }
+
+        NSVB_TIME_STAGE( STAGE_AGGREGATE );
+        aggregate( table, run, values, trees, plot, tpa, begin, chunk, n );
+    }
+    if( end > begin )
+        table.add( run );
+
+    return table;
+}
+
+// plot totals of the blocks of a tree batch, merged in block order so sums do not depend on the number of threads
+static std::vector<PLOT_TOTALS> rollup( const TREE_BATCH &trees, const BATCH_RESULT *results, const int *plot, const double *tpa,
+                                        unsigned threads )
+{
+    std::vector<PLOT_TABLE> blocks( ( trees.n + ROLLUP_BLOCK - 1 ) / ROLLUP_BLOCK );
+    std::vector<DIVISION> codes = results ? std::vector<DIVISION>() : dictionary_codes( trees );
+
+    parallel_for( trees.n, threads, [&]( std::size_t begin, std::size_t end ) {
+        blocks[begin / ROLLUP_BLOCK] = rollup_block( trees, codes, results, plot, tpa, begin, end );
+    }, ROLLUP_BLOCK );
+
+    if( blocks.size() == 1 )
+        return std::move( blocks[0].plots );
+
+    NSVB_TIME_STAGE( STAGE_AGGREGATE );
+    PLOT_TABLE all;
+    for( auto &block : blocks )
+    {
+        for( const auto &totals : block.plots )
+            all.add( totals );
+        block = PLOT_TABLE();
+    }
+
+    return std::move( all.plots );
+}
+
+// plot totals of a tree batch
+std::vector<PLOT_TOTALS> rollup_plots( const TREE_BATCH &trees, const int *plot, const double *tpa, unsigned threads )
+{
+    return rollup( trees, nullptr, plot, tpa, threads );
+}
+
+// plot totals of a tree batch already evaluated
+std::vector<PLOT_TOTALS> rollup_plots( const TREE_BATCH &trees, const BATCH_RESULT &results, const int *plot, const double *tpa,
+                                       unsigned threads )
+{
+    if( !results.volib || !results.volob || !results.wood || !results.bark || !results.branch || !results.foliage || !results.total
+        || !results.above_ground_biomass )
+        throw std::runtime_error( "rollup_plots: every result column is required" );
+
+    return rollup( trees, &results, plot, tpa, threads );
+}
@@ -0,0 +1,50 @@
+// National Scale Volume and Biomass estimators (NSVB) plot rollup
+//
+// Evaluates a tree batch and returns only per-plot totals expanded by trees per acre, so a
+// national run never materializes the per-tree table. Trees are taken in fixed blocks; within a
+// block each run of trees of one plot is summed as a segment and runs are gathered into plots
+// with a hash table, so plots stored contiguously cost one lookup per plot and unsorted trees
+// one lookup per tree. Block totals are merged in block order, so results do not depend on the
+// number of threads.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_ROLLUP_HPP
+#define NSVB_ROLLUP_HPP
+
+#include <vector>
+#include "nsvb_batch.hpp"
+
+// trees per rollup block
+constexpr std::size_t ROLLUP_BLOCK = 16384;
+
+// per acre totals of a plot; undefined (NaN) and infinite tree values are left out of the sums (total_value())
+struct PLOT_TOTALS {
+    int plot = 0;
+    std::size_t trees = 0;
+    double tpa = 0.0;               // trees per acre
+    double volib = 0.0;             // total cubic volume inside bark (cubic feet per acre)
+    double volob = 0.0;             // total cubic volume outside bark (cubic feet per acre)
+    double green_tons = 0.0;        // green weight of the stem outside bark (tons per acre)
+    BIOMASS_COMP biomass;           // biomass components (pounds per acre)
+};
+
+// plot totals of a tree batch
+//  trees : tree batch
+//  plot : plot id of each tree (trees of a plot need not be contiguous)
+//  tpa : expansion factor of each tree (nullptr: 1.0)
+//  threads : worker threads (0: one per hardware thread)
+// returns one entry per plot in order of first appearance
+std::vector<PLOT_TOTALS> rollup_plots( const TREE_BATCH &trees, const int *plot, const double *tpa, unsigned threads = 1 );
+
+// plot totals of a tree batch already evaluated with evaluate_batch(), so trees wanted both one by
+// one and by plot are evaluated once (same totals as above)
+//  results : every column of the batch's results (throws std::runtime_error when one is nullptr)
+std::vector<PLOT_TOTALS> rollup_plots( const TREE_BATCH &trees, const BATCH_RESULT &results, const int *plot, const double *tpa,
+                                       unsigned threads = 1 );
+
+// add the totals of b to a (same plot)
+void add_totals( PLOT_TOTALS &a, const PLOT_TOTALS &b );
+
+#endif
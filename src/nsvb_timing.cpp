@@ -0,0 +1,221 @@
+// National Scale Volume and Biomass estimators (NSVB) pipeline stage timing
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include "nsvb_timing.hpp"
+
+#ifdef NSVB_ENABLE_TIMING
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define NSVB_TIMING_RDTSC
+#endif
+
+// log-linear buckets: values below 32 ticks are exact, above that each power of two
+// is split into 16 sub-buckets (about 6% resolution)
+static constexpr int SUB_BUCKETS = 16;
+static constexpr int BUCKETS = 60 * SUB_BUCKETS + 2 * SUB_BUCKETS;
+
+static const char *stage_names[STAGE_COUNT] = {
+    "parse", "resolve_plan", "evaluate_volume", "evaluate_biomass", "rebalance", "aggregate", "write"
+};
+
+static int bucket_index( std::uint64_t v )
+{
+    if( v < 2 * SUB_BUCKETS )
+        return static_cast<int>( v );
+
+    int e = std::bit_width( v ) - 5;
+
+    return e * SUB_BUCKETS + static_cast<int>( v >> e );
+}
+
+static std::uint64_t bucket_low( int index )
+{
+    if( index < 2 * SUB_BUCKETS )
+        return index;
+
+    int e = index / SUB_BUCKETS - 1;
+
+    return static_cast<std::uint64_t>( index - e * SUB_BUCKETS ) << e;
+}
+
+// histograms of one thread; only the owning thread writes, so relaxed load/store suffices
+struct THREAD_HISTOGRAMS {
+    std::atomic<std::uint64_t> counts[STAGE_COUNT][BUCKETS] = {};
+    std::atomic<std::uint64_t> sum[STAGE_COUNT] = {};
+    std::atomic<std::uint64_t> max[STAGE_COUNT] = {};
+};
+
+struct TIMING_REGISTRY;
+static void dump( TIMING_REGISTRY &r, std::ostream &os );
+
+// registry of per-thread histograms; writes the JSON report when the process exits
+struct TIMING_REGISTRY {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<THREAD_HISTOGRAMS>> threads;
+    std::uint64_t tick0;
+    std::chrono::steady_clock::time_point clock0;
+
+    TIMING_REGISTRY() : tick0( timing_now() ), clock0( std::chrono::steady_clock::now() ) {}
+
+    ~TIMING_REGISTRY()
+    {
+        const char *path = std::getenv( "NSVB_TIMING_JSON" );
+        std::ofstream os( path && *path ? path : "nsvb_timing.json" );
+        if( os )
+            dump( *this, os );
+    }
+
+    // ticks per nanosecond since the registry was created
+    double ticks_per_ns()
+    {
+#ifdef NSVB_TIMING_RDTSC
+        auto ns = std::chrono::duration<double,std::nano>( std::chrono::steady_clock::now() - clock0 ).count();
+        return ns > 0.0 ? ( timing_now() - tick0 ) / ns : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+};
+
+static TIMING_REGISTRY &registry()
+{
+    static TIMING_REGISTRY r;
+    return r;
+}
+
+static THREAD_HISTOGRAMS &thread_histograms()
+{
+    thread_local THREAD_HISTOGRAMS *h = [] {
+        TIMING_REGISTRY &r = registry();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        r.threads.push_back( std::make_unique<THREAD_HISTOGRAMS>() );
+        return r.threads.back().get();
+    }();
+
+    return *h;
+}
+
+// current tick count (rdtsc on x86-64, steady_clock nanoseconds elsewhere)
+std::uint64_t timing_now()
+{
+#ifdef NSVB_TIMING_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+// record one sample of a stage
+void timing_record( TIMING_STAGE stage, std::uint64_t ticks )
+{
+    THREAD_HISTOGRAMS &h = thread_histograms();
+
+    auto &c = h.counts[stage][bucket_index( ticks )];
+    c.store( c.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    h.sum[stage].store( h.sum[stage].load( std::memory_order_relaxed ) + ticks, std::memory_order_relaxed );
+    if( ticks > h.max[stage].load( std::memory_order_relaxed ) )
+        h.max[stage].store( ticks, std::memory_order_relaxed );
+}
+
+// merge the histograms of all threads and write them as JSON
+static void dump( TIMING_REGISTRY &r, std::ostream &os )
+{
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    double tpns = r.ticks_per_ns();
+
+#ifdef NSVB_TIMING_RDTSC
+    os << "{\"clock\":\"rdtsc\",\"ticks_per_ns\":" << tpns << ",\"threads\":" << r.threads.size() << ",\"stages\":[";
+#else
+    os << "{\"clock\":\"steady_clock\",\"ticks_per_ns\":" << tpns << ",\"threads\":" << r.threads.size() << ",\"stages\":[";
+#endif
+
+    for( int s = 0; s < STAGE_COUNT; s++ )
+    {
+        std::vector<std::uint64_t> counts( BUCKETS, 0 );
+        std::uint64_t n = 0, sum = 0, max = 0;
+
+        for( auto &t : r.threads )
+        {
+            for( int b = 0; b < BUCKETS; b++ )
+                counts[b] += t->counts[s][b].load( std::memory_order_relaxed );
+            sum += t->sum[s].load( std::memory_order_relaxed );
+            max = std::max( max, t->max[s].load( std::memory_order_relaxed ) );
+        }
+        for( auto c : counts )
+            n += c;
+
+        // value at a quantile (lower bound of its bucket) in nanoseconds
+        auto quantile = [&]( double q ) {
+            std::uint64_t rank = static_cast<std::uint64_t>( q * n ), seen = 0;
+            for( int b = 0; b < BUCKETS; b++ )
+            {
+                seen += counts[b];
+                if( seen > rank )
+                    return bucket_low( b ) / tpns;
+            }
+            return max / tpns;
+        };
+
+        os << ( s ? "," : "" ) << "{\"stage\":\"" << stage_names[s] << "\",\"count\":" << n;
+        if( n > 0 )
+        {
+            os << ",\"total_ns\":" << sum / tpns << ",\"mean_ns\":" << sum / tpns / n
+               << ",\"p50_ns\":" << quantile( 0.5 ) << ",\"p90_ns\":" << quantile( 0.9 )
+               << ",\"p99_ns\":" << quantile( 0.99 ) << ",\"p999_ns\":" << quantile( 0.999 )
+               << ",\"max_ns\":" << max / tpns << ",\"buckets\":[";
+
+            bool first = true;
+            for( int b = 0; b < BUCKETS; b++ )
+            {
+                if( counts[b] == 0 )
+                    continue;
+                os << ( first ? "" : "," ) << "[" << bucket_low( b ) / tpns << "," << counts[b] << "]";
+                first = false;
+            }
+            os << "]";
+        }
+        os << "}";
+    }
+
+    os << "]}\n";
+}
+
+// write the merged histograms of all threads as JSON
+void timing_dump( std::ostream &os )
+{
+    dump( registry(), os );
+}
+
+// discard all samples recorded so far
+void timing_reset()
+{
+    TIMING_REGISTRY &r = registry();
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    for( auto &t : r.threads )
+    {
+        for( int s = 0; s < STAGE_COUNT; s++ )
+        {
+            for( auto &c : t->counts[s] )
+                c.store( 0, std::memory_order_relaxed );
+            t->sum[s].store( 0, std::memory_order_relaxed );
+            t->max[s].store( 0, std::memory_order_relaxed );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,75 @@
+// National Scale Volume and Biomass estimators (NSVB) pipeline stage timing
+//
+// Opt-in latency histograms for the stages of the batch pipeline. Compile with
+// -DNSVB_ENABLE_TIMING to record; otherwise NSVB_TIME_STAGE() expands to nothing and
+// the functions below are empty inlines.
+//
+// Each thread records into its own log-linear (HDR style) histograms so recording never
+// contends. When enabled the merged histograms are written as JSON at exit to the file
+// named by the NSVB_TIMING_JSON environment variable (default nsvb_timing.json).
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_TIMING_HPP
+#define NSVB_TIMING_HPP
+
+#include <cstdint>
+#include <ostream>
+
+// batch pipeline stages
+enum TIMING_STAGE {
+    STAGE_PARSE = 0,
+    STAGE_RESOLVE_PLAN,
+    STAGE_VOLUME,
+    STAGE_BIOMASS,
+    STAGE_REBALANCE,
+    STAGE_AGGREGATE,
+    STAGE_WRITE,
+    STAGE_COUNT
+};
+
+#ifdef NSVB_ENABLE_TIMING
+
+// record one sample of a stage (clock ticks from timing_now())
+void timing_record( TIMING_STAGE stage, std::uint64_t ticks );
+
+// current tick count (rdtsc on x86-64, steady_clock nanoseconds elsewhere)
+std::uint64_t timing_now();
+
+// write the merged histograms of all threads as JSON
+void timing_dump( std::ostream &os );
+
+// discard all samples recorded so far
+void timing_reset();
+
+// times the enclosing scope as one sample of a stage
+class STAGE_TIMER {
+public:
+    explicit STAGE_TIMER( TIMING_STAGE stage ) : stage( stage ), start( timing_now() ) {}
+    ~STAGE_TIMER() { timing_record( stage, timing_now() - start ); }
+
+    STAGE_TIMER( const STAGE_TIMER & ) = delete;
+    STAGE_TIMER &operator=( const STAGE_TIMER & ) = delete;
+
+private:
+    TIMING_STAGE stage;
+    std::uint64_t start;
+};
+
+#define NSVB_TIMER_CONCAT2( a, b ) a##b
+#define NSVB_TIMER_CONCAT( a, b ) NSVB_TIMER_CONCAT2( a, b )
+#define NSVB_TIME_STAGE( stage ) STAGE_TIMER NSVB_TIMER_CONCAT( nsvb_stage_timer_, __LINE__ )( stage )
+
+#else
+
+inline void timing_record( TIMING_STAGE, std::uint64_t ) {}
+inline std::uint64_t timing_now() { return 0; }
+inline void timing_dump( std::ostream & ) {}
+inline void timing_reset() {}
+
+#define NSVB_TIME_STAGE( stage ) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+// National Scale Volume and Biomass estimators (NSVB) incremental tree list
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <cmath>
+#include "nsvb_batch.hpp"
+#include "nsvb_plan_table.hpp"
+#include "nsvb_tree_list.hpp"
+
+// estimates of a tree from its plan (same results as compute_volib(), compute_volob() and biomass_components())
+static TREE_ESTIMATES evaluate_tree( const NSVB_PLAN &plan, double dbh, double height )
+{
+    TREE_ESTIMATES e;
+
+    e.volib = evaluate_component( plan, COMP_VOLIB, dbh, height );
+    e.volob = evaluate_component( plan, COMP_VOLOB, dbh, height );
+    e.biomass = evaluate_biomass( plan, e.volib, dbh, height );
+
+    return e;
+}
+
+// totals += w * ( to - from ), leaving out undefined and infinite values (an infinite value would
+// leave NaN, inf - inf, at its next change)
+static void add_change( TREE_ESTIMATES &totals, const TREE_ESTIMATES &from, const TREE_ESTIMATES &to, double w )
+{
+    totals.volib += w * ( total_value( to.volib ) - total_value( from.volib ) );
+    totals.volob += w * ( total_value( to.volob ) - total_value( from.volob ) );
+    totals.biomass.wood += w * ( total_value( to.biomass.wood ) - total_value( from.biomass.wood ) );
+    totals.biomass.bark += w * ( total_value( to.biomass.bark ) - total_value( from.biomass.bark ) );
+    totals.biomass.branch += w * ( total_value( to.biomass.branch ) - total_value( from.biomass.branch ) );
+    totals.biomass.foliage += w * ( total_value( to.biomass.foliage ) - total_value( from.biomass.foliage ) );
+    totals.biomass.total += w * ( total_value( to.biomass.total ) - total_value( from.biomass.total ) );
+    totals.biomass.above_ground_biomass += w * ( total_value( to.biomass.above_ground_biomass ) - total_value( from.biomass.above_ground_biomass ) );
+}
+
+// add a tree and return its index
+std::size_t TREE_LIST::add( int fia_spp, std::string_view division, double dbh, double height, double tpa )
+{
+    std::size_t tree = plans.size();
+
+    const PLAN_TABLE *table = plan_table();
+    DIVISION code = division_code( division );
+    plans.push_back( table ? table->get( fia_spp, code ) : resolve_plan( fia_spp, code ) );
+    dbhs.push_back( dbh );
+    heights.push_back( height );
+    tpas.push_back( tpa );
+    values.emplace_back();
+    is_dirty.push_back( false );
+    mark_dirty( tree );
+
+    return tree;
+}
+
+void TREE_LIST::mark_dirty( std::size_t tree )
+{
+    if( !is_dirty[tree] )
+    {
+        is_dirty[tree] = true;
+        dirty.push_back( tree );
+    }
+}
+
+// new dbh and height of a tree
+void TREE_LIST::update( std::size_t tree, double dbh, double height )
+{
+    if( dbhs.at( tree ) == dbh && heights[tree] == height )
+        return;
+
+    dbhs[tree] = dbh;
+    heights[tree] = height;
+    mark_dirty( tree );
+}
+
+// new trees per acre of a tree
+void TREE_LIST::set_tpa( std::size_t tree, double tpa )
+{
+    add_change( stand, TREE_ESTIMATES(), values.at( tree ), tpa - tpas[tree] );
+    tpas[tree] = tpa;
+}
+
+// recompute the dirty trees and apply their changes to the stand totals
+std::size_t TREE_LIST::evaluate( unsigned threads )
+{
+    std::size_t n = dirty.size();
+    std::vector<TREE_ESTIMATES> fresh( n );
+
+    parallel_for( n, threads, [&]( std::size_t begin, std::size_t end ) {
+        for( std::size_t i = begin; i < end; i++ )
+        {
+            std::size_t tree = dirty[i];
+            fresh[i] = evaluate_tree( plans[tree], dbhs[tree], heights[tree] );
+        }
+    } );
+
+    // changes applied in a fixed order so totals do not depend on the number of threads
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        std::size_t tree = dirty[i];
+
+        add_change( stand, values[tree], fresh[i], tpas[tree] );
+        values[tree] = fresh[i];
+        is_dirty[tree] = false;
+    }
+    dirty.clear();
+
+    return n;
+}
+
+// recompute the stand totals by summing every tree
+void TREE_LIST::resum()
+{
+    stand = TREE_ESTIMATES();
+
+    for( std::size_t tree = 0; tree < values.size(); tree++ )
+        add_change( stand, TREE_ESTIMATES(), values[tree], tpas[tree] );
+}
@@ -0,0 +1,70 @@
+// National Scale Volume and Biomass estimators (NSVB) incremental tree list
+//
+// A tree list for growth projection. Each tree keeps its resolved plan and its last estimates;
+// updates mark trees dirty and evaluate() recomputes only the dirty trees. Stand totals (expanded
+// by trees per acre) are maintained by adding the change of each recomputed tree rather than
+// by summing the whole list again.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_TREE_LIST_HPP
+#define NSVB_TREE_LIST_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "nsvb_plan.hpp"
+
+// volumes (cubic feet) and biomass components (pounds) of a tree, or their per acre stand totals
+struct TREE_ESTIMATES {
+    double volib = 0.0;
+    double volob = 0.0;
+    BIOMASS_COMP biomass;
+};
+
+class TREE_LIST {
+public:
+    // add a tree and return its index; the tree is evaluated by the next evaluate()
+    //  tpa : trees per acre represented by the tree
+    std::size_t add( int fia_spp, std::string_view division, double dbh, double height, double tpa = 1.0 );
+
+    // new dbh and height of a tree; a tree whose dbh and height are unchanged is not marked dirty
+    void update( std::size_t tree, double dbh, double height );
+
+    // new trees per acre of a tree (0.0 for mortality); totals are adjusted without re-evaluating the tree
+    void set_tpa( std::size_t tree, double tpa );
+
+    // recompute the dirty trees and apply their changes to the stand totals; returns the number recomputed
+    std::size_t evaluate( unsigned threads = 1 );
+
+    // recompute the stand totals by summing every tree (removes rounding accumulated by updates)
+    void resum();
+
+    std::size_t size() const { return plans.size(); }
+    std::size_t dirty_count() const { return dirty.size(); }
+
+    // last estimates of a tree (as of the last evaluate())
+    const TREE_ESTIMATES &estimates( std::size_t tree ) const { return values[tree]; }
+
+    // per acre stand totals; undefined (NaN) and infinite tree estimates are left out
+    const TREE_ESTIMATES &totals() const { return stand; }
+
+    double dbh( std::size_t tree ) const { return dbhs[tree]; }
+    double height( std::size_t tree ) const { return heights[tree]; }
+    double tpa( std::size_t tree ) const { return tpas[tree]; }
+
+private:
+    std::vector<NSVB_PLAN> plans;
+    std::vector<double> dbhs;
+    std::vector<double> heights;
+    std::vector<double> tpas;
+    std::vector<TREE_ESTIMATES> values;
+    std::vector<bool> is_dirty;
+    std::vector<std::size_t> dirty;
+    TREE_ESTIMATES stand;
+
+    void mark_dirty( std::size_t tree );
+};
+
+#endif
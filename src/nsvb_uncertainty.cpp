@@ -0,0 +1,279 @@
+// National Scale Volume and Biomass estimators (NSVB) Monte Carlo uncertainty
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "nsvb_uncertainty.hpp"
+
+// random streams of a tree replicate
+enum STREAM : std::uint32_t { STREAM_MEASUREMENT = 0, STREAM_COEFFICIENT = 1 };
+
+// Philox4x32-10 counter-based generator: four 32 bit random words for a counter and key
+void philox4x32( const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4] )
+{
+    std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    std::uint32_t k0 = key[0], k1 = key[1];
+
+    for( int round = 0; round < 10; round++ )
+    {
+        std::uint64_t p0 = std::uint64_t( 0xD2511F53u ) * c0;
+        std::uint64_t p1 = std::uint64_t( 0xCD9E8D57u ) * c2;
+
+        std::uint32_t n0 = std::uint32_t( p1 >> 32 ) ^ c1 ^ k0;
+        std::uint32_t n2 = std::uint32_t( p0 >> 32 ) ^ c3 ^ k1;
+        c1 = std::uint32_t( p1 );
+        c3 = std::uint32_t( p0 );
+        c0 = n0;
+        c2 = n2;
+
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// two independent standard normal draws for a counter (Box-Muller)
+static void normal_pair( std::uint64_t seed, std::uint64_t item, std::uint32_t replicate, STREAM stream, double &z0, double &z1 )
+{
+    const std::uint32_t key[2] = { std::uint32_t( seed ), std::uint32_t( seed >> 32 ) };
+    const std::uint32_t counter[4] = { std::uint32_t( item ), std::uint32_t( item >> 32 ), replicate, stream };
+    std::uint32_t w[4];
+
+    philox4x32( counter, key, w );
+
+    // uniforms in (0,1)
+    double u0 = ( ( ( std::uint64_t( w[0] ) << 32 | w[1] ) >> 11 ) + 0.5 ) * 0x1.0p-53;
+    double u1 = ( ( ( std::uint64_t( w[2] ) << 32 | w[3] ) >> 11 ) + 0.5 ) * 0x1.0p-53;
+
+    double r = std::sqrt( -2.0 * std::log( u0 ) );
+    z0 = r * std::cos( 6.283185307179586 * u1 );
+    z1 = r * std::sin( 6.283185307179586 * u1 );
+}
+
+// key of a component's coefficient record: its equation and coefficients (FNV-1a, 64 bit), so draws
+// do not depend on where the record is stored
+static std::uint64_t record_key( int component, const COEFS &coefs )
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash]( std::uint64_t x ) {
+        for( int b = 0; b < 8; b++, x >>= 8 )
+            hash = ( hash ^ ( x & 0xff ) ) * 1099511628211ull;
+    };
+
+    add( component );
+    add( coefs.equation );
+    add( coefs.planted );
+    for( double x : { coefs.a, coefs.b, coefs.c, coefs.b2, coefs.a0, coefs.b0, coefs.b1, coefs.a1, coefs.c1 } )
+        add( std::bit_cast<std::uint64_t>( x ) );
+
+    return hash;
+}
+
+// linear interpolation quantile of sorted values (R type 7)
+static double quantile( const std::vector<double> &sorted, double q )
+{
+    if( sorted.empty() )
+        return NAN;
+
+    double h = ( sorted.size() - 1 ) * std::clamp( q, 0.0, 1.0 );
+    std::size_t lo = static_cast<std::size_t>( h );
+    std::size_t hi = std::min( lo + 1, sorted.size() - 1 );
+
+    return sorted[lo] + ( h - lo ) * ( sorted[hi] - sorted[lo] );
+}
+
+// plot totals with Monte Carlo uncertainty
+std::vector<PLOT_UNCERTAINTY> plot_uncertainty( const TREE_BATCH &trees, const int *plot, const double *tpa,
+                                                const UNCERTAINTY_MODEL &model, const UNCERTAINTY_OPTIONS &options )
+{
+    std::size_t R = options.replicates;
+    if( R == 0 )
+        throw std::invalid_argument( "plot_uncertainty: replicates must be positive" );
+
+    // contiguous plots
+    std::vector<std::size_t> starts;
+    std::unordered_set<int> seen;
+    for( std::size_t i = 0; i < trees.n; i++ )
+    {
+        if( i == 0 || plot[i] != plot[i - 1] )
+        {
+            if( !seen.insert( plot[i] ).second )
+                throw std::invalid_argument( "plot_uncertainty: trees of plot " + std::to_string( plot[i] ) + " are not contiguous" );
+            starts.push_back( i );
+        }
+    }
+    starts.push_back( trees.n );
+
+    std::size_t plots = starts.size() - 1;
+    std::vector<PLOT_UNCERTAINTY> result( plots );
+
+    // map dictionary divisions once rather than per plot
+    TREE_BATCH batch = trees;
+    std::vector<DIVISION> division_codes;
+    if( trees.division_index && !trees.division_codes )
+    {
+        std::vector<DIVISION> dictionary = dictionary_codes( trees );
+
+        division_codes.resize( trees.n );
+        for( std::size_t i = 0; i < trees.n; i++ )
+            division_codes[i] = tree_division( trees, dictionary.data(), i );
+        batch.division_codes = division_codes.data();
+    }
+
+    std::vector<DIVISION> codes = dictionary_codes( batch );
+
+    // coefficient error: one mean one lognormal factor per replicate and coefficient record (the equation
+    // of a component for a species, division or Jenkins group), drawn independently for each record
+    std::unordered_map<std::uint64_t,std::size_t> records;
+    std::vector<double> coef_factor;
+    if( model.coef_cv > 0.0 )
+    {
+        NSVB_PLAN plans[BATCH_CHUNK];
+        std::vector<std::uint64_t> keys;
+        for( std::size_t begin = 0; begin < trees.n; begin += BATCH_CHUNK )
+        {
+            std::size_t end = std::min( begin + BATCH_CHUNK, trees.n );
+            resolve_plans( batch, codes, begin, end, plans );
+            for( std::size_t k = 0; k < end - begin; k++ )
+                for( int c = 0; c < COMP_COUNT; c++ )
+                    if( const COEFS *coefs = plans[k].coefs[c] )
+                    {
+                        std::uint64_t key = record_key( c, *coefs );
+                        if( records.emplace( key, keys.size() ).second )
+                            keys.push_back( key );
+                    }
+        }
+
+        double s = std::sqrt( std::log( 1.0 + model.coef_cv * model.coef_cv ) );
+        coef_factor.resize( keys.size() * R );
+        for( std::size_t j = 0; j < keys.size(); j++ )
+            for( std::size_t r = 0; r < R; r += 2 )
+            {
+                double z0, z1;
+                normal_pair( options.seed, keys[j], std::uint32_t( r / 2 ), STREAM_COEFFICIENT, z0, z1 );
+                coef_factor[j * R + r] = std::exp( s * z0 - 0.5 * s * s );
+                if( r + 1 < R )
+                    coef_factor[j * R + r + 1] = std::exp( s * z1 - 0.5 * s * s );
+            }
+    }
+
+    parallel_for( plots, options.threads, [&]( std::size_t first, std::size_t last ) {
+        std::vector<double> totals( R * UQ_COUNT );
+        std::vector<double> values( R );
+        std::vector<NSVB_PLAN> tree_plans;
+        std::vector<const double *> factors;        // R factors per tree and component (nullptr: none)
+        std::vector<double> dbh_sd, height_sd;
+
+        NSVB_PLAN plans[BATCH_CHUNK];
+        double dbh[BATCH_CHUNK], height[BATCH_CHUNK];
+        double raw[COMP_COUNT][BATCH_CHUNK];
+        double *const components[COMP_COUNT] = { raw[0], raw[1], raw[2], raw[3], raw[4], raw[5] };
+
+        for( std::size_t p = first; p < last; p++ )
+        {
+            std::size_t begin = starts[p], end = starts[p + 1], m = end - begin;
+
+            std::fill( totals.begin(), totals.end(), 0.0 );
+            tree_plans.resize( m );
+            resolve_plans( batch, codes, begin, end, tree_plans.data() );
+
+            factors.assign( m * COMP_COUNT, nullptr );
+            dbh_sd.resize( m );
+            height_sd.resize( m );
+            for( std::size_t t = 0; t < m; t++ )
+            {
+                for( int c = 0; c < COMP_COUNT && !coef_factor.empty(); c++ )
+                    if( const COEFS *coefs = tree_plans[t].coefs[c] )
+                        factors[t * COMP_COUNT + c] = &coef_factor[records.at( record_key( c, *coefs ) ) * R];
+                dbh_sd[t] = std::hypot( model.dbh_cv * trees.dbh[begin + t], model.dbh_sd );
+                height_sd[t] = std::hypot( model.height_cv * trees.height[begin + t], model.height_sd );
+            }
+
+            // the replicates of each tree in turn, BATCH_CHUNK tree replicates per evaluate_components() call
+            for( std::size_t e0 = 0; e0 < m * R; e0 += BATCH_CHUNK )
+            {
+                std::size_t n = std::min( BATCH_CHUNK, m * R - e0 );
+
+                // measurement error
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    std::size_t t = ( e0 + k ) / R, r = ( e0 + k ) % R, i = begin + t;
+                    double z0 = 0.0, z1 = 0.0;
+                    if( dbh_sd[t] > 0.0 || height_sd[t] > 0.0 )
+                        normal_pair( options.seed, i, std::uint32_t( r ), STREAM_MEASUREMENT, z0, z1 );
+
+                    // kept positive; a missing (NaN) dbh or height stays NaN and its tree is left out
+                    double d = trees.dbh[i] + dbh_sd[t] * z0, h = trees.height[i] + height_sd[t] * z1;
+                    plans[k] = tree_plans[t];
+                    dbh[k] = d < 0.1 ? 0.1 : d;
+                    height[k] = h < 1.0 ? 1.0 : h;
+                }
+
+                evaluate_components( plans, dbh, height, n, components );
+
+                for( std::size_t k = 0; k < n; k++ )
+                {
+                    std::size_t t = ( e0 + k ) / R, r = ( e0 + k ) % R, i = begin + t;
+                    const double *const *f = &factors[t * COMP_COUNT];
+                    auto value = [&]( COMPONENT c ) { return f[c] ? raw[c][k] * f[c][r] : raw[c][k]; };
+                    double w = tpa ? tpa[i] : 1.0;
+                    double *total = &totals[r * UQ_COUNT];
+
+                    double volib = value( COMP_VOLIB );
+
+                    // a given total inside bark volume is used for wood, as evaluate_batch()
+                    BIOMASS_COMP bc;
+                    bc.wood = ( trees.vtotib ? trees.vtotib[i] : volib ) * plans[k].wood_sg * 62.4;
+                    bc.bark = value( COMP_BARK );
+                    bc.branch = value( COMP_BRANCH );
+                    bc.foliage = value( COMP_FOLIAGE );
+                    bc.total = value( COMP_TOTAL );
+                    rebalance( bc );
+
+                    total[UQ_VOLIB] += w * total_value( volib );
+                    total[UQ_VOLOB] += w * total_value( value( COMP_VOLOB ) );
+                    total[UQ_WOOD] += w * total_value( bc.wood );
+                    total[UQ_BARK] += w * total_value( bc.bark );
+                    total[UQ_BRANCH] += w * total_value( bc.branch );
+                    total[UQ_FOLIAGE] += w * total_value( bc.foliage );
+                    total[UQ_TOTAL] += w * total_value( bc.total );
+                    total[UQ_AGB] += w * total_value( bc.above_ground_biomass );
+                }
+            }
+
+            // replicate distribution of each total
+            PLOT_UNCERTAINTY &u = result[p];
+            u.plot = plot[begin];
+            u.trees = end - begin;
+
+            for( int q = 0; q < UQ_COUNT; q++ )
+            {
+                // mean shifted by the first replicate, so identical replicates give it exactly and sd 0
+                for( std::size_t r = 0; r < R; r++ )
+                    values[r] = totals[r * UQ_COUNT + q];
+                double shift = values[0], sum = 0.0, sum2 = 0.0;
+                for( double v : values )
+                    sum += v - shift;
+                u.mean[q] = shift + sum / R;
+                for( double v : values )
+                    sum2 += ( v - u.mean[q] ) * ( v - u.mean[q] );
+                u.sd[q] = R > 1 ? std::sqrt( sum2 / ( R - 1 ) ) : 0.0;
+
+                std::sort( values.begin(), values.end() );
+                u.quantiles[q].clear();
+                for( double pq : options.quantiles )
+                    u.quantiles[q].push_back( quantile( values, pq ) );
+            }
+        }
+    }, 1 );
+
+    return result;
+}
@@ -0,0 +1,74 @@
+// National Scale Volume and Biomass estimators (NSVB) Monte Carlo uncertainty
+//
+// Propagates measurement error in dbh and height, and optionally error in the equation
+// coefficients, through the NSVB chain (compute_volib() -> biomass_components()) to plot
+// totals. Random draws come from a counter-based generator (Philox4x32-10) keyed by seed,
+// tree, replicate and stream, so results do not depend on the number of threads.
+// Only one plot's replicate totals are held per thread; tree replicates are never stored.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_UNCERTAINTY_HPP
+#define NSVB_UNCERTAINTY_HPP
+
+#include <cstdint>
+#include <vector>
+#include "nsvb_batch.hpp"
+
+// quantities totaled per plot
+enum UNCERTAINTY_QUANTITY {
+    UQ_VOLIB = 0,
+    UQ_VOLOB,
+    UQ_WOOD,
+    UQ_BARK,
+    UQ_BRANCH,
+    UQ_FOLIAGE,
+    UQ_TOTAL,
+    UQ_AGB,
+    UQ_COUNT
+};
+
+// error model; measurement errors are normal with sd = sqrt( (cv * x)^2 + sd^2 )
+struct UNCERTAINTY_MODEL {
+    double dbh_cv = 0.0;            // relative dbh measurement error
+    double dbh_sd = 0.0;            // absolute dbh measurement error (inches)
+    double height_cv = 0.0;         // relative height measurement error
+    double height_sd = 0.0;         // absolute height measurement error (feet)
+    double coef_cv = 0.0;           // relative error of each equation's estimate, a mean one lognormal factor
+                                    // drawn per replicate for each coefficient record (a component's equation
+                                    // for a species, division or Jenkins group); records are independent
+};
+
+// Monte Carlo options
+struct UNCERTAINTY_OPTIONS {
+    std::size_t replicates = 1000;
+    std::uint64_t seed = 1;
+    unsigned threads = 1;                                       // 0: one per hardware thread
+    std::vector<double> quantiles = { 0.025, 0.5, 0.975 };
+};
+
+// replicate distribution of a plot's totals; undefined (NaN) and infinite tree values are left out of
+// each replicate's totals (total_value())
+struct PLOT_UNCERTAINTY {
+    int plot = 0;
+    std::size_t trees = 0;
+    double mean[UQ_COUNT] = {};
+    double sd[UQ_COUNT] = {};
+    std::vector<double> quantiles[UQ_COUNT];    // one per UNCERTAINTY_OPTIONS::quantiles
+};
+
+// plot totals with Monte Carlo uncertainty; undefined (NaN) and infinite tree values, such as those
+// of a tree with a missing dbh or height, are left out of the totals
+//  trees : tree batch; the trees of a plot must be contiguous. A given vtotib is used for wood
+//          biomass (as evaluate_batch()) without error; volib is still drawn from the equations
+//  plot : plot id of each tree
+//  tpa : expansion factor of each tree (nullptr: 1.0)
+// returns one entry per plot in input order
+std::vector<PLOT_UNCERTAINTY> plot_uncertainty( const TREE_BATCH &trees, const int *plot, const double *tpa,
+                                                const UNCERTAINTY_MODEL &model, const UNCERTAINTY_OPTIONS &options = {} );
+
+// Philox4x32-10 counter-based generator: four 32 bit random words for a counter and key
+void philox4x32( const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4] );
+
+#endif
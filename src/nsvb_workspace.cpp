@@ -0,0 +1,116 @@
+// National Scale Volume and Biomass estimators (NSVB) reusable batch workspace
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <new>
+#include "nsvb_workspace.hpp"
+
+// smallest overflow block
+constexpr std::size_t MIN_BLOCK = 64 * 1024;
+
+static std::size_t round_up( std::size_t bytes )
+{
+    return ( bytes + ARENA::ALIGNMENT - 1 ) & ~( ARENA::ALIGNMENT - 1 );
+}
+
+ARENA::ARENA( std::size_t capacity )
+{
+    blocks.reserve( 8 );
+    if( capacity )
+        add_block( round_up( capacity ) );
+}
+
+ARENA::~ARENA()
+{
+    for( auto &b : blocks )
+        ::operator delete( b.data, std::align_val_t( ALIGNMENT ) );
+}
+
+void ARENA::add_block( std::size_t size )
+{
+    blocks.push_back( { static_cast<std::byte *>( ::operator new( size, std::align_val_t( ALIGNMENT ) ) ), size } );
+    offset = 0;
+    allocations++;
+}
+
+// bytes aligned to ALIGNMENT, valid until reset()
+void *ARENA::allocate( std::size_t bytes )
+{
+    bytes = round_up( std::max<std::size_t>( bytes, 1 ) );
+
+    if( blocks.empty() || offset + bytes > blocks.back().size )
+        add_block( std::max( { bytes, MIN_BLOCK, 2 * capacity() } ) );
+
+    void *p = blocks.back().data + offset;
+    offset += bytes;
+    in_use += bytes;
+
+    return p;
+}
+
+// release all allocations; overflow blocks are merged into one block large enough for this batch
+void ARENA::reset()
+{
+    if( blocks.size() > 1 )
+    {
+        std::size_t size = round_up( std::max( in_use, capacity() ) );
+
+        for( auto &b : blocks )
+            ::operator delete( b.data, std::align_val_t( ALIGNMENT ) );
+        blocks.clear();
+        add_block( size );
+    }
+
+    offset = 0;
+    in_use = 0;
+}
+
+std::size_t ARENA::capacity() const
+{
+    std::size_t size = 0;
+    for( auto &b : blocks )
+        size += b.size;
+    return size;
+}
+
+// aligned result columns for n trees
+BATCH_RESULT WORKSPACE::result_columns( std::size_t n, unsigned columns )
+{
+    BATCH_RESULT r;
+
+    if( columns & RESULT_VOLIB ) r.volib = column( n );
+    if( columns & RESULT_VOLOB ) r.volob = column( n );
+    if( columns & RESULT_WOOD ) r.wood = column( n );
+    if( columns & RESULT_BARK ) r.bark = column( n );
+    if( columns & RESULT_BRANCH ) r.branch = column( n );
+    if( columns & RESULT_FOLIAGE ) r.foliage = column( n );
+    if( columns & RESULT_TOTAL ) r.total = column( n );
+    if( columns & RESULT_AGB ) r.above_ground_biomass = column( n );
+
+    return r;
+}
+
+// evaluate a batch into workspace columns
+BATCH_RESULT WORKSPACE::evaluate( const TREE_BATCH &trees, unsigned columns, const BATCH_OPTIONS &options )
+{
+    TREE_BATCH batch = trees;
+
+    // dictionary divisions to per tree codes in the arena (evaluate_batch() would map them into a vector)
+    if( trees.division_index && !trees.division_codes )
+    {
+        DIVISION *dictionary = memory.allocate<DIVISION>( trees.division_dictionary_size );
+        dictionary_codes( trees, dictionary );
+
+        DIVISION *codes = memory.allocate<DIVISION>( trees.n );
+        for( std::size_t i = 0; i < trees.n; i++ )
+            codes[i] = tree_division( trees, dictionary, i );
+        batch.division_codes = codes;
+    }
+
+    BATCH_RESULT result = result_columns( trees.n, columns );
+    evaluate_batch( batch, result, options );
+
+    return result;
+}
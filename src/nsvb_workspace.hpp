@@ -0,0 +1,107 @@
+// National Scale Volume and Biomass estimators (NSVB) reusable batch workspace
+//
+// An ARENA hands out 64 byte aligned blocks from memory it keeps between batches; reset()
+// releases everything at once. When a batch needs more than the arena holds, overflow blocks
+// are allocated and replaced at the next reset() by one block of the high water size, so a
+// process evaluating batches of similar size stops allocating after the first few.
+// A WORKSPACE uses an arena for result columns, division codes and plan buffers.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_WORKSPACE_HPP
+#define NSVB_WORKSPACE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "nsvb_batch.hpp"
+
+// bump allocator with memory reused between batches
+class ARENA {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    explicit ARENA( std::size_t capacity = 0 );
+    ~ARENA();
+
+    ARENA( const ARENA & ) = delete;
+    ARENA &operator=( const ARENA & ) = delete;
+
+    // bytes aligned to ALIGNMENT, valid until reset()
+    void *allocate( std::size_t bytes );
+
+    // n default initialized objects (no destructors are run)
+    template <typename T>
+    T *allocate( std::size_t n )
+    {
+        static_assert( std::is_trivially_destructible_v<T> );
+
+        T *p = static_cast<T *>( allocate( n * sizeof( T ) ) );
+        std::uninitialized_default_construct_n( p, n );
+        return p;
+    }
+
+    // release all allocations, keeping (and if needed enlarging) the memory for the next batch
+    void reset();
+
+    std::size_t capacity() const;                       // bytes held
+    std::size_t used() const { return in_use; }         // bytes allocated since reset()
+    std::size_t heap_allocations() const { return allocations; }    // blocks obtained from the heap so far
+
+private:
+    struct BLOCK {
+        std::byte *data;
+        std::size_t size;
+    };
+
+    std::vector<BLOCK> blocks;          // blocks[0] is the main block, others are overflow
+    std::size_t offset = 0;             // next free byte of blocks.back()
+    std::size_t in_use = 0;
+    std::size_t allocations = 0;
+
+    void add_block( std::size_t size );
+};
+
+// result columns of a workspace
+enum RESULT_COLUMN : unsigned {
+    RESULT_VOLIB = 1u << 0,
+    RESULT_VOLOB = 1u << 1,
+    RESULT_WOOD = 1u << 2,
+    RESULT_BARK = 1u << 3,
+    RESULT_BRANCH = 1u << 4,
+    RESULT_FOLIAGE = 1u << 5,
+    RESULT_TOTAL = 1u << 6,
+    RESULT_AGB = 1u << 7,
+    RESULT_ALL = 0xFFu
+};
+
+// scratch and output memory for repeated batch evaluation
+class WORKSPACE {
+public:
+    explicit WORKSPACE( std::size_t capacity = 0 ) : memory( capacity ) {}
+
+    // aligned result columns for n trees (the columns not selected are nullptr)
+    BATCH_RESULT result_columns( std::size_t n, unsigned columns = RESULT_ALL );
+
+    // an aligned column of n doubles
+    double *column( std::size_t n ) { return memory.allocate<double>( n ); }
+
+    // plan buffer for n trees
+    NSVB_PLAN *plans( std::size_t n ) { return memory.allocate<NSVB_PLAN>( n ); }
+
+    // evaluate a batch into workspace columns; with one thread no heap memory is allocated
+    // once the arena has reached the batch size. Dictionary divisions are mapped to per tree codes.
+    BATCH_RESULT evaluate( const TREE_BATCH &trees, unsigned columns = RESULT_ALL, const BATCH_OPTIONS &options = {} );
+
+    // release the columns and buffers of the last batch
+    void reset() { memory.reset(); }
+
+    ARENA &arena() { return memory; }
+
+private:
+    ARENA memory;
+};
+
+#endif
@@ -0,0 +1,186 @@
+// National Scale Volume and Biomass estimators (NSVB) throughput benchmark
+//
+// usage: bench [trees] [threads]
+//
+// Evaluates the benchmark tree mix with the scalar API and with evaluate_batch() (plot order and
+// species sorted) and totals it by plot with rollup_plots(), and solves
+// for height from volib with a bisection root finder on compute_volib() and with solve_height().
+// Also the training workload of the profile guided optimization build (see CMakeLists.txt).
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "nsvb_inverse.hpp"
+#include "nsvb_numa.hpp"
+#include "nsvb_plan_table.hpp"
+#include "nsvb_rollup.hpp"
+#include "bench_trees.hpp"
+
+// seconds taken by f()
+template <typename F>
+double seconds( F &&f )
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static void report( const char *name, std::size_t n, double s, double check )
+{
+    std::cout << std::left << std::setw( 28 ) << name << std::right << std::setw( 10 ) << std::fixed << std::setprecision( 3 ) << s << " s "
+              << std::setw( 14 ) << std::setprecision( 0 ) << n / s << " trees/s   (check " << std::setprecision( 1 ) << check << ")\n";
+}
+
+int main( int argc, char **argv )
+{
+    std::size_t n = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 500000;
+    unsigned threads = argc > 2 ? std::atoi( argv[2] ) : std::max( 1u, std::thread::hardware_concurrency() );
+
+    BENCH_TREES t = bench_trees( n );
+    std::cout << "trees = " << n << ", threads = " << threads << "\n";
+
+    std::vector<double> volib( n ), volob( n ), agb( n );
+
+    double s = seconds( [&] {
+        for( std::size_t i = 0; i < n; i++ )
+        {
+            volib[i] = compute_volib( t.fia_spp[i], t.division[i], t.dbh[i], t.height[i] );
+            volob[i] = compute_volob( t.fia_spp[i], t.division[i], t.dbh[i], t.height[i] );
+            agb[i] = biomass_components( t.fia_spp[i], t.division[i], volib[i], t.dbh[i], t.height[i] ).above_ground_biomass;
+        }
+    } );
+    double check = 0.0;
+    for( double x : agb )
+        check += x;
+    report( "scalar", n, s, check );
+
+    TREE_BATCH batch;
+    batch.n = n;
+    batch.fia_spp = t.fia_spp.data();
+    batch.division = t.division.data();
+    batch.dbh = t.dbh.data();
+    batch.height = t.height.data();
+
+    BATCH_RESULT result;
+    result.volib = volib.data();
+    result.volob = volob.data();
+    result.above_ground_biomass = agb.data();
+
+    for( unsigned th : { 1u, threads } )
+    {
+        BATCH_OPTIONS options;
+        options.threads = th;
+
+        std::fill( agb.begin(), agb.end(), 0.0 );
+        s = seconds( [&] { evaluate_batch( batch, result, options ); } );
+        check = 0.0;
+        for( double x : agb )
+            check += x;
+        report( ( "batch (" + std::to_string( th ) + " threads)" ).c_str(), n, s, check );
+
+        if( threads == 1 )
+            break;
+    }
+
+    // species-sorted evaluation (plot ordered input)
+    {
+        BATCH_OPTIONS options;
+        options.threads = threads;
+        options.sort = true;
+
+        s = seconds( [&] { evaluate_batch( batch, result, options ); } );
+        check = 0.0;
+        for( double x : agb )
+            check += x;
+        report( ( "batch sorted (" + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+    }
+
+    // divisions as a dictionary and index column (as from an R factor)
+    std::vector<std::string> dictionary;
+    std::vector<int> index( n );
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        auto d = std::find( dictionary.begin(), dictionary.end(), t.division[i] );
+        index[i] = int( d - dictionary.begin() );
+        if( d == dictionary.end() )
+            dictionary.push_back( t.division[i] );
+    }
+    batch.division = nullptr;
+    batch.division_dictionary = dictionary.data();
+    batch.division_dictionary_size = dictionary.size();
+    batch.division_index = index.data();
+
+    BATCH_OPTIONS options;
+    options.threads = threads;
+    s = seconds( [&] { evaluate_batch( batch, result, options ); } );
+    check = 0.0;
+    for( double x : agb )
+        check += x;
+    report( ( "batch dictionary (" + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+
+    // with the precomputed plan table
+    std::cout << precompute_plans( threads ).report() << "\n";
+    s = seconds( [&] { evaluate_batch( batch, result, options ); } );
+    check = 0.0;
+    for( double x : agb )
+        check += x;
+    report( ( "batch table (" + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+
+    // workers pinned per NUMA node, results first touched on the node evaluating them
+    {
+        NUMA_RESULT placed( n, threads );
+        BATCH_OPTIONS numa;
+        numa.threads = threads;
+        numa.numa = true;
+        s = seconds( [&] { evaluate_batch( batch, placed.result(), numa ); } );
+        check = 0.0;
+        for( std::size_t i = 0; i < n; i++ )
+            check += placed.result().above_ground_biomass[i];
+        report( ( "batch numa (" + std::to_string( numa_nodes().size() ) + " nodes, " + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+    }
+
+    // plot totals without the per-tree table
+    std::vector<PLOT_TOTALS> plots;
+    s = seconds( [&] { plots = rollup_plots( batch, t.plot.data(), nullptr, threads ); } );
+    check = 0.0;
+    for( const auto &p : plots )
+        check += p.biomass.above_ground_biomass;
+    report( ( "rollup (" + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+
+    // height from volib: bisection on the scalar API (as a generic root finder would) vs solve_height()
+    batch.division = t.division.data();
+    batch.division_dictionary = nullptr;
+    batch.division_index = nullptr;
+    evaluate_batch( batch, result, options );
+
+    std::size_t m = std::min<std::size_t>( n, 20000 );
+    std::vector<double> height( n );
+    s = seconds( [&] {
+        for( std::size_t i = 0; i < m; i++ )
+        {
+            double lo = 1.0, hi = 400.0;
+            for( int it = 0; it < 50; it++ )
+            {
+                double mid = 0.5 * ( lo + hi );
+                ( compute_volib( t.fia_spp[i], t.division[i], t.dbh[i], mid ) < volib[i] ? lo : hi ) = mid;
+            }
+            height[i] = 0.5 * ( lo + hi );
+        }
+    } );
+    check = 0.0;
+    for( std::size_t i = 0; i < m; i++ )
+        check += volib[i] > 0.0 ? height[i] : 0.0;
+    report( "height bisection (scalar)", m, s, check );
+
+    INVERSE_OPTIONS inverse_options;
+    inverse_options.threads = threads;
+    s = seconds( [&] { solve_height( batch, INVERSE_VOLIB, volib.data(), height.data(), inverse_options ); } );
+    check = 0.0;
+    for( std::size_t i = 0; i < m; i++ )
+        check += volib[i] > 0.0 ? height[i] : 0.0;
+    report( ( "solve_height (" + std::to_string( threads ) + " threads)" ).c_str(), n, s, check );
+
+    return 0;
+}
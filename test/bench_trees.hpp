@@ -0,0 +1,85 @@
+// National Scale Volume and Biomass estimators (NSVB) benchmark tree mix
+//
+// Synthetic tree lists resembling an inventory: trees arrive in plot order, each plot holds
+// a few species of one division, common species dominate and a tail covers every species
+// in refs plus unknown codes.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_BENCH_TREES_HPP
+#define NSVB_BENCH_TREES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "nsvb.hpp"
+
+// tree list columns
+struct BENCH_TREES {
+    std::vector<int> plot;
+    std::vector<int> tree;
+    std::vector<int> fia_spp;
+    std::vector<std::string> division;
+    std::vector<double> dbh;
+    std::vector<double> height;
+
+    std::size_t size() const { return fia_spp.size(); }
+};
+
+// generate n trees in plots of about trees_per_plot trees
+inline BENCH_TREES bench_trees( std::size_t n, unsigned seed = 2024, int trees_per_plot = 24 )
+{
+    // common species (Douglas-fir, loblolly pine, red maple, white oak, northern red oak, ponderosa pine,
+    // sweetgum, balsam fir, lodgepole pine, quaking aspen, sugar maple, yellow-poplar, shortleaf pine, white fir)
+    static const int common[] = { 202, 131, 316, 802, 833, 122, 611, 12, 108, 746, 318, 621, 110, 15 };
+    static const char *divisions[] = { "", "210", "220", "230", "240", "260", "M210", "M240", "M260", "M330", "M310", "340", "130" };
+
+    std::vector<int> all;
+    for( const REF_RECORD &r : ref_table() )
+        all.push_back( r.fia_spp );
+
+    std::mt19937_64 rng( seed );
+    std::uniform_real_distribution<double> u( 0.0, 1.0 );
+    std::gamma_distribution<double> size( 2.0, 4.5 );
+    std::normal_distribution<double> noise( 0.0, 0.08 );
+
+    BENCH_TREES t;
+    t.plot.reserve( n ); t.tree.reserve( n ); t.fia_spp.reserve( n );
+    t.division.reserve( n ); t.dbh.reserve( n ); t.height.reserve( n );
+
+    int plot = 0;
+    while( t.size() < n )
+    {
+        plot++;
+
+        // a plot is in one division and holds up to four species
+        std::string division = divisions[rng() % std::size( divisions )];
+        int plot_spp[4];
+        for( int &s : plot_spp )
+        {
+            double p = u( rng );
+            s = p < 0.75 ? common[rng() % std::size( common )] : p < 0.99 ? all[rng() % all.size()] : 9000 + int( rng() % 100 );
+        }
+
+        int trees = 1 + int( rng() % ( 2 * trees_per_plot ) );
+        for( int i = 0; i < trees && t.size() < n; i++ )
+        {
+            double dbh = std::min( 60.0, 1.0 + size( rng ) );
+            double height = 4.5 + ( 140.0 * ( 1.0 - std::exp( -0.035 * dbh ) ) ) * std::exp( noise( rng ) );
+
+            t.plot.push_back( plot );
+            t.tree.push_back( i + 1 );
+            t.fia_spp.push_back( plot_spp[rng() % 4] );
+            t.division.push_back( division );
+            t.dbh.push_back( std::round( dbh * 10.0 ) / 10.0 );
+            t.height.push_back( std::round( height ) );
+        }
+    }
+
+    return t;
+}
+
+#endif
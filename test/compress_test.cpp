@@ -0,0 +1,181 @@
+// National Scale Volume and Biomass estimators (NSVB) compressed files test
+//
+// usage: compress_test [trees]
+//
+// For each compression built in: blocks of result-like text compressed with BLOCK_COMPRESSOR
+// and concatenated must read back unchanged through COMPRESSED_READER in reads of any size
+// (and through gzip -dc when available), and a truncated file must fail. A compressed CSV tree
+// list must read as the plain one, and run_pipeline() with compressed output and several format
+// workers must write the plain results once decompressed. Prints the compression rates.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nsvb_compress.hpp"
+#include "nsvb_pipeline.hpp"
+#include "bench_trees.hpp"
+
+static std::string read_text( const std::string &path )
+{
+    std::ifstream is( path, std::ios::binary );
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+static void write_text( const std::string &path, const std::string &text )
+{
+    std::ofstream os( path, std::ios::binary );
+    os << text;
+}
+
+// the whole stream of a file, read in pieces of random size
+static std::string read_stream( const std::string &path, std::mt19937 &rng )
+{
+    COMPRESSED_READER reader( path );
+    std::string text;
+    std::vector<char> piece( 300000 );
+    for( ;; )
+    {
+        std::size_t want = rng() % 3 ? 1 + rng() % 5000 : piece.size();
+        std::size_t n = reader.read( piece.data(), want );
+        text.append( piece.data(), n );
+        if( n < want )
+            return text;
+    }
+}
+
+// data compressed in blocks of random size
+static std::string compress_blocks( COMPRESSION c, const std::string &data, std::mt19937 &rng )
+{
+    BLOCK_COMPRESSOR compressor( c );
+    std::string all, packed;
+    for( std::size_t at = 0; at < data.size(); )
+    {
+        std::size_t n = std::min<std::size_t>( data.size() - at, rng() % 4 ? 1 + rng() % 200000 : 0 );
+        compressor.compress( std::string_view( data ).substr( at, n ), packed );
+        all += packed;
+        at += n;
+    }
+    return all;
+}
+
+int main( int argc, char **argv )
+{
+    std::size_t n = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 50000;
+    std::mt19937 rng( 48 );
+
+    char directory[] = "/tmp/nsvb_compress_XXXXXX";
+    if( !mkdtemp( directory ) )
+        return 1;
+    std::string dir = directory;
+
+    // a tree list, and its results as the reference text
+    BENCH_TREES t = bench_trees( n );
+    {
+        std::ofstream os( dir + "/trees.csv" );
+        os << "plot,tree,fia_spp,division,dbh,tht,tpa\n";
+        for( std::size_t i = 0; i < n; i++ )
+            os << t.plot[i] << "," << t.tree[i] << "," << t.fia_spp[i] << "," << t.division[i] << "," << t.dbh[i] << "," << t.height[i] << ","
+               << ( t.dbh[i] < 5.0 ? 74.965282 : 6.018046 ) << "\n";
+    }
+    TREE_FILE plain( dir + "/trees.csv" );
+    std::string csv = read_text( dir + "/trees.csv" );
+    TREE_COLUMNS expected_trees = plain.read_all();
+
+    std::string expected;
+    {
+        RESULT_WRITER out( dir + "/trees.out" );
+        run_pipeline( plain, plain.shards( 1 )[0], &out, nullptr );
+        out.close();
+        expected = read_text( dir + "/trees.out" );
+    }
+
+    bool gzip_tool = std::system( "gzip --version >/dev/null 2>&1" ) == 0;
+    bool ok = true;
+    std::ostringstream report;
+
+    for( int m = CP_NONE; m <= CP_LZ4; m++ )
+    {
+        COMPRESSION c = static_cast<COMPRESSION>( m );
+        if( !compression_available( c ) )
+        {
+            report << " " << compression_name( c ) << " (not built)";
+            continue;
+        }
+        std::string name = compression_name( c ), file = dir + "/blocks" + compression_extension( c );
+
+        // blocks concatenated
+        std::string packed = compress_blocks( c, expected, rng );
+        write_text( file, packed );
+        bool blocks_ok = read_stream( file, rng ) == expected && COMPRESSED_READER( file ).compression() == c;
+        if( c == CP_GZIP && gzip_tool )
+            blocks_ok = blocks_ok && std::system( ( "gzip -dc \"" + file + "\" > \"" + dir + "/gunzip.out\"" ).c_str() ) == 0
+                        && read_text( dir + "/gunzip.out" ) == expected;
+
+        // truncated
+        bool truncated_ok = c == CP_NONE;
+        if( c != CP_NONE )
+        {
+            write_text( dir + "/cut", packed.substr( 0, packed.size() - 7 ) );
+            try {
+                read_stream( dir + "/cut", rng );
+            } catch( const std::runtime_error & ) {
+                truncated_ok = true;
+            }
+        }
+
+        // compressed tree list
+        write_text( dir + "/trees.csv" + compression_extension( c ), compress_blocks( c, csv, rng ) );
+        TREE_FILE list( dir + "/trees.csv" + compression_extension( c ) );
+        TREE_COLUMNS trees = list.read_all();
+        std::vector<SHARD> shards = list.shards( 3 );
+        bool input_ok = list.compression() == c && trees.plot == expected_trees.plot && trees.fia_spp == expected_trees.fia_spp
+                        && trees.dbh == expected_trees.dbh && trees.height == expected_trees.height && trees.tpa == expected_trees.tpa
+                        && ( c == CP_NONE || shards[1].begin == shards[1].end );
+
+        // compressed output of the pipeline, from the compressed list
+        PIPELINE_OPTIONS options;
+        options.parsers = 2;
+        options.formatters = 3;
+        options.block_bytes = 100000;
+        options.output.compression = c;
+        {
+            RESULT_WRITER out( dir + "/pipeline.out" );
+            run_pipeline( list, list.shards( 1 )[0], &out, nullptr, options );
+            out.close();
+        }
+        bool output_ok = read_stream( dir + "/pipeline.out", rng ) == expected;
+
+        // rate
+        BLOCK_COMPRESSOR compressor( c );
+        std::string block;
+        auto start = std::chrono::steady_clock::now();
+        std::size_t compressed = 0;
+        for( std::size_t at = 0; at < expected.size(); at += 1u << 20 )
+        {
+            compressor.compress( std::string_view( expected ).substr( at, 1u << 20 ), block );
+            compressed += block.size();
+        }
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        bool method_ok = blocks_ok && truncated_ok && input_ok && output_ok;
+        ok = ok && method_ok;
+        report << " " << name << ( method_ok ? " ok" : " FAIL" ) << ( blocks_ok ? "" : " (blocks)" ) << ( truncated_ok ? "" : " (truncation)" )
+               << ( input_ok ? "" : " (input)" ) << ( output_ok ? "" : " (output)" ) << " " << expected.size() / seconds / 1e6 << " MB/s ratio "
+               << static_cast<double>( expected.size() ) / compressed << ";";
+    }
+
+    std::cout << "compressed files (" << n << " trees):" << report.str() << " " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    std::system( ( "rm -rf \"" + dir + "\"" ).c_str() );
+
+    return ok ? 0 : 1;
+}
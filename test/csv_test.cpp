@@ -0,0 +1,332 @@
+// National Scale Volume and Biomass estimators (NSVB) tree list CSV parser test
+//
+// usage: csv_test [lines]
+//
+// Compares the field parsers of nsvb_csv.hpp with std::from_chars and division_code() on
+// random numbers and text, and TREE_CSV::parse() with a line by line reference parser on
+// random tree lists (quoted and padded fields, CRLF and blank lines, extra and reordered
+// columns, no final line end) parsed whole and in pieces of a few rows. Prints the parse rate.
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nsvb_treefile.hpp"
+
+// one field as the parsers read it: a double or its bits
+static bool same_double( double a, double b )
+{
+    return std::memcmp( &a, &b, sizeof( a ) ) == 0 || ( std::isnan( a ) && std::isnan( b ) );
+}
+
+// a random number as text: digit strings with a point, printf formats, signs and junk
+static std::string random_number( std::mt19937 &rng )
+{
+    std::uniform_int_distribution<int> kind( 0, 9 ), digit( 0, 9 ), length( 1, 20 );
+    char text[64];
+    std::string s;
+
+    switch( kind( rng ) )
+    {
+        case 0: case 1: case 2:
+        {
+            int n = length( rng ), point = std::uniform_int_distribution<int>( -1, n )( rng );
+            for( int i = 0; i < n; i++ )
+            {
+                if( i == point )
+                    s += '.';
+                s += static_cast<char>( '0' + digit( rng ) );
+            }
+            break;
+        }
+        case 3: case 4:
+            std::snprintf( text, sizeof( text ), "%.*g", std::uniform_int_distribution<int>( 1, 17 )( rng ),
+                           std::uniform_real_distribution<double>( 0.0, 200.0 )( rng ) );
+            s = text;
+            break;
+        case 5:
+            std::snprintf( text, sizeof( text ), "%.*f", std::uniform_int_distribution<int>( 0, 6 )( rng ),
+                           std::uniform_real_distribution<double>( 0.0, 1e6 )( rng ) );
+            s = text;
+            break;
+        case 6:
+            std::snprintf( text, sizeof( text ), "%.17g", std::exp( std::uniform_real_distribution<double>( -700.0, 700.0 )( rng ) ) );
+            s = text;
+            break;
+        case 7:
+            s = std::to_string( static_cast<std::int64_t>( rng() ) - ( 1ll << 31 ) );
+            break;
+        case 8:
+        {
+            static const char *odd[] = { "", "NA", "-", ".", "1.2.3", "+5", "1e", "0x10", "inf", "nan", "1,5", " 1", "--1", "1e400", "9999999999" };
+            s = odd[rng() % ( sizeof( odd ) / sizeof( odd[0] ) )];
+            break;
+        }
+        default:
+            s = std::to_string( std::uniform_int_distribution<int>( 0, 99999 )( rng ) );
+            break;
+    }
+    if( rng() % 4 == 0 )
+        s = "-" + s;
+    return s;
+}
+
+static bool check_fields( std::mt19937 &rng, int count )
+{
+    for( int i = 0; i < count; i++ )
+    {
+        std::string s = random_number( rng );
+        const char *end = s.data() + s.size();
+
+        double a = 0.0, b = 0.0;
+        auto [last, error] = std::from_chars( s.data(), end, b );
+        bool expected = error == std::errc() && last == end;
+        if( s.empty() || s == "NA" )
+        {
+            expected = true;
+            b = std::numeric_limits<double>::quiet_NaN();
+        }
+        if( csv_double( s, a ) != expected || ( expected && !same_double( a, b ) ) )
+        {
+            std::cout << "csv_double( \"" << s << "\" ) differs from from_chars\n";
+            return false;
+        }
+
+        int x = 0, y = 0;
+        auto [int_last, int_error] = std::from_chars( s.data(), end, y );
+        expected = int_error == std::errc() && int_last == end;
+        if( csv_int( s, x ) != expected || ( expected && x != y ) )
+        {
+            std::cout << "csv_int( \"" << s << "\" ) differs from from_chars\n";
+            return false;
+        }
+    }
+
+    for( int d = 0; d < DIV_COUNT; d++ )
+    {
+        std::string name = division_name( static_cast<DIVISION>( d ) );
+        for( std::string s : { name, name + "0", name.empty() ? name : name.substr( 1 ), std::string( "M2400000" ) } )
+            if( csv_division( s ) != division_code( s ) )
+            {
+                std::cout << "csv_division( \"" << s << "\" ) differs from division_code\n";
+                return false;
+            }
+    }
+
+    return true;
+}
+
+// reference: the header, then each line split at commas and each field trimmed and parsed
+static TREE_COLUMNS reference( const std::string &text )
+{
+    auto trim = []( std::string s ) {
+        while( !s.empty() && ( s.front() == ' ' || s.front() == '"' ) )
+            s.erase( 0, 1 );
+        while( !s.empty() && ( s.back() == ' ' || s.back() == '"' || s.back() == '\r' ) )
+            s.pop_back();
+        return s;
+    };
+    auto split = [&]( const std::string &line ) {
+        std::vector<std::string> fields;
+        std::stringstream ss( line );
+        std::string f;
+        while( std::getline( ss, f, ',' ) )
+            fields.push_back( trim( f ) );
+        if( !line.empty() && line.back() == ',' )
+            fields.push_back( "" );
+        return fields;
+    };
+    auto real = []( const std::string &s ) {
+        double x = std::numeric_limits<double>::quiet_NaN();
+        if( !s.empty() && s != "NA" )
+            std::from_chars( s.data(), s.data() + s.size(), x );
+        return x;
+    };
+
+    std::stringstream is( text );
+    std::string line;
+    std::getline( is, line );
+    std::vector<std::string> header = split( line );
+    auto field = [&]( const char *name ) {
+        for( std::size_t f = 0; f < header.size(); f++ )
+            if( header[f] == name )
+                return static_cast<int>( f );
+        return -1;
+    };
+    int plot = field( "plot" ), tree = field( "tree" ), spp = field( "fia_spp" ), division = field( "division" ), dbh = field( "dbh" ),
+        height = field( "tht" ), vtotib = field( "vtotib" ), planted = field( "planted" ), tpa = field( "tpa" );
+
+    TREE_COLUMNS trees;
+    while( std::getline( is, line ) )
+    {
+        if( trim( line ).empty() )
+            continue;
+        std::vector<std::string> f = split( line );
+        trees.plot.push_back( std::stoi( f[plot] ) );
+        trees.tree.push_back( std::stoi( f[tree] ) );
+        trees.fia_spp.push_back( std::stoi( f[spp] ) );
+        trees.division.push_back( division_code( f[division] ) );
+        trees.dbh.push_back( real( f[dbh] ) );
+        trees.height.push_back( real( f[height] ) );
+        if( vtotib >= 0 )
+            trees.vtotib.push_back( real( f[vtotib] ) );
+        if( planted >= 0 )
+            trees.planted.push_back( f[planted] == "TRUE" || f[planted] == "1" );
+        if( tpa >= 0 )
+            trees.tpa.push_back( real( f[tpa] ) );
+    }
+    return trees;
+}
+
+template <typename T>
+static bool same_column( const std::vector<T> &a, const std::vector<T> &b )
+{
+    if( a.size() != b.size() )
+        return false;
+    for( std::size_t i = 0; i < a.size(); i++ )
+        if constexpr( std::is_same_v<T, double> )
+        {
+            if( !same_double( a[i], b[i] ) )
+                return false;
+        }
+        else if( a[i] != b[i] )
+            return false;
+    return true;
+}
+
+static bool same_trees( const TREE_COLUMNS &a, const TREE_COLUMNS &b )
+{
+    return same_column( a.plot, b.plot ) && same_column( a.tree, b.tree ) && same_column( a.fia_spp, b.fia_spp ) && same_column( a.division, b.division )
+           && same_column( a.dbh, b.dbh ) && same_column( a.height, b.height ) && same_column( a.vtotib, b.vtotib ) && same_column( a.planted, b.planted )
+           && same_column( a.tpa, b.tpa );
+}
+
+// a random tree list with every optional column in some lists and awkward formatting
+static std::string random_list( std::mt19937 &rng, int lines, bool optional )
+{
+    static const char *divisions[] = { "240", "M240", "M210", "", "NA", "999", "M3300" };
+    std::string text = optional ? "note,division,plot,tree,fia_spp,dbh,tht,vtotib,planted,tpa\n" : "plot,tree,fia_spp,division,dbh,tht\n";
+    char number[32];
+
+    for( int i = 0; i < lines; i++ )
+    {
+        auto real = [&]( double x ) {
+            int r = rng() % 16;
+            if( r == 0 )
+                return std::string( "NA" );
+            if( r == 1 )
+                return std::string();
+            std::snprintf( number, sizeof( number ), r == 2 ? "%.17g" : r == 3 ? "%.3e" : "%.1f", x );
+            return std::string( r == 4 ? " " : "" ) + number;
+        };
+        std::string division = std::string( "\"" ) + divisions[rng() % 7] + "\"";
+        double dbh = 1.0 + ( rng() % 3000 ) / 100.0;
+        std::string plot = std::to_string( i / 7 ), tree = std::to_string( i % 7 ), spp = std::to_string( 100 + rng() % 900 );
+
+        if( optional )
+            text += "x," + division + "," + plot + "," + tree + "," + spp + "," + real( dbh ) + "," + real( 10.0 + 3.0 * dbh ) + "," + real( dbh * dbh / 10.0 )
+                    + "," + ( rng() % 2 ? "TRUE" : "0" ) + "," + real( 6.018046 ) + ",extra";
+        else
+            text += plot + "," + tree + "," + spp + "," + division + "," + real( dbh ) + "," + real( 10.0 + 3.0 * dbh );
+        text += rng() % 8 == 0 ? "\r\n" : "\n";
+        if( rng() % 50 == 0 )
+            text += rng() % 2 ? "\n" : "  \r\n";
+    }
+    if( rng() % 2 && text.back() == '\n' )
+        text.pop_back();
+    return text;
+}
+
+static bool check_lists( const std::string &dir, std::mt19937 &rng, int lines )
+{
+    for( int list = 0; list < 8; list++ )
+    {
+        std::string text = random_list( rng, lines, list % 2 ), path = dir + "/list.csv";
+        {
+            FILE *f = std::fopen( path.c_str(), "wb" );
+            std::fwrite( text.data(), 1, text.size(), f );
+            std::fclose( f );
+        }
+        TREE_FILE file( path );
+        TREE_COLUMNS expected = reference( text ), whole = file.read_all();
+
+        // a few rows at a time from arbitrary offsets within the lines
+        std::size_t begin = text.find( '\n' ) + 1;
+        std::string_view rest( text.data() + begin, text.size() - begin );
+        TREE_COLUMNS pieces;
+        for( std::size_t done = 0; done < rest.size(); )
+            done += file.parse( rest.substr( done ), begin + done, pieces, 1 + rng() % 5 );
+
+        if( !same_trees( whole, expected ) || !same_trees( pieces, expected ) )
+        {
+            std::cout << "tree list " << list << " differs from the reference parser\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    int lines = argc > 1 ? std::atoi( argv[1] ) : 20000;
+    std::mt19937 rng( 46 );
+
+    char directory[] = "/tmp/nsvb_csv_XXXXXX";
+    if( !mkdtemp( directory ) )
+        return 1;
+    std::string dir = directory;
+
+    bool fields_ok = check_fields( rng, 200000 );
+    bool lists_ok = check_lists( dir, rng, lines );
+
+    // the line of a bad field
+    bool error_ok = false;
+    try {
+        FILE *f = std::fopen( ( dir + "/bad.csv" ).c_str(), "wb" );
+        std::fputs( "plot,tree,fia_spp,division,dbh,tht\n", f );
+        std::fclose( f );
+        TREE_FILE file( dir + "/bad.csv" );
+        std::string text = "1,2,131,240,10.5,60\n1,3,131,240,1O.5,60\n";
+        TREE_COLUMNS trees;
+        file.parse( text, 1000, trees );
+    } catch( const std::exception &e ) {
+        error_ok = std::strstr( e.what(), "line at byte 1020" ) && std::strstr( e.what(), "'1O.5'" );
+    }
+
+    // parse rate
+    std::string text = random_list( rng, 500000, false );
+    std::string_view rows( text.data() + text.find( '\n' ) + 1 );
+    {
+        FILE *f = std::fopen( ( dir + "/rate.csv" ).c_str(), "wb" );
+        std::fwrite( text.data(), 1, text.size(), f );
+        std::fclose( f );
+    }
+    TREE_FILE file( dir + "/rate.csv" );
+    TREE_COLUMNS trees;
+    double best = 1e9;
+    for( int r = 0; r < 5; r++ )
+    {
+        trees.clear();
+        auto start = std::chrono::steady_clock::now();
+        file.parse( rows, 0, trees );
+        best = std::min( best, std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+    }
+
+    bool ok = fields_ok && lists_ok && error_ok;
+    std::cout << "tree list CSV parser (" << csv_scan_isa() << "): fields " << ( fields_ok ? "ok" : "differ" ) << ", lists " << ( lists_ok ? "ok" : "differ" )
+              << ", bad field " << ( error_ok ? "reported" : "not reported" ) << "; " << rows.size() / best / 1e6 << " MB/s, "
+              << trees.size() / best / 1e6 << " M lines/s: " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    std::system( ( "rm -rf \"" + dir + "\"" ).c_str() );
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,351 @@
+// National Scale Volume and Biomass estimators (NSVB) result formatting test
+//
+// usage: format_test [rows]
+//
+// Formats random results (any bit pattern, typical magnitudes, NaN and infinities) with
+// format_trees(): CSV numbers must read back with strtod to the same double, fixed precision
+// must equal printf's %.Nf, TSV must be CSV with tabs, and NDJSON lines must hold the same
+// values with keys (null for NaN and infinities). Plot totals are checked the same way, and
+// RESULT_WRITER must write mixed small and large blocks unchanged. Prints the formatting rate
+// against snprintf %.17g.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "nsvb_format.hpp"
+#include "nsvb_green.hpp"
+
+static bool same_double( double a, double b )
+{
+    return std::memcmp( &a, &b, sizeof( a ) ) == 0 || ( std::isnan( a ) && std::isnan( b ) );
+}
+
+static std::vector<std::string> split( const std::string &line, char separator )
+{
+    std::vector<std::string> fields;
+    std::stringstream s( line );
+    std::string field;
+    while( std::getline( s, field, separator ) )
+        fields.push_back( field );
+    return fields;
+}
+
+static std::vector<std::string> lines_of( const std::string &text )
+{
+    return split( text, '\n' );
+}
+
+// a random result: any finite bit pattern, a typical value, a small integer, NaN or an infinity
+static double random_value( std::mt19937_64 &rng )
+{
+    std::uniform_int_distribution<int> kind( 0, 19 );
+    std::uniform_real_distribution<double> typical( 0.0, 5000.0 );
+    double x;
+
+    switch( kind( rng ) )
+    {
+        case 0: case 1: case 2: case 3:
+            do {
+                std::uint64_t bits = rng();
+                std::memcpy( &x, &bits, sizeof( x ) );
+            } while( !std::isfinite( x ) );
+            return x;
+        case 4: return std::floor( typical( rng ) );
+        case 5: return std::numeric_limits<double>::quiet_NaN();
+        case 6: return rng() & 1 ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+        case 7: return 0.0;
+        default: return typical( rng ) * std::pow( 10.0, static_cast<int>( rng() % 7 ) - 3 );
+    }
+}
+
+struct RESULTS {
+    TREE_COLUMNS trees;
+    std::vector<double> columns[8];
+
+    double value( std::size_t i, int c ) const
+    {
+        return c < 8 ? columns[c][i] : green_tons( species_green_factors( trees.fia_spp[i] ), columns[1][i], columns[0][i] );
+    }
+};
+
+static RESULTS random_results( std::mt19937_64 &rng, std::size_t n, bool fixed )
+{
+    static const int species[] = { 202, 131, 316, 802, 12, 9999 };
+    RESULTS r;
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        r.trees.plot.push_back( static_cast<int>( rng() % 100000 ) - 10 );
+        r.trees.tree.push_back( static_cast<int>( i ) );
+        r.trees.fia_spp.push_back( species[rng() % 6] );
+        r.trees.division.push_back( static_cast<DIVISION>( rng() % DIV_COUNT ) );
+        for( int c = 0; c < 8; c++ )
+        {
+            double x = random_value( rng );
+            if( fixed && std::isfinite( x ) && std::fabs( x ) > 1e12 )
+                x = std::fmod( x, 1e12 );
+            r.columns[c].push_back( x );
+        }
+    }
+    r.trees.dbh.resize( n );
+    r.trees.height.resize( n );
+    return r;
+}
+
+// CSV, TSV and NDJSON lines of the results agree with the values
+static bool check_trees( std::mt19937_64 &rng, std::size_t n )
+{
+    RESULTS r = random_results( rng, n, false );
+
+    std::string csv, tsv, json;
+    format_trees( r.trees, r.columns, csv );
+    format_trees( r.trees, r.columns, tsv, { OF_TSV, -1 } );
+    format_trees( r.trees, r.columns, json, { OF_NDJSON, -1 } );
+
+    std::vector<std::string> csv_lines = lines_of( csv ), tsv_lines = lines_of( tsv ), json_lines = lines_of( json );
+    if( csv_lines.size() != n || tsv_lines.size() != n || json_lines.size() != n )
+        return false;
+
+    std::vector<std::string> keys = split( tree_results_header( {} ).substr( 0, tree_results_header( {} ).size() - 1 ), ',' );
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        std::vector<std::string> fields = split( csv_lines[i], ',' );
+        if( fields.size() != 13 || split( tsv_lines[i], '\t' ) != fields )
+            return false;
+        if( fields[0] != std::to_string( r.trees.plot[i] ) || fields[1] != std::to_string( r.trees.tree[i] )
+            || fields[2] != std::to_string( r.trees.fia_spp[i] ) || fields[3] != division_name( r.trees.division[i] ) )
+            return false;
+
+        const std::string &line = json_lines[i];
+        if( line.front() != '{' || line.back() != '}' )
+            return false;
+        std::vector<std::string> members = split( line.substr( 1, line.size() - 2 ), ',' );
+        if( members.size() != 13 )
+            return false;
+
+        for( int c = 0; c < 13; c++ )
+        {
+            std::string key = "\"" + keys[c] + "\":";
+            if( members[c].compare( 0, key.size(), key ) )
+                return false;
+            std::string member = members[c].substr( key.size() );
+            if( c < 4 )
+            {
+                if( member != ( c == 3 ? "\"" + fields[3] + "\"" : fields[c] ) )
+                    return false;
+                continue;
+            }
+
+            double x = r.value( i, c - 4 );
+            if( std::isnan( x ) ? fields[c] != "NA" : !same_double( std::strtod( fields[c].c_str(), nullptr ), x ) )
+                return false;
+            if( std::isfinite( x ) ? member != fields[c] : member != "null" )
+                return false;
+        }
+    }
+    return true;
+}
+
+// fixed decimals equal printf's
+static bool check_fixed( std::mt19937_64 &rng, std::size_t n )
+{
+    RESULTS r = random_results( rng, n, true );
+
+    for( int precision : { 0, 1, 3, 6, 17 } )
+    {
+        std::string csv;
+        format_trees( r.trees, r.columns, csv, { OF_CSV, precision } );
+        std::vector<std::string> csv_lines = lines_of( csv );
+        if( csv_lines.size() != n )
+            return false;
+
+        for( std::size_t i = 0; i < n; i++ )
+        {
+            std::vector<std::string> fields = split( csv_lines[i], ',' );
+            for( int c = 0; c < 9; c++ )
+            {
+                double x = r.value( i, c );
+                char text[400];
+                std::snprintf( text, sizeof( text ), "%.*f", precision, x );
+                if( fields[4 + c] != ( std::isnan( x ) ? "NA" : text ) )
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+// plot totals in each format
+static bool check_plots( std::mt19937_64 &rng, std::size_t n )
+{
+    std::vector<PLOT_TOTALS> plots( n );
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        PLOT_TOTALS &p = plots[i];
+        p.plot = static_cast<int>( i ) - 5;
+        p.trees = rng() % 1000;
+        for( double *x : { &p.tpa, &p.volib, &p.volob, &p.green_tons, &p.biomass.wood, &p.biomass.bark, &p.biomass.branch,
+                           &p.biomass.foliage, &p.biomass.total, &p.biomass.above_ground_biomass } )
+            *x = random_value( rng );
+    }
+
+    std::string csv = plot_totals_header( {} ), tsv = plot_totals_header( { OF_TSV, -1 } ), json = plot_totals_header( { OF_NDJSON, -1 } );
+    format_plots( plots, csv );
+    format_plots( plots, tsv, { OF_TSV, -1 } );
+    format_plots( plots, json, { OF_NDJSON, -1 } );
+
+    std::vector<std::string> csv_lines = lines_of( csv ), tsv_lines = lines_of( tsv ), json_lines = lines_of( json );
+    if( csv_lines.size() != n + 1 || tsv_lines.size() != n + 1 || json_lines.size() != n )
+        return false;
+
+    std::vector<std::string> keys = split( csv_lines[0], ',' );
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        const PLOT_TOTALS &p = plots[i];
+        std::vector<std::string> fields = split( csv_lines[i + 1], ',' );
+        std::vector<std::string> members = split( json_lines[i].substr( 1, json_lines[i].size() - 2 ), ',' );
+        if( fields.size() != 12 || split( tsv_lines[i + 1], '\t' ) != fields || members.size() != 12 )
+            return false;
+        if( fields[0] != std::to_string( p.plot ) || fields[1] != std::to_string( p.trees ) )
+            return false;
+
+        const double values[] = { p.tpa, p.volib, p.volob, p.green_tons, p.biomass.wood, p.biomass.bark, p.biomass.branch,
+                                  p.biomass.foliage, p.biomass.total, p.biomass.above_ground_biomass };
+        for( int c = 0; c < 12; c++ )
+        {
+            std::string key = "\"" + keys[c] + "\":";
+            if( members[c].compare( 0, key.size(), key ) )
+                return false;
+            std::string member = members[c].substr( key.size() );
+            if( c < 2 )
+            {
+                if( member != fields[c] )
+                    return false;
+                continue;
+            }
+            double x = values[c - 2];
+            if( std::isnan( x ) ? fields[c] != "NA" : !same_double( std::strtod( fields[c].c_str(), nullptr ), x ) )
+                return false;
+            if( std::isfinite( x ) ? member != fields[c] : member != "null" )
+                return false;
+        }
+    }
+    return true;
+}
+
+static std::string read_text( const std::string &path )
+{
+    std::ifstream is( path, std::ios::binary );
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+// small and large blocks through a small buffer, to a path and to a descriptor
+static bool check_writer( std::mt19937_64 &rng, const std::string &dir )
+{
+    std::string expected;
+    {
+        RESULT_WRITER out( dir + "/writer.out", 4096 );
+        for( int i = 0; i < 2000; i++ )
+        {
+            std::string block( rng() % 3 ? rng() % 100 : rng() % 20000, static_cast<char>( 'a' + i % 26 ) );
+            out.write( block );
+            expected += block;
+        }
+        if( out.bytes() != expected.size() )
+            return false;
+        out.close();
+    }
+    if( read_text( dir + "/writer.out" ) != expected )
+        return false;
+
+    int fd = ::open( ( dir + "/fd.out" ).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    {
+        RESULT_WRITER out( fd, 100 );
+        out.write( expected );
+        out.write( "end\n" );
+    }
+    ::close( fd );
+    if( read_text( dir + "/fd.out" ) != expected + "end\n" )
+        return false;
+
+    try {
+        RESULT_WRITER out( dir + "/missing/x.out" );
+        return false;
+    } catch( const std::runtime_error & ) {
+    }
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    std::size_t rows = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 20000;
+    std::mt19937_64 rng( 47 );
+
+    char directory[] = "/tmp/nsvb_format_XXXXXX";
+    if( !mkdtemp( directory ) )
+        return 1;
+    std::string dir = directory;
+
+    bool trees_ok = check_trees( rng, rows );
+    bool fixed_ok = check_fixed( rng, rows / 4 );
+    bool plots_ok = check_plots( rng, rows / 4 );
+    bool writer_ok = check_writer( rng, dir );
+
+    // formatting rate of typical results, against snprintf %.17g
+    std::mt19937_64 typical_rng( 1 );
+    RESULTS r = random_results( typical_rng, 100000, true );
+    for( auto &column : r.columns )
+        for( double &x : column )
+            if( !std::isfinite( x ) )
+                x = 1.5;
+    double best = 1e30, best_printf = 1e30;
+    std::size_t bytes = 0;
+    std::string out;
+    for( int rep = 0; rep < 3; rep++ )
+    {
+        auto start = std::chrono::steady_clock::now();
+        out.clear();
+        format_trees( r.trees, r.columns, out );
+        best = std::min( best, std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+        bytes = out.size();
+
+        start = std::chrono::steady_clock::now();
+        out.clear();
+        char text[64];
+        for( std::size_t i = 0; i < r.trees.size(); i++ )
+        {
+            std::snprintf( text, sizeof( text ), "%d,%d,%d,%s", r.trees.plot[i], r.trees.tree[i], r.trees.fia_spp[i], division_name( r.trees.division[i] ) );
+            out += text;
+            for( int c = 0; c < 9; c++ )
+            {
+                std::snprintf( text, sizeof( text ), ",%.17g", r.value( i, c ) );
+                out += text;
+            }
+            out += '\n';
+        }
+        best_printf = std::min( best_printf, std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+    }
+
+    bool ok = trees_ok && fixed_ok && plots_ok && writer_ok;
+    std::cout << "result formatting (" << rows << " rows): trees " << ( trees_ok ? "ok" : "FAIL" ) << ", fixed " << ( fixed_ok ? "ok" : "FAIL" )
+              << ", plots " << ( plots_ok ? "ok" : "FAIL" ) << ", writer " << ( writer_ok ? "ok" : "FAIL" ) << "; "
+              << bytes / best / 1e6 << " MB/s (" << r.trees.size() / best / 1e6 << " M rows/s, snprintf "
+              << r.trees.size() / best_printf / 1e6 << " M rows/s): " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    std::system( ( "rm -rf \"" + dir + "\"" ).c_str() );
+
+    return ok ? 0 : 1;
+}
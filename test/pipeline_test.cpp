@@ -0,0 +1,214 @@
+// National Scale Volume and Biomass estimators (NSVB) streaming pipeline test
+//
+// usage: pipeline_test [trees]
+//
+// Passes numbers through the SPSC and MPMC queues from several threads (every item must arrive
+// once, in order for SPSC), then runs a synthetic tree list through run_pipeline() with one
+// worker per stage and large blocks, and with several workers, shallow queues and small blocks.
+// Tree results (written by RESULT_WRITER with a large and with a small buffer) must be
+// identical and equal format_trees() of the whole list; plot totals agree
+// within rounding. A bad line in the middle of the file must fail the pipeline without hanging.
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nsvb_pipeline.hpp"
+#include "nsvb_queue.hpp"
+#include "bench_trees.hpp"
+
+// one producer, one consumer: items arrive in order
+static bool check_spsc( std::uint64_t items )
+{
+    SPSC_QUEUE<std::uint64_t> queue( 8 );
+    bool ordered = true;
+
+    std::thread consumer( [&] {
+        for( std::uint64_t expected = 0; expected < items; )
+        {
+            std::uint64_t x;
+            if( !queue.try_pop( x ) )
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered = ordered && x == expected;
+            expected++;
+        }
+    } );
+    for( std::uint64_t i = 0; i < items; )
+    {
+        std::uint64_t x = i;
+        if( queue.try_push( x ) )
+            i++;
+        else
+            std::this_thread::yield();
+    }
+    consumer.join();
+
+    return ordered;
+}
+
+// several producers and consumers through a STAGE_QUEUE: every item arrives once
+static bool check_mpmc( unsigned producers, unsigned consumers, std::uint64_t items )
+{
+    std::atomic<bool> abort{ false };
+    STAGE_QUEUE<std::uint64_t> queue( 4, producers, consumers, abort );
+    std::atomic<std::uint64_t> count{ 0 }, sum{ 0 };
+
+    std::vector<std::thread> threads;
+    for( unsigned p = 0; p < producers; p++ )
+        threads.emplace_back( [&, p] {
+            for( std::uint64_t i = p; i < items; i += producers )
+            {
+                std::uint64_t x = i;
+                queue.push( x );
+            }
+            queue.producer_done();
+        } );
+    for( unsigned c = 0; c < consumers; c++ )
+        threads.emplace_back( [&] {
+            std::uint64_t x;
+            while( queue.pop( x ) )
+            {
+                count++;
+                sum += x;
+            }
+        } );
+    for( auto &t : threads )
+        t.join();
+
+    return count == items && sum == items * ( items - 1 ) / 2;
+}
+
+static std::vector<std::vector<double>> plot_rows( const std::vector<PLOT_TOTALS> &plots )
+{
+    std::vector<std::vector<double>> rows;
+    for( const PLOT_TOTALS &p : plots )
+        rows.push_back( { double( p.plot ), double( p.trees ), p.tpa, p.volib, p.volob, p.green_tons, p.biomass.wood, p.biomass.bark,
+                          p.biomass.branch, p.biomass.foliage, p.biomass.total, p.biomass.above_ground_biomass } );
+    return rows;
+}
+
+static std::string read_text( const std::string &path )
+{
+    std::ifstream is( path, std::ios::binary );
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+static bool same_plots( const std::vector<PLOT_TOTALS> &a, const std::vector<PLOT_TOTALS> &b )
+{
+    auto x = plot_rows( a ), y = plot_rows( b );
+    if( x.size() != y.size() )
+        return false;
+    for( std::size_t i = 0; i < x.size(); i++ )
+        for( std::size_t j = 0; j < x[i].size(); j++ )
+            if( std::abs( x[i][j] - y[i][j] ) > 1e-12 * std::max( 1.0, std::abs( x[i][j] ) ) )
+                return false;
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    std::size_t n = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 50000;
+
+    bool queues_ok = check_spsc( 200000 ) && check_mpmc( 1, 3, 100000 ) && check_mpmc( 3, 1, 100000 ) && check_mpmc( 3, 3, 100000 );
+
+    char directory[] = "/tmp/nsvb_pipeline_XXXXXX";
+    if( !mkdtemp( directory ) )
+        return 1;
+    std::string dir = directory;
+
+    BENCH_TREES t = bench_trees( n );
+    {
+        std::ofstream os( dir + "/trees.csv" );
+        os << "plot,tree,fia_spp,division,dbh,tht,tpa\n";
+        for( std::size_t i = 0; i < n; i++ )
+            os << t.plot[i] << "," << t.tree[i] << "," << t.fia_spp[i] << "," << t.division[i] << "," << t.dbh[i] << "," << t.height[i] << ","
+               << ( t.dbh[i] < 5.0 ? 74.965282 : 6.018046 ) << "\n";
+    }
+    TREE_FILE file( dir + "/trees.csv" );
+    SHARD all = file.shards( 1 )[0];
+
+    // reference: the whole list at once
+    TREE_COLUMNS trees = file.read_all();
+    TREE_BATCH batch = trees.batch();
+    std::vector<double> columns[8];
+    BATCH_RESULT result;
+    double **to[] = { &result.volib, &result.volob, &result.wood, &result.bark, &result.branch, &result.foliage, &result.total,
+                      &result.above_ground_biomass };
+    for( int c = 0; c < 8; c++ )
+    {
+        columns[c].resize( trees.size() );
+        *to[c] = columns[c].data();
+    }
+    evaluate_batch( batch, result );
+    std::string expected;
+    format_trees( trees, columns, expected );
+    std::vector<PLOT_TOTALS> expected_plots = rollup_plots( batch, trees.plot.data(), trees.tpa.data() );
+
+    struct { unsigned parsers, evaluators, formatters, depth; std::size_t block_bytes, buffer_bytes; } configs[] = {
+        { 1, 1, 1, 4, 1u << 26, 1u << 20 }, { 1, 1, 1, 1, 4096, 1000 }, { 2, 3, 2, 2, 65536, 1u << 20 }, { 3, 2, 3, 1, 1000, 1000 } };
+
+    bool pipeline_ok = true;
+    for( auto &c : configs )
+    {
+        PIPELINE_OPTIONS options;
+        options.parsers = c.parsers;
+        options.evaluators = c.evaluators;
+        options.formatters = c.formatters;
+        options.depth = c.depth;
+        options.block_bytes = c.block_bytes;
+
+        PLOT_MERGE plots;
+        PIPELINE_STATS stats;
+        {
+            RESULT_WRITER out( dir + "/trees.out", c.buffer_bytes );
+            stats = run_pipeline( file, all, &out, &plots, options );
+            out.close();
+        }
+        bool ok = read_text( dir + "/trees.out" ) == expected && stats.trees == n && same_plots( plots.plots, expected_plots );
+        pipeline_ok = pipeline_ok && ok;
+        std::cout << c.parsers << "/" << c.evaluators << "/" << c.formatters << " workers, depth " << c.depth << ", " << c.block_bytes
+                  << " byte blocks: " << stats.blocks << " blocks " << ( ok ? "ok" : "differ" ) << "\n";
+    }
+
+    // a bad dbh half way through
+    {
+        std::ofstream os( dir + "/bad.csv" );
+        os << "plot,tree,fia_spp,division,dbh,tht\n";
+        for( std::size_t i = 0; i < n; i++ )
+            os << t.plot[i] << "," << t.tree[i] << "," << t.fia_spp[i] << "," << t.division[i] << "," << ( i == n / 2 ? "x" : std::to_string( t.dbh[i] ) )
+               << "," << t.height[i] << "\n";
+    }
+    bool error_ok = false;
+    try {
+        TREE_FILE bad( dir + "/bad.csv" );
+        PIPELINE_OPTIONS options;
+        options.parsers = 2;
+        options.evaluators = 2;
+        options.depth = 1;
+        options.block_bytes = 4096;
+        RESULT_WRITER out( dir + "/bad.out" );
+        PLOT_MERGE plots;
+        run_pipeline( bad, bad.shards( 1 )[0], &out, &plots, options );
+    } catch( const std::exception &e ) {
+        error_ok = std::string( e.what() ).find( "dbh" ) != std::string::npos;
+    }
+
+    bool ok = queues_ok && pipeline_ok && error_ok;
+    std::cout << "streaming pipeline (" << n << " trees): queues " << ( queues_ok ? "ok" : "FAIL" ) << ", results " << ( pipeline_ok ? "ok" : "differ" )
+              << ", bad line " << ( error_ok ? "reported" : "not reported" ) << ": " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    std::system( ( "rm -rf \"" + dir + "\"" ).c_str() );
+
+    return ok ? 0 : 1;
+}
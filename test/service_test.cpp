@@ -0,0 +1,286 @@
+// National Scale Volume and Biomass estimators (NSVB) evaluation service loopback test
+//
+// usage: service_test [clients] [requests per client]
+//
+// Starts the service on a free loopback port and sends concurrent JSON and binary requests
+// over keep-alive connections. Results must equal the scalar reference, concurrent requests
+// must be coalesced into fewer batches, and errors (malformed JSON, invalid numbers, trailing text,
+// unknown endpoints) must be reported. A service stopped while clients keep sending must stop, and
+// then refuse to evaluate.
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "nsvb_service.hpp"
+#include "bench_trees.hpp"
+
+// a keep-alive HTTP client connection
+struct CLIENT {
+    int fd;
+    std::string buffer;
+
+    explicit CLIENT( unsigned short port )
+    {
+        fd = socket( AF_INET, SOCK_STREAM, 0 );
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons( port );
+        inet_pton( AF_INET, "127.0.0.1", &address.sin_addr );
+        if( connect( fd, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) < 0 )
+            throw std::runtime_error( "connect failed" );
+    }
+
+    ~CLIENT() { close( fd ); }
+
+    // send a request and return the status code and body of the response
+    int request( const std::string &method, const std::string &path, const std::string &type, const std::string &body, std::string &response )
+    {
+        std::string message = method + " " + path + " HTTP/1.1\r\nHost: localhost\r\nContent-Type: " + type
+                             + "\r\nContent-Length: " + std::to_string( body.size() ) + "\r\n\r\n" + body;
+        if( send( fd, message.data(), message.size(), MSG_NOSIGNAL ) != ssize_t( message.size() ) )
+            throw std::runtime_error( "send failed" );
+
+        std::size_t header_end;
+        while( ( header_end = buffer.find( "\r\n\r\n" ) ) == std::string::npos )
+            receive();
+
+        std::size_t length_at = buffer.find( "Content-Length: " );
+        std::size_t length = std::strtoull( buffer.c_str() + length_at + 16, nullptr, 10 );
+        while( buffer.size() < header_end + 4 + length )
+            receive();
+
+        int status = std::atoi( buffer.c_str() + 9 );
+        response = buffer.substr( header_end + 4, length );
+        buffer.erase( 0, header_end + 4 + length );
+        return status;
+    }
+
+    void receive()
+    {
+        char chunk[65536];
+        ssize_t got = recv( fd, chunk, sizeof( chunk ), 0 );
+        if( got <= 0 )
+            throw std::runtime_error( "connection closed" );
+        buffer.append( chunk, got );
+    }
+};
+
+// values of a JSON response in order (null as NaN)
+static std::vector<double> json_values( const std::string &json )
+{
+    std::vector<double> values;
+    for( std::size_t p = json.find( "\":" ); p != std::string::npos; p = json.find( "\":", p + 1 ) )
+    {
+        const char *s = json.c_str() + p + 2;
+        double x = NAN;
+        if( std::strncmp( s, "null", 4 ) && std::from_chars( s, json.c_str() + json.size(), x ).ec != std::errc() )
+            continue;
+        values.push_back( x );
+    }
+    return values;
+}
+
+static bool same( double a, double b )
+{
+    return a == b || ( std::isnan( a ) && std::isnan( b ) );
+}
+
+int main( int argc, char **argv )
+{
+    int clients = argc > 1 ? std::atoi( argv[1] ) : 8;
+    int requests = argc > 2 ? std::atoi( argv[2] ) : 50;
+    const std::size_t trees_per_request = 16;
+
+    SERVICE_OPTIONS options;
+    options.port = 0;
+    options.wait_us = 2000;
+    SERVICE service( options );
+    unsigned short port = service.start();
+
+    BENCH_TREES t = bench_trees( clients * requests * trees_per_request );
+
+    // reference rows of 8 values
+    std::vector<double> reference;
+    for( std::size_t i = 0; i < t.dbh.size(); i++ )
+    {
+        double vib = compute_volib( t.fia_spp[i], t.division[i], t.dbh[i], t.height[i] );
+        BIOMASS_COMP bc = biomass_components( t.fia_spp[i], t.division[i], vib, t.dbh[i], t.height[i] );
+        for( double x : { vib, compute_volob( t.fia_spp[i], t.division[i], t.dbh[i], t.height[i] ), bc.wood, bc.bark, bc.branch,
+                          bc.foliage, bc.total, bc.above_ground_biomass } )
+            reference.push_back( x );
+    }
+
+    std::vector<int> mismatches( clients, 0 );
+    std::vector<std::string> failures( clients );
+    std::vector<std::thread> threads;
+
+    for( int c = 0; c < clients; c++ )
+        threads.emplace_back( [&, c] {
+            try {
+                CLIENT client( port );
+                for( int r = 0; r < requests; r++ )
+                {
+                    std::size_t first = ( std::size_t( c ) * requests + r ) * trees_per_request;
+                    std::string response;
+                    std::vector<double> values;
+
+                    if( r % 2 == 0 )
+                    {
+                        std::string body = "{\"trees\":[";
+                        for( std::size_t i = first; i < first + trees_per_request; i++ )
+                            body += ( i > first ? "," : "" ) + std::string( "{\"fia_spp\":" ) + std::to_string( t.fia_spp[i] ) + ",\"division\":\""
+                                  + t.division[i] + "\",\"dbh\":" + std::to_string( t.dbh[i] ) + ",\"height\":" + std::to_string( t.height[i] ) + "}";
+                        body += "]}";
+
+                        if( client.request( "POST", "/evaluate", "application/json", body, response ) != 200 )
+                            throw std::runtime_error( "JSON request failed: " + response );
+                        values = json_values( response );
+                    }
+                    else
+                    {
+                        std::uint32_t n = trees_per_request;
+                        std::string body( 12 + n * SERVICE_RECORD_SIZE, '\0' );
+                        std::memcpy( body.data(), SERVICE_MAGIC, 4 );
+                        std::memcpy( body.data() + 4, &SERVICE_VERSION, 4 );
+                        std::memcpy( body.data() + 8, &n, 4 );
+                        for( std::uint32_t i = 0; i < n; i++ )
+                        {
+                            char *record = body.data() + 12 + i * SERVICE_RECORD_SIZE;
+                            std::int32_t spp = t.fia_spp[first + i];
+                            std::memcpy( record, &spp, 4 );
+                            std::memcpy( record + 4, t.division[first + i].data(), std::min<std::size_t>( 4, t.division[first + i].size() ) );
+                            std::memcpy( record + 8, &t.dbh[first + i], 8 );
+                            std::memcpy( record + 16, &t.height[first + i], 8 );
+                        }
+
+                        if( client.request( "POST", "/evaluate", "application/octet-stream", body, response ) != 200 )
+                            throw std::runtime_error( "binary request failed" );
+                        values.resize( n * SERVICE_RESULTS );
+                        std::memcpy( values.data(), response.data() + 12, values.size() * sizeof( double ) );
+                    }
+
+                    // JSON requests carry dbh and height through std::to_string (6 decimals), so compare with the
+                    // reference of the values sent
+                    for( std::size_t i = 0; i < trees_per_request; i++ )
+                        for( int k = 0; k < SERVICE_RESULTS; k++ )
+                        {
+                            double expected = reference[( first + i ) * SERVICE_RESULTS + k];
+                            if( r % 2 == 0 )
+                            {
+                                std::size_t j = first + i;
+                                double d = std::strtod( std::to_string( t.dbh[j] ).c_str(), nullptr );
+                                double h = std::strtod( std::to_string( t.height[j] ).c_str(), nullptr );
+                                double vib = compute_volib( t.fia_spp[j], t.division[j], d, h );
+                                BIOMASS_COMP bc = biomass_components( t.fia_spp[j], t.division[j], vib, d, h );
+                                double row[] = { vib, compute_volob( t.fia_spp[j], t.division[j], d, h ), bc.wood, bc.bark, bc.branch,
+                                                 bc.foliage, bc.total, bc.above_ground_biomass };
+                                expected = row[k];
+                            }
+                            if( values.size() != trees_per_request * SERVICE_RESULTS || !same( values[i * SERVICE_RESULTS + k], expected ) )
+                                mismatches[c]++;
+                        }
+                }
+            } catch( const std::exception &e ) {
+                failures[c] = e.what();
+            }
+        } );
+    for( auto &th : threads )
+        th.join();
+
+    bool ok = true;
+    int total_mismatches = 0;
+    for( int c = 0; c < clients; c++ )
+    {
+        total_mismatches += mismatches[c];
+        if( !failures[c].empty() )
+        {
+            std::cout << "client " << c << ": " << failures[c] << "\n";
+            ok = false;
+        }
+    }
+
+    // errors and metrics
+    CLIENT client( port );
+    std::string response;
+    int bad_json = client.request( "POST", "/evaluate", "application/json", "{\"trees\":[{\"dbh\":}]}", response );
+    // numbers out of range or not integers where integers are required, and text after the request
+    const char *bad_requests[] = { "{\"trees\":[{\"fia_spp\":1e300,\"dbh\":10,\"height\":60}]}",
+                                   "{\"trees\":[{\"fia_spp\":202.5,\"dbh\":10,\"height\":60}]}",
+                                   "{\"trees\":[{\"fia_spp\":202,\"division\":-1e200,\"dbh\":10,\"height\":60}]}",
+                                   "{\"trees\":[{\"fia_spp\":202,\"dbh\":10,\"height\":60}]} x" };
+    int rejected = 0;
+    for( const char *body : bad_requests )
+        rejected += client.request( "POST", "/evaluate", "application/json", body, response ) == 400;
+    int not_found = client.request( "GET", "/nowhere", "text/plain", "", response );
+    int health = client.request( "GET", "/health", "text/plain", "", response );
+    client.request( "GET", "/metrics", "text/plain", "", response );
+
+    SERVICE_METRICS m = service.metrics();
+    service.stop();
+
+    // stop under load: clients send until their connections are closed
+    SERVICE loaded( options );
+    unsigned short loaded_port = loaded.start();
+    std::atomic<std::uint64_t> sent{ 0 };
+    std::vector<std::thread> senders;
+    for( int c = 0; c < 4; c++ )
+        senders.emplace_back( [&] {
+            try {
+                CLIENT client( loaded_port );
+                std::string reply;
+                while( client.request( "POST", "/evaluate", "application/json", "{\"trees\":[{\"fia_spp\":202,\"dbh\":10,\"height\":60}]}", reply ) == 200 )
+                    sent++;
+            } catch( const std::exception & ) {
+            }
+        } );
+    while( sent < 100 )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+    std::future<void> stopped = std::async( std::launch::async, [&loaded] { loaded.stop(); } );
+    if( stopped.wait_for( std::chrono::seconds( 30 ) ) != std::future_status::ready )
+    {
+        std::cout << "stop under load did not return\nFAIL\n";
+        std::_Exit( 1 );
+    }
+    for( auto &th : senders )
+        th.join();
+
+    bool refused = false;
+    try {
+        SERVICE_REQUEST late;
+        late.fia_spp = { 202 };
+        late.division = { DIV_NONE };
+        late.dbh = { 10.0 };
+        late.height = { 60.0 };
+        loaded.evaluate( late );
+    } catch( const std::runtime_error & ) {
+        refused = true;
+    }
+
+    std::uint64_t evaluated = std::uint64_t( clients ) * requests;
+    std::cout << "requests " << m.requests << ", batches " << m.batches << ", mean batch " << m.mean_batch_trees << " trees, p50 "
+              << m.p50_us << " us, p99 " << m.p99_us << " us\nmetrics: " << response << "\n";
+
+    ok = ok && total_mismatches == 0 && bad_json == 400 && not_found == 404 && health == 200
+            && m.trees == evaluated * trees_per_request && m.errors == 5 && rejected == 4
+            && ( clients == 1 || m.batches < evaluated ) && response.find( "\"latency_p99_us\"" ) != std::string::npos && refused;
+
+    std::cout << "mismatches " << total_mismatches << ", bad JSON " << bad_json << ", invalid numbers and trailing text rejected " << rejected
+              << " of 4, not found " << not_found << ", stopped under load after " << sent.load() << " requests"
+              << ( refused ? "" : ", evaluated after stop" ) << "\n"
+              << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+// National Scale Volume and Biomass estimators (NSVB) sharded runner test
+//
+// usage: shard_test nsvb_run [trees]
+//
+// Writes a synthetic tree list as CSV and as a binary tree file and runs nsvb_run on it with one
+// shard read as a single block, with several workers per pipeline stage and small blocks, with
+// several shards in local worker processes (also writing TSV, and gzip when built in), and shard
+// by shard followed by a merge. Tree results must equal evaluate_batch() and be identical for every run; plot totals of one
+// shard in one block must equal rollup_plots() and agree within rounding for other runs. Binary files with
+// planted bytes other than 0 and 1 or without a species column must read as 0/1 or be rejected.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nsvb_compress.hpp"
+#include "nsvb_green.hpp"
+#include "nsvb_rollup.hpp"
+#include "nsvb_treefile.hpp"
+#include "bench_trees.hpp"
+
+static std::string read_text( const std::string &path )
+{
+    std::ifstream is( path, std::ios::binary );
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+// numbers of each line of a CSV file after the header (NA as NaN, other text skipped)
+static std::vector<std::vector<double>> read_numbers( const std::string &path )
+{
+    std::vector<std::vector<double>> rows;
+    std::ifstream is( path );
+    std::string line;
+    std::getline( is, line );
+    while( std::getline( is, line ) )
+    {
+        std::vector<double> row;
+        std::stringstream fields( line );
+        std::string field;
+        while( std::getline( fields, field, ',' ) )
+            row.push_back( field == "NA" ? NAN : field.empty() ? 0.0 : std::strtod( field.c_str(), nullptr ) );
+        rows.push_back( row );
+    }
+    return rows;
+}
+
+static bool same( double a, double b, double tolerance )
+{
+    if( std::isnan( a ) || std::isnan( b ) )
+        return std::isnan( a ) && std::isnan( b );
+    return std::abs( a - b ) <= tolerance * std::max( 1.0, std::abs( a ) );
+}
+
+static bool same_rows( const std::vector<std::vector<double>> &a, const std::vector<std::vector<double>> &b, double tolerance )
+{
+    if( a.size() != b.size() )
+        return false;
+    for( std::size_t i = 0; i < a.size(); i++ )
+    {
+        if( a[i].size() != b[i].size() )
+            return false;
+        for( std::size_t j = 0; j < a[i].size(); j++ )
+            if( !same( a[i][j], b[i][j], tolerance ) )
+                return false;
+    }
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    if( argc < 2 )
+    {
+        std::cerr << "usage: shard_test nsvb_run [trees]\n";
+        return 2;
+    }
+    std::string run = argv[1];
+    std::size_t n = argc > 2 ? std::strtoull( argv[2], nullptr, 10 ) : 60000;
+
+    char directory[] = "/tmp/nsvb_shard_XXXXXX";
+    if( !mkdtemp( directory ) )
+        return 1;
+    std::string dir = directory;
+
+    // tree list with expansion factors and planted loblolly pine, columns in another order
+    BENCH_TREES t = bench_trees( n );
+    std::mt19937 rng( 7 );
+    {
+        std::ofstream os( dir + "/trees.csv" );
+        os << "tree,plot,division,fia_spp,dbh,tht,tpa,planted,note\n";
+        for( std::size_t i = 0; i < n; i++ )
+            os << t.tree[i] << "," << t.plot[i] << ",\"" << t.division[i] << "\"," << t.fia_spp[i] << "," << t.dbh[i] << "," << t.height[i] << ","
+               << ( t.dbh[i] < 5.0 ? 74.965282 : 6.018046 ) << "," << ( t.fia_spp[i] == 131 && t.plot[i] % 3 == 0 ? "TRUE" : "FALSE" ) << ",x\n";
+    }
+
+    auto command = [&]( const std::string &arguments ) {
+        std::string c = "\"" + run + "\" " + arguments;
+        if( std::system( c.c_str() ) != 0 )
+            throw std::runtime_error( "failed: " + c );
+    };
+
+    bool ok = true;
+    try {
+        command( "-convert " + dir + "/trees.csv " + dir + "/trees.bin" );
+        command( "-shards 1 -block 67108864 " + dir + "/trees.csv " + dir + "/one" );
+        command( "-parsers 2 -evaluators 2 -formatters 2 -depth 2 -block 65536 " + dir + "/trees.csv " + dir + "/piped" );
+        command( "-shards 4 -jobs 4 " + dir + "/trees.csv " + dir + "/csv4" );
+        command( "-shards 2 -jobs 2 -format tsv " + dir + "/trees.csv " + dir + "/tsv2" );
+        if( compression_available( CP_GZIP ) )
+            command( "-shards 3 -jobs 3 -compress gzip " + dir + "/trees.csv " + dir + "/gzip3" );
+        command( "-shards 3 -jobs 2 -batch 5000 " + dir + "/trees.bin " + dir + "/bin3" );
+        for( int k = 0; k < 3; k++ )
+            command( "-shard " + std::to_string( k ) + " -shards 3 -batch 5000 " + dir + "/trees.bin " + dir + "/array3" );
+        command( "-merge -shards 3 " + dir + "/array3" );
+    } catch( const std::exception &e ) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    // reference from the parsed tree list
+    TREE_COLUMNS trees = TREE_FILE( dir + "/trees.csv" ).read_all();
+    TREE_BATCH batch = trees.batch();
+    std::vector<double> columns[8];
+    BATCH_RESULT result;
+    double **to[] = { &result.volib, &result.volob, &result.wood, &result.bark, &result.branch, &result.foliage, &result.total,
+                      &result.above_ground_biomass };
+    for( int c = 0; c < 8; c++ )
+    {
+        columns[c].resize( trees.size() );
+        *to[c] = columns[c].data();
+    }
+    evaluate_batch( batch, result );
+
+    std::vector<std::vector<double>> expected_trees;
+    for( std::size_t i = 0; i < trees.size(); i++ )
+    {
+        std::vector<double> row = { double( trees.plot[i] ), double( trees.tree[i] ), double( trees.fia_spp[i] ), 0.0 };
+        for( auto &c : columns )
+            row.push_back( c[i] );
+        row.push_back( green_tons( species_green_factors( trees.fia_spp[i] ), columns[1][i], columns[0][i] ) );
+        expected_trees.push_back( row );
+    }
+
+    std::vector<std::vector<double>> expected_plots;
+    for( const PLOT_TOTALS &p : rollup_plots( batch, trees.plot.data(), trees.tpa.data() ) )
+        expected_plots.push_back( { double( p.plot ), double( p.trees ), p.tpa, p.volib, p.volob, p.green_tons, p.biomass.wood, p.biomass.bark,
+                                    p.biomass.branch, p.biomass.foliage, p.biomass.total, p.biomass.above_ground_biomass } );
+
+    std::size_t planted = 0;
+    for( auto p : trees.planted )
+        planted += p;
+
+    // division text is skipped by read_numbers() (read as 0 unless it is a number)
+    auto trees_of = [&]( const std::string &name ) {
+        auto rows = read_numbers( dir + "/" + name + ".trees.csv" );
+        for( auto &row : rows )
+            if( row.size() > 3 )
+                row[3] = 0.0;
+        return rows;
+    };
+
+    std::string one = read_text( dir + "/one.trees.csv" ), tsv = read_text( dir + "/tsv2.trees.tsv" );
+    std::replace( tsv.begin(), tsv.end(), '\t', ',' );
+    bool gzip_ok = true;
+    if( compression_available( CP_GZIP ) )
+    {
+        COMPRESSED_READER reader( dir + "/gzip3.trees.csv.gz" );
+        std::string text( one.size() + 1, '\0' );
+        text.resize( reader.read( text.data(), text.size() ) );
+        gzip_ok = text == one;
+    }
+    // binary files: planted bytes other than 0 and 1 read as planted, a file without species is rejected
+    bool binary_ok = false;
+    {
+        std::string bin = read_text( dir + "/trees.bin" );
+        TREE_FILE_HEADER header;
+        std::memcpy( &header, bin.data(), sizeof( header ) );
+        for( std::uint64_t i = 0; i < header.rows; i++ )
+            if( bin[header.offset[TC_PLANTED] + i] )
+                bin[header.offset[TC_PLANTED] + i] = static_cast<char>( 2 + i % 250 );
+        std::ofstream( dir + "/planted.bin", std::ios::binary ) << bin;
+        binary_ok = TREE_FILE( dir + "/planted.bin" ).read_all().planted == trees.planted;
+
+        header.offset[TC_FIA_SPP] = 0;
+        std::memcpy( bin.data(), &header, sizeof( header ) );
+        std::ofstream( dir + "/nospecies.bin", std::ios::binary ) << bin;
+        try {
+            TREE_FILE missing( dir + "/nospecies.bin" );
+            binary_ok = false;
+        } catch( const std::runtime_error & ) {
+        }
+    }
+
+    bool trees_ok = trees.size() == n && planted > 0 && binary_ok && same_rows( trees_of( "one" ), expected_trees, 0.0 )
+                    && read_text( dir + "/csv4.trees.csv" ) == one && read_text( dir + "/bin3.trees.csv" ) == one
+                    && read_text( dir + "/array3.trees.csv" ) == one && read_text( dir + "/piped.trees.csv" ) == one && tsv == one && gzip_ok;
+    bool plots_ok = same_rows( read_numbers( dir + "/one.plots.csv" ), expected_plots, 0.0 )
+                    && same_rows( read_numbers( dir + "/csv4.plots.csv" ), expected_plots, 1e-12 )
+                    && same_rows( read_numbers( dir + "/bin3.plots.csv" ), expected_plots, 1e-12 )
+                    && same_rows( read_numbers( dir + "/piped.plots.csv" ), expected_plots, 1e-12 )
+                    && read_text( dir + "/array3.plots.csv" ) == read_text( dir + "/bin3.plots.csv" );
+    ok = trees_ok && plots_ok;
+
+    std::cout << "sharded runner (" << n << " trees, " << planted << " planted, " << expected_plots.size() << " plots; 1 shard, pipelined, 4 CSV shards, "
+              << "2 TSV shards, 3 gzip shards, 3 binary shards in 2 and in separate runs; malformed binary files): trees " << ( trees_ok ? "ok" : "differ" ) << ", plots "
+              << ( plots_ok ? "ok" : "differ" ) << ": " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    if( ok )
+        std::system( ( "rm -rf \"" + dir + "\"" ).c_str() );
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+// National Scale Volume and Biomass estimators (NSVB) startup benchmark
+//
+// usage: nsvb_startup [-runs N] [-label text] [-csv file]
+//
+// Starts itself N times and measures, per process, the time from posix_spawn() to the first
+// biomass_components() result in three stages (exec and loading to the first static constructor,
+// static initialization up to main(), main() to the first result), the heap bytes allocated by
+// operator new during static initialization and the first call, and the page faults taken.
+// Reports the minimum and median of each; -csv appends the medians to a file (with -label, e.g.
+// the release) so startup can be tracked across releases.
+//
+// The first stage boundary is a constructor of priority 101, which runs before the static
+// constructors of the library when it is linked statically (the default nsvb_link); with the
+// shared library, its initialization is counted in the first stage instead.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "nsvb.hpp"
+
+extern char **environ;
+
+// heap allocated by operator new
+static std::atomic<std::size_t> heap_bytes{ 0 };
+static std::atomic<std::size_t> heap_calls{ 0 };
+
+static void *counted_new( std::size_t size, std::size_t alignment = 0 )
+{
+    heap_bytes.fetch_add( size, std::memory_order_relaxed );
+    heap_calls.fetch_add( 1, std::memory_order_relaxed );
+
+    void *p = alignment ? std::aligned_alloc( alignment, ( size + alignment - 1 ) / alignment * alignment ) : std::malloc( size ? size : 1 );
+    if( !p )
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new( std::size_t size ) { return counted_new( size ); }
+void *operator new[]( std::size_t size ) { return counted_new( size ); }
+void *operator new( std::size_t size, std::align_val_t a ) { return counted_new( size, std::size_t( a ) ); }
+void *operator new[]( std::size_t size, std::align_val_t a ) { return counted_new( size, std::size_t( a ) ); }
+void operator delete( void *p ) noexcept { std::free( p ); }
+void operator delete[]( void *p ) noexcept { std::free( p ); }
+void operator delete( void *p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::size_t ) noexcept { std::free( p ); }
+void operator delete( void *p, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete( void *p, std::size_t, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::size_t, std::align_val_t ) noexcept { std::free( p ); }
+
+// process state at a point of startup
+struct MARK {
+    long long ns = 0;
+    long minor_faults = 0;
+    long major_faults = 0;
+    std::size_t heap_bytes = 0;
+    std::size_t heap_calls = 0;
+};
+
+static long long monotonic_ns()
+{
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static MARK mark()
+{
+    MARK m;
+    m.ns = monotonic_ns();
+
+    rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+    m.minor_faults = ru.ru_minflt;
+    m.major_faults = ru.ru_majflt;
+    m.heap_bytes = heap_bytes.load( std::memory_order_relaxed );
+    m.heap_calls = heap_calls.load( std::memory_order_relaxed );
+
+    return m;
+}
+
+// first static constructor
+static MARK init_mark;
+
+#if defined( __GNUC__ )
+__attribute__(( constructor( 101 ) )) static void first_constructor()
+{
+    init_mark = mark();
+}
+#endif
+
+// measurements of one process
+struct STARTUP {
+    double exec_ms;             // spawn to the first static constructor
+    double init_ms;             // static initialization
+    double first_ms;            // main() to the first biomass_components() result
+    double total_ms;            // spawn to the first result
+    double init_faults;         // page faults (minor + major) during static initialization
+    double faults;              // page faults up to the first result
+    double init_heap_bytes;     // operator new bytes during static initialization
+    double init_heap_calls;     // operator new calls during static initialization
+    double first_heap_bytes;    // operator new bytes of the first call
+    double max_rss_kb;          // maximum resident set
+};
+
+constexpr int STARTUP_FIELDS = sizeof( STARTUP ) / sizeof( double );
+
+static const char *field_names[STARTUP_FIELDS] = {
+    "exec_ms", "init_ms", "first_ms", "total_ms", "init_faults", "faults",
+    "init_heap_bytes", "init_heap_calls", "first_heap_bytes", "max_rss_kb"
+};
+
+// child: evaluate one tree and write the marks to fd
+static int child( int fd )
+{
+    MARK main_mark = mark();
+    if( init_mark.ns == 0 )
+        init_mark = main_mark;
+
+    BIOMASS_COMP bm = biomass_components( 202, "M240", 12.22, 10.0, 60.0 );
+    MARK first_mark = mark();
+
+    rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+
+    char buffer[512];
+    int n = std::snprintf( buffer, sizeof( buffer ), "%lld %lld %lld %ld %ld %ld %ld %zu %zu %zu %zu %ld %.6f\n",
+                           init_mark.ns, main_mark.ns, first_mark.ns,
+                           init_mark.minor_faults + init_mark.major_faults, main_mark.minor_faults + main_mark.major_faults,
+                           first_mark.minor_faults + first_mark.major_faults, first_mark.major_faults,
+                           init_mark.heap_bytes, main_mark.heap_bytes, main_mark.heap_calls - init_mark.heap_calls,
+                           first_mark.heap_bytes, ru.ru_maxrss, bm.above_ground_biomass );
+
+    return write( fd, buffer, n ) == n ? 0 : 1;
+}
+
+// parent: start one child and collect its measurements
+static STARTUP run_child( const char *self )
+{
+    int fds[2];
+    if( pipe( fds ) )
+        throw std::runtime_error( "pipe failed" );
+
+    std::string fd = std::to_string( fds[1] );
+    char *args[] = { const_cast<char *>( self ), const_cast<char *>( "-child" ), fd.data(), nullptr };
+
+    long long spawn_ns = monotonic_ns();
+    pid_t pid;
+    if( posix_spawn( &pid, self, nullptr, nullptr, args, environ ) )
+        throw std::runtime_error( std::string( "cannot start " ) + self );
+    close( fds[1] );
+
+    std::string text;
+    char buffer[512];
+    for( ssize_t n; ( n = read( fds[0], buffer, sizeof( buffer ) ) ) > 0; )
+        text.append( buffer, n );
+    close( fds[0] );
+
+    int status;
+    waitpid( pid, &status, 0 );
+
+    long long init_ns, main_ns, first_ns;
+    long init_faults, main_faults, first_faults, major_faults, max_rss;
+    std::size_t init_bytes, main_bytes, init_calls, first_bytes;
+    double agb;
+    if( !WIFEXITED( status ) || WEXITSTATUS( status ) ||
+        std::sscanf( text.c_str(), "%lld %lld %lld %ld %ld %ld %ld %zu %zu %zu %zu %ld %lf",
+                     &init_ns, &main_ns, &first_ns, &init_faults, &main_faults, &first_faults, &major_faults,
+                     &init_bytes, &main_bytes, &init_calls, &first_bytes, &max_rss, &agb ) != 13 )
+        throw std::runtime_error( "child failed" );
+
+    STARTUP s;
+    s.exec_ms = ( init_ns - spawn_ns ) * 1e-6;
+    s.init_ms = ( main_ns - init_ns ) * 1e-6;
+    s.first_ms = ( first_ns - main_ns ) * 1e-6;
+    s.total_ms = ( first_ns - spawn_ns ) * 1e-6;
+    s.init_faults = main_faults - init_faults;
+    s.faults = first_faults;
+    s.init_heap_bytes = double( main_bytes - init_bytes );
+    s.init_heap_calls = double( init_calls );
+    s.first_heap_bytes = double( first_bytes - main_bytes );
+    s.max_rss_kb = max_rss;
+
+    return s;
+}
+
+int main( int argc, char **argv )
+{
+    if( argc == 3 && std::strcmp( argv[1], "-child" ) == 0 )
+        return child( std::atoi( argv[2] ) );
+
+    int runs = 50;
+    std::string label = "", csv = "";
+    for( int i = 1; i < argc; i++ )
+    {
+        if( std::strcmp( argv[i], "-runs" ) == 0 && i + 1 < argc )
+            runs = std::max( 1, std::atoi( argv[++i] ) );
+        else if( std::strcmp( argv[i], "-label" ) == 0 && i + 1 < argc )
+            label = argv[++i];
+        else if( std::strcmp( argv[i], "-csv" ) == 0 && i + 1 < argc )
+            csv = argv[++i];
+        else
+        {
+            std::cerr << "usage: nsvb_startup [-runs N] [-label text] [-csv file]\n";
+            return 2;
+        }
+    }
+
+    // the executable itself, not argv[0] which may have been found on PATH
+    char self[4096];
+    ssize_t len = readlink( "/proc/self/exe", self, sizeof( self ) - 1 );
+    if( len <= 0 )
+        len = std::snprintf( self, sizeof( self ), "%s", argv[0] );
+    self[len] = '\0';
+
+    std::vector<std::vector<double>> values( STARTUP_FIELDS );
+    try {
+        run_child( self );      // warm the page cache
+        for( int r = 0; r < runs; r++ )
+        {
+            STARTUP s = run_child( self );
+            const double *v = reinterpret_cast<const double *>( &s );
+            for( int f = 0; f < STARTUP_FIELDS; f++ )
+                values[f].push_back( v[f] );
+        }
+    } catch( const std::exception &e ) {
+        std::cerr << "nsvb_startup: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<double> median( STARTUP_FIELDS );
+    std::cout << "runs = " << runs << "\n"
+              << std::left << std::setw( 20 ) << "" << std::right << std::setw( 14 ) << "min" << std::setw( 14 ) << "median" << "\n";
+    for( int f = 0; f < STARTUP_FIELDS; f++ )
+    {
+        std::sort( values[f].begin(), values[f].end() );
+        median[f] = values[f][values[f].size() / 2];
+        int digits = f < 4 ? 3 : 0;
+        std::cout << std::left << std::setw( 20 ) << field_names[f] << std::right << std::fixed << std::setprecision( digits )
+                  << std::setw( 14 ) << values[f].front() << std::setw( 14 ) << median[f] << "\n";
+    }
+
+    if( !csv.empty() )
+    {
+        bool header = !std::ifstream( csv ).good();
+        std::ofstream os( csv, std::ios::app );
+        if( header )
+        {
+            os << "label,runs";
+            for( auto name : field_names )
+                os << "," << name;
+            os << "\n";
+        }
+        os << label << "," << runs << std::setprecision( 4 ) << std::defaultfloat;
+        for( double m : median )
+            os << "," << m;
+        os << "\n";
+        if( !os )
+        {
+            std::cerr << "nsvb_startup: cannot write " << csv << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
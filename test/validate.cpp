@@ -0,0 +1,1351 @@
+// National Scale Volume and Biomass estimators (NSVB) differential validation
+//
+// usage: validate [-threads N] [-fuzz N] [-seed S] [-csv file]
+//
+// Evaluates every species in refs x every division over a dbh/height grid, plus randomized
+// inputs, with the scalar reference (compute_volib(), compute_volob(), biomass_components())
+// and with each optimized mode. Reports the maximum absolute and relative error per
+// species and form, and fails when a mode exceeds its tolerance. The analytic derivatives
+// of evaluate_batch_gradient() are checked against central differences of the reference, and
+// the inverse solvers by evaluating the reference at each solution. A TREE_LIST is projected
+// through random growth steps and checked against evaluate_batch() and re-summed totals, and a
+// PLAN_CACHE is filled concurrently and checked against resolve_plan(). species_order() must give
+// one run per division and species. Plot rollups are checked against sums of the reference,
+// green tons kernels against compute_green_tons(), logs of
+// merchandized stems against the batch green tons, WORKSPACE batches for heap allocations
+// (operator new is counted), the embedded coefficient blob against nsvb_coef.hpp, and NUMA
+// partitions over a simulated multi-node topology. Philox4x32-10 is checked against known answers
+// and Monte Carlo plot totals against the deterministic totals and across thread counts.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include "nsvb_arrow.h"
+#include "nsvb_batch.hpp"
+#include "nsvb_coef.hpp"
+#include "nsvb_green.hpp"
+#include "nsvb_inverse.hpp"
+#include "nsvb_numa.hpp"
+#include "nsvb_plan_cache.hpp"
+#include "nsvb_plan_table.hpp"
+#include "nsvb_rollup.hpp"
+#include "nsvb_tree_list.hpp"
+#include "nsvb_uncertainty.hpp"
+#include "nsvb_workspace.hpp"
+
+// operator new calls of the process, to check that workspaces stop allocating
+static std::atomic<std::size_t> heap_calls{ 0 };
+
+static void *counted_new( std::size_t size, std::size_t alignment = 0 )
+{
+    heap_calls.fetch_add( 1, std::memory_order_relaxed );
+
+    void *p = alignment ? std::aligned_alloc( alignment, ( size + alignment - 1 ) / alignment * alignment ) : std::malloc( size ? size : 1 );
+    if( !p )
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new( std::size_t size ) { return counted_new( size ); }
+void *operator new[]( std::size_t size ) { return counted_new( size ); }
+void *operator new( std::size_t size, std::align_val_t a ) { return counted_new( size, std::size_t( a ) ); }
+void *operator new[]( std::size_t size, std::align_val_t a ) { return counted_new( size, std::size_t( a ) ); }
+void operator delete( void *p ) noexcept { std::free( p ); }
+void operator delete[]( void *p ) noexcept { std::free( p ); }
+void operator delete( void *p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::size_t ) noexcept { std::free( p ); }
+void operator delete( void *p, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete( void *p, std::size_t, std::align_val_t ) noexcept { std::free( p ); }
+void operator delete[]( void *p, std::size_t, std::align_val_t ) noexcept { std::free( p ); }
+
+// forms compared
+enum FORM { F_VOLIB = 0, F_VOLOB, F_WOOD, F_BARK, F_BRANCH, F_FOLIAGE, F_TOTAL, F_AGB, F_COUNT };
+static const char *form_names[F_COUNT] = { "volib", "volob", "wood", "bark", "branch", "foliage", "total", "agb" };
+
+// result columns of one evaluation
+struct COLUMNS {
+    std::vector<double> v[F_COUNT];
+
+    explicit COLUMNS( std::size_t n ) { for( auto &c : v ) c.assign( n, 0.0 ); }
+
+    BATCH_RESULT result()
+    {
+        BATCH_RESULT r;
+        r.volib = v[F_VOLIB].data(); r.volob = v[F_VOLOB].data();
+        r.wood = v[F_WOOD].data(); r.bark = v[F_BARK].data(); r.branch = v[F_BRANCH].data();
+        r.foliage = v[F_FOLIAGE].data(); r.total = v[F_TOTAL].data(); r.above_ground_biomass = v[F_AGB].data();
+        return r;
+    }
+};
+
+// an optimized evaluation path compared with the reference
+struct MODE {
+    const char *name;
+    double tolerance;       // maximum relative error allowed (0.0: results must be identical)
+    std::function<void( const TREE_BATCH &, const BATCH_RESULT & )> evaluate;
+};
+
+// largest errors of a form
+struct ERRORS {
+    double abs = 0.0;
+    double rel = 0.0;
+
+    void add( double reference, double x )
+    {
+        if( std::isnan( reference ) && std::isnan( x ) )
+            return;
+
+        double a = std::fabs( x - reference );
+        if( std::isnan( a ) )
+            a = INFINITY;
+        double r = a == 0.0 ? 0.0 : reference != 0.0 ? a / std::fabs( reference ) : INFINITY;
+
+        abs = std::max( abs, a );
+        rel = std::max( rel, r );
+    }
+};
+
+static void release_borrowed_array( ArrowArray *a ) { a->release = nullptr; }
+static void release_borrowed_schema( ArrowSchema *s ) { s->release = nullptr; }
+
+// evaluate a batch through nsvb_arrow_evaluate() with the divisions dictionary encoded
+static void evaluate_arrow( const TREE_BATCH &t, const BATCH_RESULT &r, unsigned threads )
+{
+    std::vector<std::string> entries;
+    std::map<std::string,int32_t> lookup;
+    std::vector<int32_t> index( t.n );
+    for( std::size_t i = 0; i < t.n; i++ )
+    {
+        auto [it, added] = lookup.emplace( t.division[i], int32_t( entries.size() ) );
+        if( added )
+            entries.push_back( t.division[i] );
+        index[i] = it->second;
+    }
+
+    std::vector<int32_t> offsets{ 0 };
+    std::string data;
+    for( auto &e : entries )
+    {
+        data += e;
+        offsets.push_back( int32_t( data.size() ) );
+    }
+
+    ArrowSchema dictionary_schema{ "u", "", nullptr, 0, 0, nullptr, nullptr, release_borrowed_schema, nullptr };
+    ArrowSchema column_schemas[4] = {
+        { "i", "fia_spp", nullptr, 0, 0, nullptr, nullptr, release_borrowed_schema, nullptr },
+        { "i", "division", nullptr, 0, 0, nullptr, &dictionary_schema, release_borrowed_schema, nullptr },
+        { "g", "dbh", nullptr, 0, 0, nullptr, nullptr, release_borrowed_schema, nullptr },
+        { "g", "height", nullptr, 0, 0, nullptr, nullptr, release_borrowed_schema, nullptr } };
+    ArrowSchema *schema_children[4] = { &column_schemas[0], &column_schemas[1], &column_schemas[2], &column_schemas[3] };
+    ArrowSchema schema{ "+s", "", nullptr, 0, 4, schema_children, nullptr, release_borrowed_schema, nullptr };
+
+    int64_t n = t.n;
+    const void *dictionary_buffers[3] = { nullptr, offsets.data(), data.data() };
+    const void *column_buffers[4][2] = { { nullptr, t.fia_spp }, { nullptr, index.data() }, { nullptr, t.dbh }, { nullptr, t.height } };
+    ArrowArray dictionary{ int64_t( entries.size() ), 0, 0, 3, 0, dictionary_buffers, nullptr, nullptr, release_borrowed_array, nullptr };
+    ArrowArray columns[4];
+    ArrowArray *array_children[4];
+    for( int c = 0; c < 4; c++ )
+    {
+        columns[c] = ArrowArray{ n, 0, 0, 2, 0, column_buffers[c], nullptr, c == 1 ? &dictionary : nullptr, release_borrowed_array, nullptr };
+        array_children[c] = &columns[c];
+    }
+    const void *struct_buffers[1] = { nullptr };
+    ArrowArray array{ n, 0, 0, 1, 4, struct_buffers, array_children, nullptr, release_borrowed_array, nullptr };
+
+    ArrowArray out;
+    ArrowSchema out_schema;
+    // a failed call leaves a message, cleared by the next call
+    if( nsvb_arrow_evaluate( nullptr, &schema, &out, &out_schema, threads ) != EINVAL || !*nsvb_arrow_last_error() )
+        throw std::runtime_error( "nsvb_arrow_evaluate: missing input accepted" );
+    index[n - 1] = int32_t( entries.size() );
+    if( nsvb_arrow_evaluate( &array, &schema, &out, &out_schema, threads ) != EINVAL )
+        throw std::runtime_error( "nsvb_arrow_evaluate: division dictionary index out of range accepted" );
+    index[n - 1] = lookup[t.division[n - 1]];
+    if( nsvb_arrow_evaluate( &array, &schema, &out, &out_schema, threads ) != 0 )
+        throw std::runtime_error( nsvb_arrow_last_error() );
+    if( *nsvb_arrow_last_error() )
+        throw std::runtime_error( "nsvb_arrow_evaluate: stale error message after a success" );
+
+    double *columns_out[] = { r.volib, r.volob, r.wood, r.bark, r.branch, r.foliage, r.total, r.above_ground_biomass };
+    for( int c = 0; c < out.n_children; c++ )
+    {
+        const double *v = static_cast<const double *>( out.children[c]->buffers[1] );
+        std::copy( v, v + n, columns_out[c] );
+    }
+
+    out.release( &out );
+    out_schema.release( &out_schema );
+}
+
+// reference values of trees with dbh or height scaled by 1 + step
+static COLUMNS stepped_reference( const TREE_BATCH &t, double dbh_step, double height_step, unsigned threads )
+{
+    COLUMNS c( t.n );
+    parallel_for( t.n, threads, [&]( std::size_t begin, std::size_t end ) {
+        for( std::size_t i = begin; i < end; i++ )
+        {
+            double d = t.dbh[i] * ( 1.0 + dbh_step ), h = t.height[i] * ( 1.0 + height_step );
+            double vib = compute_volib( t.fia_spp[i], t.division[i], d, h );
+            BIOMASS_COMP bc = biomass_components( t.fia_spp[i], t.division[i], vib, d, h );
+
+            c.v[F_VOLIB][i] = vib;
+            c.v[F_VOLOB][i] = compute_volob( t.fia_spp[i], t.division[i], d, h );
+            c.v[F_WOOD][i] = bc.wood;
+            c.v[F_BARK][i] = bc.bark;
+            c.v[F_BRANCH][i] = bc.branch;
+            c.v[F_FOLIAGE][i] = bc.foliage;
+            c.v[F_TOTAL][i] = bc.total;
+            c.v[F_AGB][i] = bc.above_ground_biomass;
+        }
+    }, 4096 );
+    return c;
+}
+
+// compare the analytic derivatives with central differences; trees within the step of the
+// form 4 breakpoints (dbh 9 and 11, where the dbh derivative is discontinuous) are skipped
+static bool check_derivatives( const TREE_BATCH &t, const COLUMNS &reference, unsigned threads )
+{
+    const double step = 1e-6;
+    const double tolerance = 1e-4;
+
+    COLUMNS d_dbh( t.n ), d_height( t.n );
+    BATCH_OPTIONS options;
+    options.threads = threads;
+    evaluate_batch_gradient( t, BATCH_RESULT(), d_dbh.result(), d_height.result(), options );
+
+    bool ok = true;
+    for( int variable = 0; variable < 2; variable++ )
+    {
+        const COLUMNS &analytic = variable == 0 ? d_dbh : d_height;
+        COLUMNS up = stepped_reference( t, variable == 0 ? step : 0.0, variable == 0 ? 0.0 : step, threads );
+        COLUMNS down = stepped_reference( t, variable == 0 ? -step : 0.0, variable == 0 ? 0.0 : -step, threads );
+
+        std::array<ERRORS,F_COUNT> errors;
+        for( std::size_t i = 0; i < t.n; i++ )
+        {
+            double x = variable == 0 ? t.dbh[i] : t.height[i];
+            if( variable == 0 && ( std::fabs( x - 9.0 ) <= 2.0 * step * x || std::fabs( x - 11.0 ) <= 2.0 * step * x ) )
+                continue;
+
+            for( int f = 0; f < F_COUNT; f++ )
+            {
+                // relative to the scale of the value so derivatives near zero are not amplified
+                double numeric = ( up.v[f][i] - down.v[f][i] ) / ( 2.0 * step * x );
+                double scale = std::max( std::fabs( numeric ), std::fabs( reference.v[f][i] ) / x );
+                if( std::isfinite( numeric ) && scale > 0.0 )
+                    errors[f].add( 1.0, 1.0 + ( analytic.v[f][i] - numeric ) / scale );
+            }
+        }
+
+        bool pass = true;
+        for( auto &e : errors )
+            pass = pass && e.rel <= tolerance;
+        ok = ok && pass;
+
+        std::cout << "\nderivative d/d " << ( variable == 0 ? "dbh" : "height" ) << " (tolerance " << tolerance << "): " << ( pass ? "PASS" : "FAIL" ) << "\n";
+        std::cout << "\tform      max rel error\n";
+        for( int f = 0; f < F_COUNT; f++ )
+            std::cout << "\t" << std::left << std::setw( 10 ) << form_names[f] << std::right << std::scientific << std::setprecision( 3 )
+                      << std::setw( 13 ) << errors[f].rel << std::defaultfloat << "\n";
+    }
+
+    return ok;
+}
+
+// solve for the height and dbh reproducing the reference volumes and biomass and compare the
+// reference at each solution with the target (trees with a zero or undefined target are skipped)
+static bool check_inverse( const TREE_BATCH &t, const COLUMNS &reference, unsigned threads )
+{
+    const double tolerance = 1e-9;
+    const struct { INVERSE_TARGET target; FORM form; const char *name; } targets[] = {
+        { INVERSE_VOLIB, F_VOLIB, "volib" }, { INVERSE_VOLOB, F_VOLOB, "volob" },
+        { INVERSE_TOTAL, F_TOTAL, "total" }, { INVERSE_AGB, F_AGB, "agb" } };
+
+    INVERSE_OPTIONS options;
+    options.threads = threads;
+
+    bool ok = true;
+    std::cout << "\ninverse (tolerance " << tolerance << ")\n\tsolve     target    max rel error   unsolved\n";
+    for( int variable = 0; variable < 2; variable++ )
+        for( auto &target : targets )
+        {
+            const std::vector<double> &value = reference.v[target.form];
+            std::vector<double> x( t.n );
+            if( variable == 0 )
+                solve_height( t, target.target, value.data(), x.data(), options );
+            else
+                solve_dbh( t, target.target, value.data(), x.data(), options );
+
+            TREE_BATCH solved = t;
+            ( variable == 0 ? solved.height : solved.dbh ) = x.data();
+            COLUMNS y( t.n );
+            BATCH_OPTIONS batch_options;
+            batch_options.threads = threads;
+            evaluate_batch( solved, y.result(), batch_options );
+
+            ERRORS e;
+            std::size_t unsolved = 0;
+            for( std::size_t i = 0; i < t.n; i++ )
+            {
+                if( !( value[i] > 0.0 ) || !std::isfinite( value[i] ) )
+                    continue;
+                if( std::isnan( x[i] ) )
+                    unsolved++;
+                else
+                    e.add( value[i], y.v[target.form][i] );
+            }
+
+            // every positive finite target of the reference is reachable, so all must be solved
+            bool pass = e.rel <= tolerance && unsolved == 0;
+            ok = ok && pass;
+            std::cout << "\t" << std::left << std::setw( 10 ) << ( variable == 0 ? "height" : "dbh" ) << std::setw( 10 ) << target.name
+                      << std::right << std::scientific << std::setprecision( 3 ) << std::setw( 13 ) << e.rel << std::defaultfloat
+                      << std::setw( 11 ) << unsolved << ( pass ? "   PASS" : "   FAIL" ) << "\n";
+        }
+
+    return ok;
+}
+
+// grow a TREE_LIST for a number of steps, updating a random part of the trees (some with
+// no increment, some briefly to an infinite height) and killing some, and compare with
+// evaluate_batch() of the current trees
+static bool check_tree_list( const TREE_BATCH &t, unsigned threads, unsigned seed )
+{
+    const double tolerance = 1e-9;
+    const int steps = 5;
+
+    TREE_LIST list;
+    for( std::size_t i = 0; i < t.n; i++ )
+        list.add( t.fia_spp[i], t.division[i], t.dbh[i], t.height[i], 1.0 + i % 7 );
+    list.evaluate( threads );
+
+    std::mt19937_64 rng( seed + 1 );
+    std::uniform_real_distribution<double> u( 0.0, 1.0 );
+    std::size_t recomputed = 0;
+    for( int step = 0; step < steps; step++ )
+    {
+        for( std::size_t i = 0; i < t.n; i++ )
+        {
+            double p = u( rng );
+            if( p < 0.5 )
+                list.update( i, list.dbh( i ) * ( 1.0 + 0.02 * u( rng ) ), list.height( i ) * ( 1.0 + 0.02 * u( rng ) ) );
+            else if( p < 0.6 )
+                list.update( i, list.dbh( i ), list.height( i ) );
+            else if( p < 0.61 )
+                list.set_tpa( i, 0.0 );
+        }
+        recomputed += list.evaluate( threads );
+
+        // infinite estimates for a step must not poison the totals
+        if( step == 1 )
+        {
+            std::vector<double> height;
+            for( std::size_t i = 0; i < t.n; i += 97 )
+            {
+                height.push_back( list.height( i ) );
+                list.update( i, list.dbh( i ), INFINITY );
+            }
+            list.evaluate( threads );
+            for( std::size_t i = 0; i < t.n; i += 97 )
+                list.update( i, list.dbh( i ), height[i / 97] );
+        }
+    }
+
+    std::vector<double> dbh( t.n ), height( t.n );
+    for( std::size_t i = 0; i < t.n; i++ )
+    {
+        dbh[i] = list.dbh( i );
+        height[i] = list.height( i );
+    }
+    TREE_BATCH grown = t;
+    grown.dbh = dbh.data();
+    grown.height = height.data();
+    COLUMNS x( t.n );
+    BATCH_OPTIONS options;
+    options.threads = threads;
+    evaluate_batch( grown, x.result(), options );
+
+    std::array<ERRORS,F_COUNT> trees;
+    for( std::size_t i = 0; i < t.n; i++ )
+    {
+        const TREE_ESTIMATES &e = list.estimates( i );
+        const double v[F_COUNT] = { e.volib, e.volob, e.biomass.wood, e.biomass.bark, e.biomass.branch,
+                                    e.biomass.foliage, e.biomass.total, e.biomass.above_ground_biomass };
+        for( int f = 0; f < F_COUNT; f++ )
+            trees[f].add( x.v[f][i], v[f] );
+    }
+
+    TREE_ESTIMATES incremental = list.totals();
+    list.resum();
+    const TREE_ESTIMATES &summed = list.totals();
+    std::array<ERRORS,F_COUNT> totals;
+    totals[F_VOLIB].add( summed.volib, incremental.volib );
+    totals[F_VOLOB].add( summed.volob, incremental.volob );
+    totals[F_WOOD].add( summed.biomass.wood, incremental.biomass.wood );
+    totals[F_BARK].add( summed.biomass.bark, incremental.biomass.bark );
+    totals[F_BRANCH].add( summed.biomass.branch, incremental.biomass.branch );
+    totals[F_FOLIAGE].add( summed.biomass.foliage, incremental.biomass.foliage );
+    totals[F_TOTAL].add( summed.biomass.total, incremental.biomass.total );
+    totals[F_AGB].add( summed.biomass.above_ground_biomass, incremental.biomass.above_ground_biomass );
+
+    bool ok = true;
+    for( int f = 0; f < F_COUNT; f++ )
+        ok = ok && trees[f].rel == 0.0 && totals[f].rel <= tolerance;
+
+    std::cout << "\ntree list (" << steps << " steps, " << recomputed << " trees recomputed; trees tolerance 0, totals tolerance "
+              << tolerance << "): " << ( ok ? "PASS" : "FAIL" ) << "\n\tform      trees rel error  totals rel error\n";
+    for( int f = 0; f < F_COUNT; f++ )
+        std::cout << "\t" << std::left << std::setw( 10 ) << form_names[f] << std::right << std::scientific << std::setprecision( 3 )
+                  << std::setw( 13 ) << trees[f].rel << std::setw( 18 ) << totals[f].rel << std::defaultfloat << "\n";
+
+    return ok;
+}
+
+static bool same_plan( const NSVB_PLAN &a, const NSVB_PLAN &b )
+{
+    return std::equal( a.coefs, a.coefs + COMP_COUNT, b.coefs ) && std::equal( a.eq_spp, a.eq_spp + COMP_COUNT, b.eq_spp )
+        && a.fia_spp == b.fia_spp && a.wood_sg == b.wood_sg;
+}
+
+// species_order() must give each division and resolved species (codes not in the reference table
+// resolve as 999) one contiguous run, including species codes of 1000 and more
+static bool check_species_order( unsigned seed )
+{
+    const REF_TABLE &refs = ref_table();
+    const char *divisions[] = { "", "M240", "230", "M330" };
+    std::mt19937_64 rng( seed + 3 );
+
+    std::vector<int> spp;
+    std::vector<std::string> div;
+    for( std::size_t k = 0; k < 20 * refs.size(); k++ )
+    {
+        int s = k % 10 ? refs.begin()[rng() % refs.size()].fia_spp : int( k % 3 ) * 12345 - 1;
+        spp.push_back( s );
+        div.push_back( divisions[rng() % 4] );
+    }
+
+    std::vector<double> ones( spp.size(), 1.0 );
+    TREE_BATCH t;
+    t.n = spp.size();
+    t.fia_spp = spp.data();
+    t.division = div.data();
+    t.dbh = t.height = ones.data();
+
+    std::vector<std::size_t> order = species_order( t );
+    std::set<std::pair<DIVISION,int>> closed;
+    std::size_t runs = 0, large = 0;
+    bool ok = order.size() == t.n;
+    for( std::size_t k = 0; ok && k < order.size(); k++ )
+    {
+        auto group = [&]( std::size_t i ) { return std::pair{ division_code( div[i] ), find_refs( spp[i] ) ? spp[i] : 999 }; };
+        auto g = group( order[k] );
+        if( k > 0 && g == group( order[k - 1] ) )
+            continue;
+        ok = closed.insert( g ).second;
+        runs++;
+        large += g.second >= 1000;
+    }
+
+    std::cout << "\nspecies order (" << t.n << " trees, " << runs << " runs, " << large << " of species codes 1000 and more): "
+              << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// concurrent lookups of a shared PLAN_CACHE must return the plans of resolve_plan(), and batches with
+// planted trees must use the planted coefficients for species having them and the reference otherwise
+static bool check_plan_cache( const TREE_BATCH &t, const COLUMNS &reference, unsigned threads )
+{
+    std::vector<int> species;
+    for( auto &r : refs )
+        species.push_back( r.first );
+    for( int spp : { -3, 0, 1000, 12345 } )
+        species.push_back( spp );
+
+    std::size_t expected = species.size() * DIV_COUNT * 2, missing = 0;
+    PLAN_CACHE cache( 2 * expected );
+    unsigned workers = std::max( 4u, threads );
+    std::vector<std::size_t> mismatches( workers, 0 );
+    std::vector<std::thread> pool;
+    for( unsigned w = 0; w < workers; w++ )
+        pool.emplace_back( [&, w] {
+            std::mt19937 rng( w );
+            std::vector<int> order = species;
+            std::shuffle( order.begin(), order.end(), rng );
+            for( int pass = 0; pass < 2; pass++ )
+                for( int spp : order )
+                    for( int d = 0; d < DIV_COUNT; d++ )
+                        for( bool planted : { false, true } )
+                            if( !same_plan( cache.get( spp, static_cast<DIVISION>( d ), planted ),
+                                            resolve_plan( spp, static_cast<DIVISION>( d ), planted ) ) )
+                                mismatches[w]++;
+        } );
+    for( auto &th : pool )
+        th.join();
+
+    for( int spp : species )
+        for( int d = 0; d < DIV_COUNT; d++ )
+            missing += !cache.find( spp, static_cast<DIVISION>( d ), false ) + !cache.find( spp, static_cast<DIVISION>( d ), true );
+    std::size_t mismatched = 0;
+    for( std::size_t m : mismatches )
+        mismatched += m;
+
+    // every tree planted
+    std::unique_ptr<bool[]> planted_flags = std::make_unique<bool[]>( t.n );
+    std::fill_n( planted_flags.get(), t.n, true );
+    TREE_BATCH planted = t;
+    planted.planted = planted_flags.get();
+    COLUMNS x( t.n );
+    BATCH_OPTIONS options;
+    options.threads = threads;
+    evaluate_batch( planted, x.result(), options );
+
+    ERRORS unplanted, volib;
+    std::size_t planted_trees = 0;
+    for( std::size_t i = 0; i < t.n; i++ )
+    {
+        auto p = planted_volib_coefs.find( t.fia_spp[i] );
+        if( p == planted_volib_coefs.end() )
+        {
+            for( int f = 0; f < F_COUNT; f++ )
+                unplanted.add( reference.v[f][i], x.v[f][i] );
+            continue;
+        }
+        volib.add( biomass( t.fia_spp[i], p->second, refs.at( t.fia_spp[i] ).wood_sg, t.dbh[i], t.height[i] ), x.v[F_VOLIB][i] );
+        planted_trees++;
+    }
+
+    bool ok = mismatched == 0 && missing == 0 && cache.size() == expected && unplanted.rel == 0.0 && volib.rel == 0.0 && planted_trees > 0;
+
+    std::cout << "\nplan cache (" << workers << " threads, " << cache.size() << " of " << expected << " plans cached, " << mismatched
+              << " mismatches, " << missing << " missing; " << planted_trees << " trees with planted coefficients, volib rel error "
+              << volib.rel << ", other trees rel error " << unplanted.rel << "): " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// NUMA scheduling over a simulated three node topology (each node given this process's CPUs):
+// slices must cover the batch in order, each item must be visited once by its slice's node, and
+// NUMA_BUFFER must come back zeroed. A copy of the plan table must hold its own coefficients.
+static bool check_numa( unsigned threads )
+{
+    std::vector<NUMA_NODE> nodes( 3, numa_nodes()[0] );
+    for( int k = 0; k < 3; k++ )
+        nodes[k].id = k;
+    nodes[2].cpus.resize( 1 );
+
+    bool ok = !numa_nodes().empty();
+    std::size_t bad = 0;
+    for( std::size_t count : { std::size_t( 0 ), std::size_t( 1 ), std::size_t( 1000 ), std::size_t( 100003 ) } )
+        for( unsigned th : { 1u, 2u, 3u, 7u, std::max( 4u, threads ) } )
+        {
+            std::vector<NUMA_SLICE> slices = numa_partition( nodes, count, th );
+            std::size_t end = 0;
+            unsigned workers = 0;
+            for( const auto &slice : slices )
+            {
+                bad += slice.begin != end || slice.end < slice.begin || ( slice.threads == 0 && slice.end != slice.begin );
+                end = slice.end;
+                workers += slice.threads;
+            }
+            bad += end != count || workers != th;
+
+            std::vector<std::atomic<int>> visits( count );
+            std::atomic<std::size_t> wrong_node{ 0 };
+            numa_parallel_for( count, th, [&]( unsigned node, std::size_t begin, std::size_t end ) {
+                for( std::size_t i = begin; i < end; i++ )
+                {
+                    visits[i]++;
+                    if( i < slices[node].begin || i >= slices[node].end )
+                        wrong_node++;
+                }
+            }, BATCH_CHUNK, nodes );
+            bad += wrong_node + std::count_if( visits.begin(), visits.end(), []( const std::atomic<int> &v ) { return v != 1; } );
+
+            NUMA_BUFFER buffer( count, sizeof( double ), th, nodes );
+            bad += std::count_if( buffer.as<double>(), buffer.as<double>() + count, []( double x ) { return x != 0.0; } );
+        }
+
+    ok = ok && bad == 0 && ( plan_table( 0 ) != nullptr ) == ( plan_table() != nullptr );
+
+    // a node's replica of the plan table holds its own coefficients, equal to the table's
+    const PLAN_TABLE &table = precompute_plans( threads );
+    PLAN_TABLE replica( table );
+    std::size_t shared = 0, different = 0;
+    for( auto &r : refs )
+        for( int d = 0; d < DIV_COUNT; d++ )
+        {
+            const NSVB_PLAN &a = table.get( r.first, static_cast<DIVISION>( d ) ), &b = replica.get( r.first, static_cast<DIVISION>( d ) );
+            different += !std::equal( a.eq_spp, a.eq_spp + COMP_COUNT, b.eq_spp ) || a.fia_spp != b.fia_spp || a.wood_sg != b.wood_sg;
+            for( int c = 0; c < COMP_COUNT; c++ )
+            {
+                const COEFS *x = a.coefs[c], *y = b.coefs[c];
+                shared += x && x == y;
+                different += !x != !y || ( x && ( x->equation != y->equation || x->planted != y->planted || x->a != y->a || x->b != y->b
+                                                  || x->c != y->c || x->b2 != y->b2 || x->a0 != y->a0 || x->b0 != y->b0 || x->b1 != y->b1
+                                                  || x->a1 != y->a1 || x->c1 != y->c1 ) );
+            }
+        }
+    ok = ok && shared == 0 && different == 0;
+
+    std::cout << "\nnuma (" << numa_nodes().size() << " nodes on this machine, simulated 3 node partitions " << bad
+              << " errors; plan table replica " << shared << " coefficients shared, " << different << " plans differ): " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// plot rollups of contiguous and scattered plots must match per-tree reference sums and not depend on
+// the number of threads
+static bool check_rollup( const TREE_BATCH &t, const COLUMNS &reference, unsigned threads )
+{
+    const double tolerance = 1e-12;
+    const std::size_t plot_size = 7;
+    std::size_t plots = ( t.n + plot_size - 1 ) / plot_size;
+
+    std::vector<double> tpa( t.n );
+    std::vector<int> contiguous( t.n ), scattered( t.n );
+    for( std::size_t i = 0; i < t.n; i++ )
+    {
+        tpa[i] = 6.018046 * ( 1 + i % 4 );
+        contiguous[i] = static_cast<int>( i / plot_size );
+        scattered[i] = static_cast<int>( ( i * 2654435761u ) % plots );
+    }
+
+    // results evaluated beforehand must give the same totals
+    COLUMNS evaluated( t.n );
+    evaluate_batch( t, evaluated.result() );
+
+    bool ok = true;
+    std::cout << "\nplot rollup (tolerance " << tolerance << "; thread counts and evaluated results identical)\n";
+    for( const auto &[name, plot] : { std::pair<const char *,const std::vector<int> &>{ "contiguous", contiguous }, { "scattered", scattered } } )
+    {
+        // reference sums
+        std::map<int,std::array<double,F_COUNT + 1>> sums;
+        for( std::size_t i = 0; i < t.n; i++ )
+        {
+            auto &sum = sums[plot[i]];
+            for( int f = 0; f < F_COUNT; f++ )
+                sum[f] += tpa[i] * total_value( reference.v[f][i] );
+            sum[F_COUNT] += tpa[i] * total_value( compute_green_tons( t.fia_spp[i], reference.v[F_VOLOB][i], reference.v[F_VOLIB][i] ) );
+        }
+
+        std::vector<PLOT_TOTALS> one = rollup_plots( t, plot.data(), tpa.data(), 1 );
+        std::vector<PLOT_TOTALS> many = rollup_plots( t, plot.data(), tpa.data(), std::max( 4u, threads ) );
+        std::vector<PLOT_TOTALS> from_results = rollup_plots( t, evaluated.result(), plot.data(), tpa.data(), std::max( 4u, threads ) );
+
+        ERRORS errors;
+        bool invariant = one.size() == many.size() && one.size() == from_results.size() && one.size() == sums.size();
+        std::size_t trees = 0;
+        for( std::size_t p = 0; invariant && p < one.size(); p++ )
+        {
+            auto values = []( const PLOT_TOTALS &a ) {
+                return std::array<double,F_COUNT + 1>{ a.volib, a.volob, a.biomass.wood, a.biomass.bark, a.biomass.branch, a.biomass.foliage,
+                                                      a.biomass.total, a.biomass.above_ground_biomass, a.green_tons };
+            };
+            const PLOT_TOTALS &a = one[p];
+            std::array<double,F_COUNT + 1> x = values( a );
+            auto sum = sums.find( a.plot );
+            invariant = sum != sums.end();
+            for( const PLOT_TOTALS &b : { many[p], from_results[p] } )
+                invariant = invariant && a.plot == b.plot && a.trees == b.trees && x == values( b );
+            for( int f = 0; invariant && f <= F_COUNT; f++ )
+                errors.add( sum->second[f], x[f] );
+            trees += a.trees;
+        }
+
+        bool pass = invariant && trees == t.n && errors.rel <= tolerance;
+        ok = ok && pass;
+        std::cout << "\t" << std::left << std::setw( 12 ) << name << std::right << one.size() << " plots, max rel error " << std::scientific
+                  << std::setprecision( 3 ) << errors.rel << std::defaultfloat << ( invariant ? "" : ", thread dependent" ) << "   "
+                  << ( pass ? "PASS" : "FAIL" ) << "\n";
+    }
+
+    // infinite tree values are left out as undefined ones are
+    COLUMNS undefined = evaluated, infinite = evaluated;
+    for( std::size_t i = 0; i < t.n; i += 11 )
+        for( int f = 0; f < F_COUNT; f++ )
+        {
+            undefined.v[f][i] = NAN;
+            infinite.v[f][i] = i % 2 ? INFINITY : -INFINITY;
+        }
+    std::vector<PLOT_TOTALS> a = rollup_plots( t, undefined.result(), contiguous.data(), tpa.data(), 1 );
+    std::vector<PLOT_TOTALS> b = rollup_plots( t, infinite.result(), contiguous.data(), tpa.data(), 1 );
+    bool same = a.size() == b.size();
+    for( std::size_t p = 0; same && p < a.size(); p++ )
+        same = a[p].volib == b[p].volib && a[p].volob == b[p].volob && a[p].green_tons == b[p].green_tons && a[p].biomass.wood == b[p].biomass.wood
+               && a[p].biomass.bark == b[p].biomass.bark && a[p].biomass.branch == b[p].biomass.branch && a[p].biomass.foliage == b[p].biomass.foliage
+               && a[p].biomass.total == b[p].biomass.total && a[p].biomass.above_ground_biomass == b[p].biomass.above_ground_biomass;
+    ok = ok && same;
+    std::cout << "\tinfinite    tree values left out   " << ( same ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// green tons of the batch kernels (per tree, by product class and from plans) against compute_green_tons()
+// of the reference volumes and of random log volumes of every species
+static bool check_green_tons( const TREE_BATCH &t, const COLUMNS &reference, unsigned seed )
+{
+    const double tolerance = 1e-15;
+
+    // trees of the grid and fuzz, and random logs of every species (and unknown codes)
+    std::vector<int> spp( t.fia_spp, t.fia_spp + t.n );
+    std::vector<double> volob( reference.v[F_VOLOB] ), volib( reference.v[F_VOLIB] );
+    std::mt19937_64 rng( seed );
+    std::uniform_real_distribution<double> volume( 0.0, 80.0 ), bark( 0.0, 0.3 );
+    for( const REF_RECORD &r : ref_table() )
+        for( int k = 0; k < 50; k++ )
+        {
+            double vib = volume( rng );
+            spp.push_back( k % 10 ? r.fia_spp : r.fia_spp + 100000 );
+            volib.push_back( vib );
+            volob.push_back( vib * ( 1.0 + bark( rng ) ) );
+        }
+    std::size_t n = spp.size();
+
+    std::vector<int> product( n );
+    for( std::size_t i = 0; i < n; i++ )
+        product[i] = static_cast<int>( rng() % 6 ) - 1;
+
+    std::vector<double> tons( n ), logs( n ), classes( 5 ), expected_classes( 5 );
+    compute_green_tons( n, spp.data(), volob.data(), volib.data(), tons.data() );
+    green_tons_by_class( n, spp.data(), volob.data(), volib.data(), product.data(), classes.size(), classes.data(), logs.data() );
+
+    // errors relative to the size of the wood and bark terms: fuzzed trees with volob below volib
+    // cancel, leaving a tiny reference
+    double batch = 0.0, plans = 0.0;
+    bool same = true;
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        double r = compute_green_tons( spp[i], volob[i], volib[i] );
+        const GREEN_FACTORS &f = species_green_factors( spp[i] );
+        double size = std::fabs( volib[i] * f.wood ) + std::fabs( ( volob[i] - volib[i] ) * f.bark );
+        auto error = [&]( double x ) {
+            if( std::isnan( r ) && std::isnan( x ) )
+                return 0.0;
+            double a = std::fabs( x - r );
+            return a == 0.0 ? 0.0 : std::isnan( a ) ? INFINITY : a / size;
+        };
+        batch = std::max( batch, error( tons[i] ) );
+        plans = std::max( plans, error( evaluate_green_tons( resolve_plan( spp[i], DIV_NONE ), volob[i], volib[i] ) ) );
+        same = same && ( logs[i] == tons[i] || ( std::isnan( logs[i] ) && std::isnan( tons[i] ) ) );
+        if( product[i] >= 0 && product[i] < 5 && !std::isnan( tons[i] ) )
+            expected_classes[product[i]] += tons[i];
+    }
+    same = same && classes == expected_classes;
+
+    bool ok = batch <= tolerance && plans <= tolerance && same;
+    std::cout << "\ngreen tons (" << n << " stems and logs, tolerance " << tolerance << "): batch max rel error " << std::scientific
+              << std::setprecision( 3 ) << batch << ", plans " << plans << std::defaultfloat << ", product classes "
+              << ( same ? "ok" : "differ" ) << "   " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// logs of merchandized stems: log tons must be those of the batch compute_green_tons() and stem
+// totals the sums of their logs (NaN left out); decreasing offsets must throw
+static bool check_stem_logs( unsigned seed )
+{
+    std::mt19937_64 rng( seed + 2 );
+    std::uniform_real_distribution<double> volume( 0.0, 30.0 ), bark( 0.0, 0.3 );
+    const REF_TABLE &refs = ref_table();
+
+    std::vector<int> spp, log_spp;
+    std::vector<std::size_t> offsets = { 0 };
+    std::vector<double> volob, volib;
+    for( std::size_t s = 0; s < 20000; s++ )
+    {
+        spp.push_back( s % 50 ? refs.begin()[rng() % refs.size()].fia_spp : 100000 );
+        std::size_t logs = s % 100 ? 5 + rng() % 11 : s % 200 ? 0 : 400;
+        for( std::size_t k = 0; k < logs; k++ )
+        {
+            double vib = rng() % 500 ? volume( rng ) : NAN;
+            log_spp.push_back( spp.back() );
+            volib.push_back( vib );
+            volob.push_back( vib * ( 1.0 + bark( rng ) ) );
+        }
+        offsets.push_back( volib.size() );
+    }
+    std::size_t stems = spp.size(), n = volib.size();
+
+    std::vector<double> expected( n ), tons( n ), stem_tons( stems ), stem_volob( stems ), stem_volib( stems ), alone( stems );
+    compute_green_tons( n, log_spp.data(), volob.data(), volib.data(), expected.data() );
+    STEM_LOGS logs = { stems, spp.data(), offsets.data(), volob.data(), volib.data() };
+    evaluate_stem_logs( logs, { tons.data(), stem_tons.data(), stem_volob.data(), stem_volib.data() } );
+    evaluate_stem_logs( logs, { nullptr, alone.data(), nullptr, nullptr } );
+
+    auto same = []( double a, double b ) { return a == b || ( std::isnan( a ) && std::isnan( b ) ); };
+    std::size_t bad_logs = 0, bad_stems = 0;
+    for( std::size_t i = 0; i < n; i++ )
+        bad_logs += !same( tons[i], expected[i] );
+    for( std::size_t s = 0; s < stems; s++ )
+    {
+        double t = 0.0, vob = 0.0, vib = 0.0;
+        for( std::size_t i = offsets[s]; i < offsets[s + 1]; i++ )
+        {
+            if( !std::isnan( expected[i] ) ) t += expected[i];
+            if( !std::isnan( volob[i] ) ) vob += volob[i];
+            if( !std::isnan( volib[i] ) ) vib += volib[i];
+        }
+        bad_stems += stem_tons[s] != t || alone[s] != t || stem_volob[s] != vob || stem_volib[s] != vib;
+    }
+
+    bool rejected = false;
+    std::swap( offsets[10], offsets[11] );
+    try {
+        evaluate_stem_logs( logs, { tons.data(), nullptr, nullptr, nullptr } );
+    } catch( const std::runtime_error & ) {
+        rejected = true;
+    }
+
+    bool ok = bad_logs == 0 && bad_stems == 0 && rejected;
+    std::cout << "\nstem logs (" << stems << " stems, " << n << " logs; tolerance 0): " << bad_logs << " logs and " << bad_stems
+              << " stems differ, decreasing offsets " << ( rejected ? "rejected" : "accepted" ) << "   " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// a WORKSPACE evaluating batches of one size must stop allocating after the second batch: no
+// operator new calls and no arena blocks from the heap (divisions as strings and as a dictionary)
+static bool check_workspace( const TREE_BATCH &t )
+{
+    std::size_t n = std::min<std::size_t>( t.n, 50000 );
+    std::vector<std::string> dictionary( t.division, t.division + n );
+    std::sort( dictionary.begin(), dictionary.end() );
+    dictionary.erase( std::unique( dictionary.begin(), dictionary.end() ), dictionary.end() );
+    std::vector<int> index( n );
+    for( std::size_t i = 0; i < n; i++ )
+        index[i] = static_cast<int>( std::lower_bound( dictionary.begin(), dictionary.end(), t.division[i] ) - dictionary.begin() );
+
+    TREE_BATCH strings = t, coded = t;
+    strings.n = coded.n = n;
+    coded.division = nullptr;
+    coded.division_dictionary = dictionary.data();
+    coded.division_dictionary_size = dictionary.size();
+    coded.division_index = index.data();
+
+    bool ok = true;
+    std::size_t calls = 0, blocks = 0;
+    for( const TREE_BATCH *batch : { &strings, &coded } )
+    {
+        WORKSPACE workspace;
+        for( int k = 0; k < 2; k++ )
+        {
+            workspace.evaluate( *batch );
+            workspace.reset();
+        }
+
+        std::size_t before = heap_calls.load(), arena = workspace.arena().heap_allocations();
+        for( int k = 0; k < 5; k++ )
+        {
+            workspace.evaluate( *batch );
+            workspace.reset();
+        }
+        calls += heap_calls.load() - before;
+        blocks += workspace.arena().heap_allocations() - arena;
+    }
+    ok = calls == 0 && blocks == 0;
+
+    std::cout << "\nworkspace (" << n << " trees, 5 batches after 2): " << calls << " operator new calls, " << blocks << " arena blocks   "
+              << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// Philox4x32-10 against the Random123 known answers; Monte Carlo plot totals without error against
+// tpa weighted sums of evaluate_batch() (missing dbh and height, given and infinite vtotib), across thread counts,
+// and with coefficient error only against the deterministic totals, independently for each species
+static bool check_uncertainty( const TREE_BATCH &t, unsigned threads )
+{
+    struct KAT { std::uint32_t counter[4], key[2], out[4]; };
+    const KAT kats[] = {
+        { { 0, 0, 0, 0 }, { 0, 0 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+        { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }, { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+        { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }, { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+    };
+    bool philox = true;
+    for( const KAT &k : kats )
+    {
+        std::uint32_t out[4];
+        philox4x32( k.counter, k.key, out );
+        philox = philox && std::equal( out, out + 4, k.out );
+    }
+
+    const std::size_t plot_size = 7;
+    std::size_t n = std::min<std::size_t>( t.n, 7000 );
+    std::vector<double> dbh( t.dbh, t.dbh + n ), height( t.height, t.height + n ), tpa( n );
+    std::vector<int> plot( n );
+    for( std::size_t i = 0; i < n; i++ )
+    {
+        tpa[i] = 6.018046 * ( 1 + i % 4 );
+        plot[i] = static_cast<int>( i / plot_size );
+        if( i % 97 == 3 )
+            dbh[i] = NAN;
+        if( i % 89 == 5 )
+            height[i] = NAN;
+    }
+    TREE_BATCH batch = t;
+    batch.n = n;
+    batch.dbh = dbh.data();
+    batch.height = height.data();
+    batch.planted = nullptr;
+
+    COLUMNS volumes( n );
+    evaluate_batch( batch, volumes.result() );
+    std::vector<double> vtotib( volumes.v[F_VOLIB] );
+    for( std::size_t i = 0; i < n; i++ )
+        vtotib[i] = i % 101 == 7 ? INFINITY : 0.9 * vtotib[i];
+    batch.vtotib = vtotib.data();
+
+    COLUMNS evaluated( n );
+    evaluate_batch( batch, evaluated.result() );
+    std::map<int,std::array<double,UQ_COUNT>> sums;
+    for( std::size_t i = 0; i < n; i++ )
+        for( int f = 0; f < F_COUNT; f++ )
+            sums[plot[i]][f] += tpa[i] * total_value( evaluated.v[f][i] );
+
+    UNCERTAINTY_OPTIONS options;
+    options.replicates = 64;
+    options.threads = 1;
+    std::vector<PLOT_UNCERTAINTY> exact = plot_uncertainty( batch, plot.data(), tpa.data(), UNCERTAINTY_MODEL{}, options );
+
+    // without error every replicate is the deterministic total
+    ERRORS errors;
+    bool degenerate = exact.size() == sums.size();
+    for( const PLOT_UNCERTAINTY &u : exact )
+    {
+        auto sum = sums.find( u.plot );
+        degenerate = degenerate && sum != sums.end();
+        for( int q = 0; degenerate && q < UQ_COUNT; q++ )
+        {
+            degenerate = u.sd[q] == 0.0 && u.quantiles[q].front() == u.mean[q] && u.quantiles[q].back() == u.mean[q];
+            errors.add( sum->second[q], u.mean[q] );
+        }
+    }
+
+    // replicates are identical for any thread count
+    UNCERTAINTY_MODEL model;
+    model.dbh_cv = 0.02;
+    model.height_sd = 3.0;
+    model.coef_cv = 0.1;
+    std::vector<std::vector<PLOT_UNCERTAINTY>> runs;
+    for( unsigned k : { 1u, 2u, std::max( 8u, threads ) } )
+    {
+        options.threads = k;
+        runs.push_back( plot_uncertainty( batch, plot.data(), tpa.data(), model, options ) );
+    }
+    bool invariant = true;
+    for( const auto &run : runs )
+        for( std::size_t p = 0; invariant && p < run.size(); p++ )
+        {
+            const PLOT_UNCERTAINTY &a = runs[0][p], &b = run[p];
+            invariant = a.plot == b.plot && a.trees == b.trees && std::equal( a.mean, a.mean + UQ_COUNT, b.mean ) &&
+                        std::equal( a.sd, a.sd + UQ_COUNT, b.sd );
+            for( int q = 0; invariant && q < UQ_COUNT; q++ )
+                invariant = a.quantiles[q] == b.quantiles[q];
+        }
+
+    // coefficient error alone scales the volib of a one tree plot by a mean one factor per replicate, so
+    // the mean matches the deterministic volib within 6 standard errors and the relative sd is coef_cv
+    const double coef_cv = 0.1;
+    UNCERTAINTY_MODEL coefficients;
+    coefficients.coef_cv = coef_cv;
+    options.replicates = 4000;
+    options.threads = threads;
+    batch.n = 10 * plot_size;
+    std::vector<int> single( batch.n );
+    for( std::size_t i = 0; i < batch.n; i++ )
+        single[i] = static_cast<int>( i );
+    std::vector<PLOT_UNCERTAINTY> scaled = plot_uncertainty( batch, single.data(), tpa.data(), coefficients, options );
+    double factor_error = 0.0, cv_error = 0.0;
+    for( const PLOT_UNCERTAINTY &u : scaled )
+    {
+        double x = tpa[u.plot] * total_value( evaluated.v[F_VOLIB][u.plot] );
+        if( x == 0.0 )
+            continue;
+        factor_error = std::max( factor_error, std::abs( u.mean[UQ_VOLIB] / x - 1.0 ) );
+        cv_error = std::max( cv_error, std::abs( u.sd[UQ_VOLIB] / u.mean[UQ_VOLIB] - coef_cv ) );
+    }
+    double standard_error = coef_cv / std::sqrt( double( options.replicates ) );
+
+    // factors of different species' equations are independent: the variance of a plot of two species is
+    // the sum of their variances (perfectly correlated factors would give the square of the summed sds)
+    const int species[] = { 202, 122, 202, 122 };
+    const std::string divisions[4];
+    const double diameters[] = { 10.0, 12.0, 10.0, 12.0 }, heights[] = { 60.0, 70.0, 60.0, 70.0 };
+    const int mixed_plot[] = { 0, 1, 2, 2 };
+    TREE_BATCH mixed;
+    mixed.n = 4;
+    mixed.fia_spp = species;
+    mixed.division = divisions;
+    mixed.dbh = diameters;
+    mixed.height = heights;
+    std::vector<PLOT_UNCERTAINTY> pair = plot_uncertainty( mixed, mixed_plot, nullptr, coefficients, options );
+    double independent = std::hypot( pair[0].sd[UQ_VOLIB], pair[1].sd[UQ_VOLIB] );
+    double correlation_error = std::abs( pair[2].sd[UQ_VOLIB] / independent - 1.0 );
+
+    const double tolerance = 1e-12;
+    bool ok = philox && degenerate && errors.rel <= tolerance && invariant && !scaled.empty() && factor_error <= 6 * standard_error &&
+              cv_error <= 0.1 * coef_cv && correlation_error <= 0.05;
+
+    std::cout << "\nuncertainty (tolerance " << tolerance << "; Philox4x32-10 known answers " << ( philox ? "match" : "differ" ) << ")\n"
+              << "\twithout error " << exact.size() << " plots, max rel error " << std::scientific << std::setprecision( 3 ) << errors.rel
+              << std::defaultfloat << ( degenerate ? "" : ", replicates differ" ) << ( invariant ? "" : ", thread dependent" ) << "\n"
+              << "\tcoefficient cv " << coef_cv << ": max mean factor error " << std::setprecision( 3 ) << factor_error << ", max cv error "
+              << cv_error << ", two species sd error " << correlation_error << std::defaultfloat << "   " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+// every entry of the coefficient tables of nsvb_coef.hpp must be found unchanged in the embedded blob
+static bool check_coef_blob()
+{
+    using COEF_MAP = std::unordered_map<int,COEFS>;
+    using DIVISION_MAP = std::unordered_map<std::string,COEF_MAP>;
+
+    auto same = []( const COEFS *a, const COEFS &b ) {
+        return a && a->equation == b.equation && a->planted == b.planted && a->a == b.a && a->b == b.b && a->c == b.c && a->b2 == b.b2
+            && a->a0 == b.a0 && a->b0 == b.b0 && a->b1 == b.b1 && a->a1 == b.a1 && a->c1 == b.c1;
+    };
+
+    const COEF_MAP *maps[COMP_COUNT][3] = {
+        { &bark_coefs, &planted_bark_coefs, &jenkins_bark_coefs }, { &branch_coefs, &planted_branch_coefs, &jenkins_branch_coefs },
+        { &foliage_coefs, &planted_foliage_coefs, &jenkins_foliage_coefs }, { &total_coefs, &planted_total_coefs, &jenkins_total_coefs },
+        { &volib_coefs, &planted_volib_coefs, &jenkins_volib_coefs }, { &volob_coefs, &planted_volob_coefs, &jenkins_volob_coefs } };
+    const DIVISION_MAP *divisions[COMP_COUNT] = { &division_bark_coefs, &division_branch_coefs, &division_foliage_coefs,
+                                                  &division_total_coefs, &division_volib_coefs, &division_volob_coefs };
+    const COEF_KIND kinds[3] = { COEF_SPECIES, COEF_PLANTED, COEF_JENKINS };
+
+    std::size_t entries = 0, mismatches = 0;
+    for( int c = 0; c < COMP_COUNT; c++ )
+    {
+        COMPONENT component = static_cast<COMPONENT>( c );
+        for( int k = 0; k < 3; k++ )
+        {
+            const COEF_TABLE &table = coef_table( kinds[k], component );
+            mismatches += table.size() != maps[c][k]->size();
+            for( auto &[spp, coefs] : *maps[c][k] )
+            {
+                mismatches += !same( find_coefs( table, spp ), coefs );
+                entries++;
+            }
+        }
+        for( auto &[division, map] : *divisions[c] )
+        {
+            const COEF_TABLE *table = division_coef_table( component, division );
+            mismatches += !table || table->size() != map.size();
+            for( auto &[spp, coefs] : map )
+            {
+                mismatches += !table || !same( find_coefs( *table, spp ), coefs );
+                entries++;
+            }
+        }
+    }
+
+    mismatches += ref_table().size() != refs.size();
+    for( auto &[spp, r] : refs )
+    {
+        const REFS *b = find_refs( spp );
+        mismatches += !b || b->Jenkins_spcd != r.Jenkins_spcd || b->wood_sg != r.wood_sg || b->bark_sg != r.bark_sg
+                      || b->mc_pct_green_wood != r.mc_pct_green_wood || b->mc_pct_green_bark != r.mc_pct_green_bark;
+        entries++;
+    }
+
+    COEF_BLOB_INFO info = verify_coef_blob();
+    bool ok = mismatches == 0 && info.checksum_ok;
+
+    std::cout << "\ncoefficient blob (version " << info.version << ", " << info.bytes << " bytes, " << info.tables << " tables, checksum "
+              << std::hex << info.checksum << std::dec << ( info.checksum_ok ? " ok" : " BAD" ) << ", " << entries << " entries, "
+              << mismatches << " mismatches): " << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+    return ok;
+}
+
+int main( int argc, char **argv )
+{
+    unsigned threads = std::max( 1u, std::thread::hardware_concurrency() );
+    std::size_t fuzz = 200000;
+    unsigned seed = 1;
+    const char *csv = nullptr;
+
+    for( int i = 1; i + 1 < argc; i += 2 )
+    {
+        if( !std::strcmp( argv[i], "-threads" ) ) threads = std::atoi( argv[i + 1] );
+        else if( !std::strcmp( argv[i], "-fuzz" ) ) fuzz = std::strtoull( argv[i + 1], nullptr, 10 );
+        else if( !std::strcmp( argv[i], "-seed" ) ) seed = std::atoi( argv[i + 1] );
+        else if( !std::strcmp( argv[i], "-csv" ) ) csv = argv[i + 1];
+        else {
+            std::cerr << "usage: validate [-threads N] [-fuzz N] [-seed S] [-csv file]\n";
+            return 2;
+        }
+    }
+
+    // every species x every division (and an unrecognized one) over a dbh/height grid
+    std::vector<int> species;
+    for( auto &r : refs )
+        species.push_back( r.first );
+    std::sort( species.begin(), species.end() );
+
+    std::vector<std::string> divisions;
+    for( int d = 0; d < DIV_COUNT; d++ )
+        divisions.push_back( division_name( static_cast<DIVISION>( d ) ) );
+    divisions.push_back( "X999" );
+
+    const double dbhs[] = { 0.5, 1.0, 3.0, 5.0, 8.9, 9.0, 9.1, 10.9, 11.0, 11.1, 15.0, 24.0, 36.0, 60.0 };
+    const double heights[] = { 4.5, 12.0, 30.0, 60.0, 95.0, 140.0, 220.0 };
+
+    std::vector<int> spp;
+    std::vector<std::string> div;
+    std::vector<double> dbh, height;
+
+    for( int s : species )
+        for( auto &d : divisions )
+            for( double x : dbhs )
+                for( double h : heights )
+                {
+                    spp.push_back( s ); div.push_back( d ); dbh.push_back( x ); height.push_back( h );
+                }
+    std::size_t grid = spp.size();
+
+    // randomized inputs including unknown species and division strings
+    std::mt19937_64 rng( seed );
+    std::uniform_real_distribution<double> u( 0.0, 1.0 );
+    const char *junk[] = { " M240", "m240", "240 ", "M", "0", "MM240" };
+    for( std::size_t i = 0; i < fuzz; i++ )
+    {
+        double p = u( rng );
+        spp.push_back( p < 0.9 ? species[rng() % species.size()] : int( rng() % 10000 ) - 5 );
+        p = u( rng );
+        div.push_back( p < 0.95 ? divisions[rng() % divisions.size()] : junk[rng() % std::size( junk )] );
+        dbh.push_back( std::exp( std::log( 0.1 ) + u( rng ) * std::log( 800.0 ) ) );
+        height.push_back( 1.0 + u( rng ) * 250.0 );
+    }
+
+    std::size_t n = spp.size();
+    std::cout << "trees = " << n << " (grid " << grid << ", fuzz " << fuzz << "), threads = " << threads << "\n";
+
+    // reference
+    COLUMNS reference( n );
+    parallel_for( n, threads, [&]( std::size_t begin, std::size_t end ) {
+        for( std::size_t i = begin; i < end; i++ )
+        {
+            double vib = compute_volib( spp[i], div[i], dbh[i], height[i] );
+            BIOMASS_COMP bc = biomass_components( spp[i], div[i], vib, dbh[i], height[i] );
+
+            reference.v[F_VOLIB][i] = vib;
+            reference.v[F_VOLOB][i] = compute_volob( spp[i], div[i], dbh[i], height[i] );
+            reference.v[F_WOOD][i] = bc.wood;
+            reference.v[F_BARK][i] = bc.bark;
+            reference.v[F_BRANCH][i] = bc.branch;
+            reference.v[F_FOLIAGE][i] = bc.foliage;
+            reference.v[F_TOTAL][i] = bc.total;
+            reference.v[F_AGB][i] = bc.above_ground_biomass;
+        }
+    }, 4096 );
+
+    TREE_BATCH trees;
+    trees.n = n;
+    trees.fia_spp = spp.data();
+    trees.division = div.data();
+    trees.dbh = dbh.data();
+    trees.height = height.data();
+
+    std::vector<MODE> modes = {
+        { "batch", 0.0, []( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            evaluate_batch( t, r );
+        } },
+        { "batch_threads", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            evaluate_batch( t, r, options );
+        } },
+        { "batch_sorted", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            options.sort = true;
+            evaluate_batch( t, r, options );
+        } },
+        { "batch_sorted_small", 0.0, []( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            // small batches: species_order() counts narrow key ranges and compares wide ones
+            BATCH_OPTIONS options;
+            options.sort = true;
+            for( std::size_t begin = 0; begin < t.n; begin += 97 )
+            {
+                TREE_BATCH slice = t;
+                slice.n = std::min<std::size_t>( 97, t.n - begin );
+                slice.fia_spp += begin;
+                slice.division += begin;
+                slice.dbh += begin;
+                slice.height += begin;
+                BATCH_RESULT out = { r.volib + begin, r.volob + begin, r.wood + begin, r.bark + begin, r.branch + begin, r.foliage + begin,
+                                     r.total + begin, r.above_ground_biomass + begin };
+                evaluate_batch( slice, out, options );
+            }
+        } },
+        { "batch_dictionary", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            std::vector<std::string> dictionary;
+            std::map<std::string,int> lookup;
+            std::vector<int> index( t.n );
+            for( std::size_t i = 0; i < t.n; i++ )
+            {
+                auto [it, added] = lookup.emplace( t.division[i], int( dictionary.size() ) );
+                if( added )
+                    dictionary.push_back( t.division[i] );
+                index[i] = it->second;
+            }
+
+            TREE_BATCH d = t;
+            d.division = nullptr;
+            d.division_dictionary = dictionary.data();
+            d.division_dictionary_size = dictionary.size();
+            d.division_index = index.data();
+
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            evaluate_batch( d, r, options );
+        } },
+        { "arrow_dictionary", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            evaluate_arrow( t, r, threads );
+        } },
+        { "workspace_dictionary", 0.0, []( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            std::vector<std::string> dictionary;
+            std::map<std::string,int> lookup;
+            std::vector<int> index( t.n );
+            for( std::size_t i = 0; i < t.n; i++ )
+            {
+                auto [it, added] = lookup.emplace( t.division[i], int( dictionary.size() ) );
+                if( added )
+                    dictionary.push_back( t.division[i] );
+                index[i] = it->second;
+            }
+
+            TREE_BATCH d = t;
+            d.division = nullptr;
+            d.division_dictionary = dictionary.data();
+            d.division_dictionary_size = dictionary.size();
+            d.division_index = index.data();
+
+            // second batch reuses the arena of the first
+            WORKSPACE workspace;
+            workspace.evaluate( d );
+            workspace.reset();
+            BATCH_RESULT w = workspace.evaluate( d );
+
+            double *from[] = { w.volib, w.volob, w.wood, w.bark, w.branch, w.foliage, w.total, w.above_ground_biomass };
+            double *to[] = { r.volib, r.volob, r.wood, r.bark, r.branch, r.foliage, r.total, r.above_ground_biomass };
+            for( int f = 0; f < F_COUNT; f++ )
+                std::copy( from[f], from[f] + t.n, to[f] );
+        } },
+        { "batch_plan_table", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            // later modes and checks also use the table once it is built
+            std::cout << "\n" << precompute_plans( threads ).report() << "\n";
+
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            evaluate_batch( t, r, options );
+        } },
+        { "batch_numa", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            NUMA_RESULT placed( t.n, threads );
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            options.numa = true;
+            evaluate_batch( t, placed.result(), options );
+
+            const BATCH_RESULT &w = placed.result();
+            double *from[] = { w.volib, w.volob, w.wood, w.bark, w.branch, w.foliage, w.total, w.above_ground_biomass };
+            double *to[] = { r.volib, r.volob, r.wood, r.bark, r.branch, r.foliage, r.total, r.above_ground_biomass };
+            for( int f = 0; f < F_COUNT; f++ )
+                std::copy( from[f], from[f] + t.n, to[f] );
+        } },
+        { "batch_gradient", 0.0, [threads]( const TREE_BATCH &t, const BATCH_RESULT &r ) {
+            BATCH_OPTIONS options;
+            options.threads = threads;
+            evaluate_batch_gradient( t, r, BATCH_RESULT(), BATCH_RESULT(), options );
+        } },
+    };
+
+    std::ofstream out;
+    if( csv )
+    {
+        out.open( csv );
+        out << "mode,fia_spp,form,max_abs_error,max_rel_error\n";
+    }
+
+    bool failed = false;
+    for( auto &mode : modes )
+    {
+        COLUMNS x( n );
+        mode.evaluate( trees, x.result() );
+
+        // errors per species (unknown species are reported as 999) and form
+        std::map<int,std::array<ERRORS,F_COUNT>> errors;
+        std::array<ERRORS,F_COUNT> overall;
+        std::array<int,F_COUNT> worst_spp{};
+
+        for( std::size_t i = 0; i < n; i++ )
+        {
+            int s = refs.count( spp[i] ) ? spp[i] : 999;
+            auto &e = errors[s];
+            for( int f = 0; f < F_COUNT; f++ )
+                e[f].add( reference.v[f][i], x.v[f][i] );
+        }
+
+        for( auto &[s, e] : errors )
+            for( int f = 0; f < F_COUNT; f++ )
+            {
+                if( e[f].rel > overall[f].rel )
+                    worst_spp[f] = s;
+                overall[f].abs = std::max( overall[f].abs, e[f].abs );
+                overall[f].rel = std::max( overall[f].rel, e[f].rel );
+
+                if( csv )
+                    out << mode.name << "," << s << "," << form_names[f] << "," << e[f].abs << "," << e[f].rel << "\n";
+            }
+
+        bool ok = true;
+        for( int f = 0; f < F_COUNT; f++ )
+            ok = ok && overall[f].rel <= mode.tolerance;
+        failed = failed || !ok;
+
+        std::cout << "\n" << mode.name << " (tolerance " << mode.tolerance << "): " << ( ok ? "PASS" : "FAIL" ) << "\n";
+        std::cout << "\tform      max abs error   max rel error   worst species\n";
+        for( int f = 0; f < F_COUNT; f++ )
+        {
+            std::cout << "\t" << std::left << std::setw( 10 ) << form_names[f] << std::right << std::scientific << std::setprecision( 3 )
+                      << std::setw( 13 ) << overall[f].abs << std::setw( 16 ) << overall[f].rel << std::defaultfloat;
+            if( overall[f].rel > 0.0 )
+                std::cout << std::setw( 16 ) << worst_spp[f];
+            std::cout << "\n";
+        }
+    }
+
+    failed = !check_derivatives( trees, reference, threads ) || failed;
+    failed = !check_inverse( trees, reference, threads ) || failed;
+    failed = !check_tree_list( trees, threads, seed ) || failed;
+    failed = !check_species_order( seed ) || failed;
+    failed = !check_plan_cache( trees, reference, threads ) || failed;
+    failed = !check_rollup( trees, reference, threads ) || failed;
+    failed = !check_green_tons( trees, reference, seed ) || failed;
+    failed = !check_stem_logs( seed ) || failed;
+    failed = !check_workspace( trees ) || failed;
+    failed = !check_coef_blob() || failed;
+    failed = !check_numa( threads ) || failed;
+    failed = !check_uncertainty( trees, threads ) || failed;
+
+    return failed ? 1 : 0;
+}
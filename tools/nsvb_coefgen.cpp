@@ -0,0 +1,209 @@
+// National Scale Volume and Biomass estimators (NSVB) coefficient blob generator
+//
+// usage: nsvb_coefgen [-cpp] output
+//
+// Converts the coefficient tables of nsvb_coef.hpp into the binary blob described in
+// nsvb_coef_blob.hpp, embedded in the library by src/nsvb_coef_blob.S. With -cpp the blob
+// is written as a C++ byte array instead, for compilers without an assembler.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nsvb_coef.hpp"
+
+using COEF_MAP = std::unordered_map<int,COEFS>;
+using DIVISION_MAP = std::unordered_map<std::string,COEF_MAP>;
+
+// tables of one component
+struct COMPONENT_MAPS {
+    const COEF_MAP &species;
+    const COEF_MAP &planted;
+    const COEF_MAP &jenkins;
+    const DIVISION_MAP &division;
+};
+
+// a table and its records
+struct TABLE {
+    COEF_TABLE_ENTRY entry{};
+    std::vector<unsigned char> records;
+};
+
+// records of a coefficient map sorted by species; fields are copied one by one so padding is zero
+static TABLE coef_records( COEF_KIND kind, COMPONENT component, const COEF_MAP &map, const std::string &division = "" )
+{
+    TABLE t;
+    t.entry.kind = kind;
+    t.entry.component = component;
+    if( division.size() >= sizeof( t.entry.division ) )
+        throw std::runtime_error( "division name too long: " + division );
+    std::memcpy( t.entry.division, division.data(), division.size() );
+
+    std::vector<int> species;
+    for( auto &m : map )
+        species.push_back( m.first );
+    std::sort( species.begin(), species.end() );
+
+    t.records.assign( species.size() * sizeof( COEF_RECORD ), 0 );
+    for( std::size_t i = 0; i < species.size(); i++ )
+    {
+        const COEFS &c = map.at( species[i] );
+        COEF_RECORD r;
+        std::memset( &r, 0, sizeof( r ) );
+        r.fia_spp = species[i];
+        r.coefs.equation = c.equation;
+        r.coefs.planted = c.planted;
+        r.coefs.a = c.a;
+        r.coefs.b = c.b;
+        r.coefs.c = c.c;
+        r.coefs.b2 = c.b2;
+        r.coefs.a0 = c.a0;
+        r.coefs.b0 = c.b0;
+        r.coefs.b1 = c.b1;
+        r.coefs.a1 = c.a1;
+        r.coefs.c1 = c.c1;
+        std::memcpy( t.records.data() + i * sizeof( COEF_RECORD ), &r, sizeof( r ) );
+    }
+    t.entry.count = species.size();
+
+    return t;
+}
+
+static TABLE ref_records()
+{
+    TABLE t;
+    t.entry.kind = COEF_REFS;
+
+    std::vector<int> species;
+    for( auto &r : refs )
+        species.push_back( r.first );
+    std::sort( species.begin(), species.end() );
+
+    t.records.assign( species.size() * sizeof( REF_RECORD ), 0 );
+    for( std::size_t i = 0; i < species.size(); i++ )
+    {
+        const REFS &x = refs.at( species[i] );
+        REF_RECORD r;
+        std::memset( &r, 0, sizeof( r ) );
+        r.fia_spp = species[i];
+        r.refs.Jenkins_spcd = x.Jenkins_spcd;
+        r.refs.wood_sg = x.wood_sg;
+        r.refs.bark_sg = x.bark_sg;
+        r.refs.mc_pct_green_wood = x.mc_pct_green_wood;
+        r.refs.mc_pct_green_bark = x.mc_pct_green_bark;
+        std::memcpy( t.records.data() + i * sizeof( REF_RECORD ), &r, sizeof( r ) );
+    }
+    t.entry.count = species.size();
+
+    return t;
+}
+
+// the blob of all tables
+static std::vector<unsigned char> coef_blob()
+{
+    const COMPONENT_MAPS components[COMP_COUNT] = {
+        { bark_coefs, planted_bark_coefs, jenkins_bark_coefs, division_bark_coefs },
+        { branch_coefs, planted_branch_coefs, jenkins_branch_coefs, division_branch_coefs },
+        { foliage_coefs, planted_foliage_coefs, jenkins_foliage_coefs, division_foliage_coefs },
+        { total_coefs, planted_total_coefs, jenkins_total_coefs, division_total_coefs },
+        { volib_coefs, planted_volib_coefs, jenkins_volib_coefs, division_volib_coefs },
+        { volob_coefs, planted_volob_coefs, jenkins_volob_coefs, division_volob_coefs }
+    };
+
+    std::vector<TABLE> tables;
+    tables.push_back( ref_records() );
+    for( int c = 0; c < COMP_COUNT; c++ )
+    {
+        COMPONENT component = static_cast<COMPONENT>( c );
+        tables.push_back( coef_records( COEF_SPECIES, component, components[c].species ) );
+        tables.push_back( coef_records( COEF_PLANTED, component, components[c].planted ) );
+        tables.push_back( coef_records( COEF_JENKINS, component, components[c].jenkins ) );
+
+        std::vector<std::string> divisions;
+        for( auto &d : components[c].division )
+            divisions.push_back( d.first );
+        std::sort( divisions.begin(), divisions.end() );
+        for( auto &d : divisions )
+            tables.push_back( coef_records( COEF_DIVISION, component, components[c].division.at( d ), d ) );
+    }
+
+    // header, directory, then the records of each table in directory order
+    std::size_t offset = sizeof( COEF_BLOB_HEADER ) + tables.size() * sizeof( COEF_TABLE_ENTRY );
+    for( auto &t : tables )
+    {
+        t.entry.offset = offset;
+        offset += t.records.size();
+    }
+
+    std::vector<unsigned char> blob( offset, 0 );
+    COEF_BLOB_HEADER h;
+    std::memset( &h, 0, sizeof( h ) );
+    std::memcpy( h.magic, COEF_BLOB_MAGIC, sizeof( h.magic ) );
+    h.version = COEF_BLOB_VERSION;
+    h.byte_order = COEF_BLOB_BYTE_ORDER;
+    h.coef_record_size = sizeof( COEF_RECORD );
+    h.ref_record_size = sizeof( REF_RECORD );
+    h.tables = static_cast<std::uint32_t>( tables.size() );
+    h.bytes = blob.size();
+
+    unsigned char *p = blob.data() + sizeof( COEF_BLOB_HEADER );
+    for( auto &t : tables )
+    {
+        std::memcpy( p, &t.entry, sizeof( t.entry ) );
+        p += sizeof( t.entry );
+    }
+    for( auto &t : tables )
+        std::copy( t.records.begin(), t.records.end(), blob.begin() + t.entry.offset );
+
+    h.checksum = coef_blob_checksum( blob.data() + sizeof( h ), blob.size() - sizeof( h ) );
+    std::memcpy( blob.data(), &h, sizeof( h ) );
+
+    return blob;
+}
+
+// the blob as a C++ byte array
+static void write_cpp( std::ostream &os, const std::vector<unsigned char> &blob )
+{
+    os << "// National Scale Volume and Biomass estimators (NSVB) embedded coefficient tables\n"
+       << "//\n// Generated by nsvb_coefgen; do not edit.\n\n"
+       << "extern \"C\" {\n"
+       << "extern const unsigned char nsvb_coef_blob[" << blob.size() << "];\n"
+       << "alignas( 64 ) const unsigned char nsvb_coef_blob[" << blob.size() << "] = {";
+    for( std::size_t i = 0; i < blob.size(); i++ )
+        os << ( i % 24 ? "," : "\n    " ) << int( blob[i] );
+    os << "\n};\n}\n";
+}
+
+int main( int argc, char **argv )
+{
+    bool cpp = argc > 1 && std::strcmp( argv[1], "-cpp" ) == 0;
+    if( argc != 2 + cpp )
+    {
+        std::cerr << "usage: nsvb_coefgen [-cpp] output\n";
+        return 2;
+    }
+    const char *output = argv[1 + cpp];
+
+    try {
+        std::vector<unsigned char> blob = coef_blob();
+
+        std::ofstream os( output, cpp ? std::ios::out : std::ios::binary );
+        if( cpp )
+            write_cpp( os, blob );
+        else
+            os.write( reinterpret_cast<const char *>( blob.data() ), blob.size() );
+        if( !os.flush() )
+            throw std::runtime_error( std::string( "cannot write " ) + output );
+    } catch( const std::exception &e ) {
+        std::cerr << "nsvb_coefgen: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,399 @@
+// National Scale Volume and Biomass estimators (NSVB) compressed files
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include "nsvb_compress.hpp"
+
+#ifdef NSVB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef NSVB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef NSVB_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+static const char *compression_names[] = { "none", "gzip", "zstd", "lz4" };
+static const char *compression_extensions[] = { "", ".gz", ".zst", ".lz4" };
+static const char *compression_libraries[] = { "", "zlib", "libzstd", "liblz4" };
+
+// compressed bytes read at a time
+constexpr std::size_t READ_CHUNK = 1u << 20;
+
+// throw unless the library of a compression is built in
+static void require( int c )
+{
+    if( c < CP_NONE || c > CP_LZ4 )
+        throw std::runtime_error( "unknown compression" );
+    if( !compression_available( static_cast<COMPRESSION>( c ) ) )
+        throw std::runtime_error( std::string( compression_names[c] ) + " compression needs " + compression_libraries[c] + ", not in this build" );
+}
+
+COMPRESSION compression( std::string_view name )
+{
+    for( int c = CP_NONE; c <= CP_LZ4; c++ )
+        if( name == compression_names[c] )
+        {
+            require( c );
+            return static_cast<COMPRESSION>( c );
+        }
+    throw std::runtime_error( "unknown compression " + std::string( name ) );
+}
+
+const char *compression_name( COMPRESSION c )
+{
+    return compression_names[c];
+}
+
+const char *compression_extension( COMPRESSION c )
+{
+    return compression_extensions[c];
+}
+
+bool compression_available( COMPRESSION c )
+{
+    switch( c )
+    {
+        case CP_NONE: return true;
+#ifdef NSVB_HAVE_ZLIB
+        case CP_GZIP: return true;
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        case CP_ZSTD: return true;
+#endif
+#ifdef NSVB_HAVE_LZ4
+        case CP_LZ4: return true;
+#endif
+        default: return false;
+    }
+}
+
+// compression of data starting with these bytes
+COMPRESSION detect_compression( const void *data, std::size_t size )
+{
+    static const unsigned char gzip[] = { 0x1f, 0x8b }, zstd[] = { 0x28, 0xb5, 0x2f, 0xfd }, lz4[] = { 0x04, 0x22, 0x4d, 0x18 };
+
+    if( size >= sizeof( gzip ) && !std::memcmp( data, gzip, sizeof( gzip ) ) )
+        return CP_GZIP;
+    if( size >= sizeof( zstd ) && !std::memcmp( data, zstd, sizeof( zstd ) ) )
+        return CP_ZSTD;
+    if( size >= sizeof( lz4 ) && !std::memcmp( data, lz4, sizeof( lz4 ) ) )
+        return CP_LZ4;
+    return CP_NONE;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// BLOCK_COMPRESSOR
+
+struct BLOCK_COMPRESSOR::STATE {
+#ifdef NSVB_HAVE_ZLIB
+    z_stream zlib{};
+    bool zlib_ready = false;
+#endif
+#ifdef NSVB_HAVE_ZSTD
+    ZSTD_CCtx *zstd = nullptr;
+#endif
+#ifdef NSVB_HAVE_LZ4
+    LZ4F_cctx *lz4 = nullptr;
+#endif
+
+    ~STATE()
+    {
+#ifdef NSVB_HAVE_ZLIB
+        if( zlib_ready )
+            deflateEnd( &zlib );
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        ZSTD_freeCCtx( zstd );
+#endif
+#ifdef NSVB_HAVE_LZ4
+        LZ4F_freeCompressionContext( lz4 );
+#endif
+    }
+};
+
+BLOCK_COMPRESSOR::BLOCK_COMPRESSOR( COMPRESSION c, int compression_level ) : method( c ), level( compression_level ), state( new STATE )
+{
+    require( c );
+
+    switch( c )
+    {
+#ifdef NSVB_HAVE_ZLIB
+        case CP_GZIP:
+            // window bits 15 + 16: a gzip wrapper
+            if( deflateInit2( &state->zlib, level ? level : Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+                throw std::runtime_error( "cannot start gzip compression" );
+            state->zlib_ready = true;
+            break;
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        case CP_ZSTD:
+            state->zstd = ZSTD_createCCtx();
+            if( !state->zstd || ZSTD_isError( ZSTD_CCtx_setParameter( state->zstd, ZSTD_c_compressionLevel, level ) ) )
+                throw std::runtime_error( "cannot start zstd compression" );
+            break;
+#endif
+#ifdef NSVB_HAVE_LZ4
+        case CP_LZ4:
+            if( LZ4F_isError( LZ4F_createCompressionContext( &state->lz4, LZ4F_VERSION ) ) )
+                throw std::runtime_error( "cannot start lz4 compression" );
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+BLOCK_COMPRESSOR::~BLOCK_COMPRESSOR() = default;
+
+// replace out with data compressed into one member or frame
+void BLOCK_COMPRESSOR::compress( std::string_view data, std::string &out )
+{
+    switch( method )
+    {
+#ifdef NSVB_HAVE_ZLIB
+        case CP_GZIP: {
+            if( data.size() > UINT_MAX )
+                throw std::runtime_error( "gzip block too large" );
+            z_stream &z = state->zlib;
+            deflateReset( &z );
+            out.resize( deflateBound( &z, static_cast<uLong>( data.size() ) ) );
+            z.next_in = reinterpret_cast<Bytef *>( const_cast<char *>( data.data() ) );
+            z.avail_in = static_cast<uInt>( data.size() );
+            z.next_out = reinterpret_cast<Bytef *>( out.data() );
+            z.avail_out = static_cast<uInt>( out.size() );
+            if( deflate( &z, Z_FINISH ) != Z_STREAM_END )
+                throw std::runtime_error( "gzip compression failed" );
+            out.resize( out.size() - z.avail_out );
+            return;
+        }
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        case CP_ZSTD: {
+            out.resize( ZSTD_compressBound( data.size() ) );
+            std::size_t n = ZSTD_compress2( state->zstd, out.data(), out.size(), data.data(), data.size() );
+            if( ZSTD_isError( n ) )
+                throw std::runtime_error( std::string( "zstd compression failed: " ) + ZSTD_getErrorName( n ) );
+            out.resize( n );
+            return;
+        }
+#endif
+#ifdef NSVB_HAVE_LZ4
+        case CP_LZ4: {
+            LZ4F_preferences_t preferences;
+            std::memset( &preferences, 0, sizeof( preferences ) );
+            preferences.compressionLevel = level;
+            preferences.frameInfo.contentSize = data.size();
+            out.resize( LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound( data.size(), &preferences ) );
+
+            char *p = out.data(), *end = out.data() + out.size();
+            std::size_t n = LZ4F_compressBegin( state->lz4, p, end - p, &preferences );
+            if( !LZ4F_isError( n ) )
+            {
+                p += n;
+                n = LZ4F_compressUpdate( state->lz4, p, end - p, data.data(), data.size(), nullptr );
+            }
+            if( !LZ4F_isError( n ) )
+            {
+                p += n;
+                n = LZ4F_compressEnd( state->lz4, p, end - p, nullptr );
+            }
+            if( LZ4F_isError( n ) )
+                throw std::runtime_error( std::string( "lz4 compression failed: " ) + LZ4F_getErrorName( n ) );
+            out.resize( p + n - out.data() );
+            return;
+        }
+#endif
+        default:
+            out.assign( data );
+            return;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// COMPRESSED_READER
+
+struct COMPRESSED_READER::STATE {
+    bool in_frame = false;                  // inside a member or frame
+#ifdef NSVB_HAVE_ZLIB
+    z_stream zlib{};
+    bool zlib_ready = false;
+#endif
+#ifdef NSVB_HAVE_ZSTD
+    ZSTD_DCtx *zstd = nullptr;
+#endif
+#ifdef NSVB_HAVE_LZ4
+    LZ4F_dctx *lz4 = nullptr;
+#endif
+
+    ~STATE()
+    {
+#ifdef NSVB_HAVE_ZLIB
+        if( zlib_ready )
+            inflateEnd( &zlib );
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        ZSTD_freeDCtx( zstd );
+#endif
+#ifdef NSVB_HAVE_LZ4
+        LZ4F_freeDecompressionContext( lz4 );
+#endif
+    }
+};
+
+COMPRESSED_READER::COMPRESSED_READER( const std::string &file ) : path( file ), state( new STATE )
+{
+    this->file = std::fopen( path.c_str(), "rb" );
+    if( !this->file )
+        throw std::runtime_error( "cannot open " + path );
+
+    fill();
+    method = detect_compression( input.data(), input.size() );
+    if( !compression_available( method ) )
+    {
+        std::fclose( this->file );
+        throw std::runtime_error( path + ": " + compression_names[method] + " compressed, but " + compression_libraries[method] + " is not in this build" );
+    }
+
+    bool ready = true;
+    switch( method )
+    {
+#ifdef NSVB_HAVE_ZLIB
+        case CP_GZIP:
+            ready = state->zlib_ready = inflateInit2( &state->zlib, 15 + 16 ) == Z_OK;
+            break;
+#endif
+#ifdef NSVB_HAVE_ZSTD
+        case CP_ZSTD:
+            ready = ( state->zstd = ZSTD_createDCtx() ) != nullptr;
+            break;
+#endif
+#ifdef NSVB_HAVE_LZ4
+        case CP_LZ4:
+            ready = !LZ4F_isError( LZ4F_createDecompressionContext( &state->lz4, LZ4F_VERSION ) );
+            break;
+#endif
+        default:
+            break;
+    }
+    if( !ready )
+    {
+        std::fclose( this->file );
+        throw std::runtime_error( path + ": cannot start " + compression_names[method] + " decompression" );
+    }
+}
+
+COMPRESSED_READER::~COMPRESSED_READER()
+{
+    std::fclose( file );
+}
+
+// read more compressed bytes after those not yet consumed; false at the end of the file
+bool COMPRESSED_READER::fill()
+{
+    if( at_end )
+        return false;
+
+    input.erase( 0, used );
+    used = 0;
+    std::size_t keep = input.size();
+    input.resize( keep + READ_CHUNK );
+    std::size_t n = std::fread( input.data() + keep, 1, READ_CHUNK, file );
+    input.resize( keep + n );
+    if( n < READ_CHUNK )
+    {
+        if( std::ferror( file ) )
+            throw std::runtime_error( path + ": read failed" );
+        at_end = true;
+    }
+    return n > 0;
+}
+
+// read up to size bytes of the stream
+std::size_t COMPRESSED_READER::read( char *to, std::size_t size )
+{
+    std::size_t done = 0;
+
+    while( done < size )
+    {
+        if( used == input.size() && !fill() && !state->in_frame )
+            break;
+
+        const char *in = input.data() + used;
+        std::size_t available = input.size() - used, consumed = 0, produced = 0;
+
+        switch( method )
+        {
+#ifdef NSVB_HAVE_ZLIB
+            case CP_GZIP: {
+                z_stream &z = state->zlib;
+                if( !state->in_frame )
+                {
+                    inflateReset( &z );
+                    state->in_frame = true;
+                }
+                z.next_in = reinterpret_cast<Bytef *>( const_cast<char *>( in ) );
+                z.avail_in = static_cast<uInt>( std::min<std::size_t>( available, UINT_MAX ) );
+                z.next_out = reinterpret_cast<Bytef *>( to + done );
+                z.avail_out = static_cast<uInt>( std::min<std::size_t>( size - done, UINT_MAX ) );
+                int result = inflate( &z, Z_NO_FLUSH );
+                consumed = reinterpret_cast<const char *>( z.next_in ) - in;
+                produced = reinterpret_cast<char *>( z.next_out ) - ( to + done );
+                if( result == Z_STREAM_END )
+                    state->in_frame = false;
+                else if( result != Z_OK && result != Z_BUF_ERROR )
+                    throw std::runtime_error( path + ": corrupt gzip data" );
+                break;
+            }
+#endif
+#ifdef NSVB_HAVE_ZSTD
+            case CP_ZSTD: {
+                ZSTD_inBuffer source = { in, available, 0 };
+                ZSTD_outBuffer target = { to + done, size - done, 0 };
+                std::size_t result = ZSTD_decompressStream( state->zstd, &target, &source );
+                if( ZSTD_isError( result ) )
+                    throw std::runtime_error( path + ": corrupt zstd data (" + ZSTD_getErrorName( result ) + ")" );
+                consumed = source.pos;
+                produced = target.pos;
+                state->in_frame = result != 0;
+                break;
+            }
+#endif
+#ifdef NSVB_HAVE_LZ4
+            case CP_LZ4: {
+                std::size_t target = size - done, source = available;
+                std::size_t result = LZ4F_decompress( state->lz4, to + done, &target, in, &source, nullptr );
+                if( LZ4F_isError( result ) )
+                    throw std::runtime_error( path + ": corrupt lz4 data (" + LZ4F_getErrorName( result ) + ")" );
+                consumed = source;
+                produced = target;
+                state->in_frame = result != 0;
+                break;
+            }
+#endif
+            default:
+                consumed = produced = std::min( available, size - done );
+                std::memcpy( to + done, in, consumed );
+                break;
+        }
+
+        used += consumed;
+        done += produced;
+
+        // no progress: the decoder needs more input, or a member or frame is cut short
+        if( !consumed && !produced && !fill() )
+        {
+            if( state->in_frame )
+                throw std::runtime_error( path + ": truncated " + std::string( compression_names[method] ) + " data" );
+            break;
+        }
+    }
+
+    return done;
+}
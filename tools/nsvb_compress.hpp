@@ -0,0 +1,93 @@
+// National Scale Volume and Biomass estimators (NSVB) compressed files
+//
+// Result files are compressed block by block: every block of formatted results becomes a
+// complete gzip member, zstd frame or LZ4 frame, so blocks are compressed independently on
+// the pipeline's format workers (nsvb_pipeline.hpp) and simply concatenated by the writer and
+// by the shard merge. gzip, zstd and lz4 read such files as one stream.
+//
+// COMPRESSED_READER reads a file as one stream whatever its compression (told by its first
+// bytes), including concatenated members or frames, so CSV tree lists may be compressed.
+//
+// Each library is optional: gzip needs zlib (NSVB_HAVE_ZLIB), zstd libzstd (NSVB_HAVE_ZSTD)
+// and LZ4 liblz4's frame API (NSVB_HAVE_LZ4); the build defines those it finds.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_COMPRESS_HPP
+#define NSVB_COMPRESS_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+enum COMPRESSION { CP_NONE = 0, CP_GZIP, CP_ZSTD, CP_LZ4 };
+
+// compression named none, gzip, zstd or lz4 (throws std::runtime_error for another name or
+// one not built in)
+COMPRESSION compression( std::string_view name );
+
+const char *compression_name( COMPRESSION c );
+
+// file name extension of a compression ("" for none)
+const char *compression_extension( COMPRESSION c );
+
+// true when the library of a compression is built in
+bool compression_available( COMPRESSION c );
+
+// compression of data starting with these bytes (CP_NONE when not recognized)
+COMPRESSION detect_compression( const void *data, std::size_t size );
+
+// compresses blocks into complete members or frames, reusing its library state
+class BLOCK_COMPRESSOR {
+public:
+    // level: library level (0: the library's default)
+    explicit BLOCK_COMPRESSOR( COMPRESSION c, int level = 0 );
+    ~BLOCK_COMPRESSOR();
+
+    BLOCK_COMPRESSOR( const BLOCK_COMPRESSOR & ) = delete;
+    BLOCK_COMPRESSOR &operator=( const BLOCK_COMPRESSOR & ) = delete;
+
+    // replace out with data compressed (or copied for CP_NONE)
+    void compress( std::string_view data, std::string &out );
+
+private:
+    struct STATE;
+
+    COMPRESSION method;
+    int level;
+    std::unique_ptr<STATE> state;
+};
+
+// reads a plain or compressed file as one stream
+class COMPRESSED_READER {
+public:
+    explicit COMPRESSED_READER( const std::string &path );
+    ~COMPRESSED_READER();
+
+    COMPRESSED_READER( const COMPRESSED_READER & ) = delete;
+    COMPRESSED_READER &operator=( const COMPRESSED_READER & ) = delete;
+
+    COMPRESSION compression() const { return method; }
+
+    // read up to size bytes of the stream; returns fewer only at its end. Throws
+    // std::runtime_error naming the file for corrupt or truncated data.
+    std::size_t read( char *to, std::size_t size );
+
+private:
+    bool fill();
+
+    struct STATE;
+
+    std::string path;
+    std::FILE *file = nullptr;
+    COMPRESSION method = CP_NONE;
+    std::string input;                      // compressed bytes read ahead
+    std::size_t used = 0;                   // bytes of input consumed
+    bool at_end = false;                    // the file is read through
+    std::unique_ptr<STATE> state;
+};
+
+#endif
@@ -0,0 +1,408 @@
+// National Scale Volume and Biomass estimators (NSVB) tree list CSV parser
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+#include <immintrin.h>
+#endif
+#include "nsvb_csv.hpp"
+#include "nsvb_timing.hpp"
+#include "nsvb_treefile.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////
+// delimiter scanning
+
+// bit i set where p[i] is a comma or a line end, and in lines where it is a line end
+static inline std::uint64_t delimiters( const char *p, std::uint64_t &lines )
+{
+#if defined( __AVX2__ )
+    const __m256i comma = _mm256_set1_epi8( ',' ), eol = _mm256_set1_epi8( '\n' );
+    std::uint64_t mask = 0;
+    lines = 0;
+    for( int i = 0; i < 2; i++ )
+    {
+        __m256i x = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p + 32 * i ) );
+        __m256i end = _mm256_cmpeq_epi8( x, eol );
+        __m256i hit = _mm256_or_si256( _mm256_cmpeq_epi8( x, comma ), end );
+        mask |= static_cast<std::uint64_t>( static_cast<std::uint32_t>( _mm256_movemask_epi8( hit ) ) ) << ( 32 * i );
+        lines |= static_cast<std::uint64_t>( static_cast<std::uint32_t>( _mm256_movemask_epi8( end ) ) ) << ( 32 * i );
+    }
+    return mask;
+#elif defined( __SSE2__ )
+    const __m128i comma = _mm_set1_epi8( ',' ), eol = _mm_set1_epi8( '\n' );
+    std::uint64_t mask = 0;
+    lines = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        __m128i x = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p + 16 * i ) );
+        __m128i end = _mm_cmpeq_epi8( x, eol );
+        __m128i hit = _mm_or_si128( _mm_cmpeq_epi8( x, comma ), end );
+        mask |= static_cast<std::uint64_t>( _mm_movemask_epi8( hit ) ) << ( 16 * i );
+        lines |= static_cast<std::uint64_t>( _mm_movemask_epi8( end ) ) << ( 16 * i );
+    }
+    return mask;
+#else
+    std::uint64_t mask = 0;
+    lines = 0;
+    for( int i = 0; i < 64; i++ )
+    {
+        mask |= static_cast<std::uint64_t>( p[i] == ',' || p[i] == '\n' ) << i;
+        lines |= static_cast<std::uint64_t>( p[i] == '\n' ) << i;
+    }
+    return mask;
+#endif
+}
+
+const char *csv_scan_isa()
+{
+#if defined( __AVX2__ )
+    return "avx2";
+#elif defined( __SSE2__ )
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+static inline int lowest_bit( std::uint64_t x )
+{
+    return __builtin_ctzll( x );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// fields
+
+static inline bool is_digit( char c )
+{
+    return static_cast<unsigned char>( c - '0' ) < 10;
+}
+
+static inline bool parse_int( const char *p, const char *end, int &value )
+{
+    bool negative = p < end && *p == '-';
+    p += negative;
+    if( p == end )
+        return false;
+
+    std::int64_t x = 0;
+    for( ; p < end; p++ )
+    {
+        if( !is_digit( *p ) || x > std::numeric_limits<int>::max() )
+            return false;
+        x = 10 * x + ( *p - '0' );
+    }
+    x = negative ? -x : x;
+    if( x < std::numeric_limits<int>::min() || x > std::numeric_limits<int>::max() )
+        return false;
+
+    value = static_cast<int>( x );
+    return true;
+}
+
+static inline bool parse_double( const char *begin, const char *end, double &value )
+{
+    // exact powers of ten
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    // [-]digits[.digits]: a mantissa below 2^53 and a power of ten up to 1e22 are exact, so
+    // their quotient is correctly rounded
+    const char *p = begin;
+    bool negative = p < end && *p == '-';
+    p += negative;
+
+    std::uint64_t mantissa = 0;
+    int digits = 0, decimals = 0;
+    for( ; p < end && is_digit( *p ); p++, digits++ )
+        mantissa = 10 * mantissa + ( *p - '0' );
+    if( p < end && *p == '.' )
+        for( p++; p < end && is_digit( *p ); p++, digits++, decimals++ )
+            mantissa = 10 * mantissa + ( *p - '0' );
+
+    if( p == end && digits > 0 && digits <= 15 )
+    {
+        double x = static_cast<double>( mantissa ) / powers[decimals];
+        value = negative ? -x : x;
+        return true;
+    }
+
+    // empty or NA is NaN
+    if( begin == end || ( end - begin == 2 && begin[0] == 'N' && begin[1] == 'A' ) )
+    {
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+
+    auto [last, error] = std::from_chars( begin, end, value );
+    return error == std::errc() && last == end;
+}
+
+// parse an integer field
+bool csv_int( std::string_view s, int &value )
+{
+    return parse_int( s.data(), s.data() + s.size(), value );
+}
+
+// parse a number field
+bool csv_double( std::string_view s, double &value )
+{
+    return parse_double( s.data(), s.data() + s.size(), value );
+}
+
+// the length and up to 7 characters of a field as one key
+static inline std::uint64_t division_key( const char *begin, const char *end )
+{
+    std::uint64_t key = end - begin;
+    for( int shift = 8; begin < end; begin++, shift += 8 )
+        key |= static_cast<std::uint64_t>( static_cast<unsigned char>( *begin ) ) << shift;
+    return key;
+}
+
+struct DIVISION_KEYS {
+    std::uint64_t key[DIV_COUNT];
+
+    DIVISION_KEYS()
+    {
+        for( int d = 0; d < DIV_COUNT; d++ )
+        {
+            const char *name = division_name( static_cast<DIVISION>( d ) );
+            key[d] = division_key( name, name + std::strlen( name ) );
+        }
+    }
+
+    DIVISION find( std::uint64_t k ) const
+    {
+        for( int d = 1; d < DIV_COUNT; d++ )
+            if( key[d] == k )
+                return static_cast<DIVISION>( d );
+        return DIV_NONE;
+    }
+};
+
+static const DIVISION_KEYS division_keys;
+
+// map a division field to its code
+DIVISION csv_division( std::string_view s )
+{
+    if( s.empty() || s.size() > 7 )
+        return DIV_NONE;
+    return division_keys.find( division_key( s.data(), s.data() + s.size() ) );
+}
+
+static bool parse_flag( std::string_view s, std::uint8_t &value )
+{
+    value = s == "1" || s == "TRUE" || s == "true" || s == "T";
+    return value || s.empty() || s == "0" || s == "FALSE" || s == "false" || s == "F" || s == "NA";
+}
+
+// remove quotes, spaces and a carriage return around a field
+static inline void trim_field( const char *&begin, const char *&end )
+{
+    while( begin < end && ( *begin == ' ' || *begin == '"' ) )
+        begin++;
+    while( begin < end && ( end[-1] == ' ' || end[-1] == '"' || end[-1] == '\r' ) )
+        end--;
+}
+
+[[noreturn]] static void parse_error( std::uint64_t at, const std::string &message )
+{
+    throw std::runtime_error( "line at byte " + std::to_string( at ) + ": " + message );
+}
+
+[[noreturn]] static void field_error( std::uint64_t at, int column, const char *begin, const char *end )
+{
+    static const char *names[TC_COUNT] = { "plot", "tree", "fia_spp", "division", "dbh", "tht", "vtotib", "planted", "tpa" };
+    parse_error( at, std::string( "bad " ) + names[column] + " '" + std::string( begin, end ) + "'" );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// TREE_CSV
+
+static_assert( TREE_CSV_COLUMNS == TC_COUNT );
+
+TREE_CSV::TREE_CSV()
+{
+    std::fill( column, column + TC_COUNT, -1 );
+}
+
+TREE_CSV::TREE_CSV( const int field[] )
+{
+    for( int c = 0; c < TC_COUNT; c++ )
+    {
+        column[c] = field[c];
+        fields_needed = std::max( fields_needed, static_cast<std::size_t>( field[c] + 1 ) );
+    }
+    vtotib = field[TC_VTOTIB] >= 0;
+    planted = field[TC_PLANTED] >= 0;
+    tpa = field[TC_TPA] >= 0;
+}
+
+// size every column for rows trees
+static void resize_columns( TREE_COLUMNS &trees, std::size_t rows, bool vtotib, bool planted, bool tpa )
+{
+    trees.plot.resize( rows );
+    trees.tree.resize( rows );
+    trees.fia_spp.resize( rows );
+    trees.division.resize( rows );
+    trees.dbh.resize( rows );
+    trees.height.resize( rows );
+    trees.vtotib.resize( vtotib ? rows : 0 );
+    trees.planted.resize( planted ? rows : 0 );
+    trees.tpa.resize( tpa ? rows : 0 );
+}
+
+// bytes of text indexed at a time
+constexpr std::size_t CSV_SEGMENT = 64u << 10;
+
+// parse whole lines of text into trees
+std::size_t TREE_CSV::parse( std::string_view text, std::uint64_t at, TREE_COLUMNS &trees, std::size_t max_rows ) const
+{
+    const char *base = text.data();
+    std::size_t n = text.size();
+    if( n == 0 || max_rows == 0 )
+        return 0;
+
+    NSVB_TIME_STAGE( STAGE_PARSE );
+
+    // a segment at a time, the positions of its delimiters are found with SIMD compares, then
+    // its whole lines are parsed from the positions (a line cut by the segment end waits for
+    // the next); a last line without a line end gets one at n
+    std::vector<std::size_t> position;
+    position.reserve( CSV_SEGMENT / 2 + 1 );
+    std::size_t next = 0;                       // first position not parsed
+    std::size_t scanned = 0, line = 0;          // text indexed; first byte of the next line
+    std::size_t row = trees.size(), last_row = max_rows < SIZE_MAX - row ? row + max_rows : SIZE_MAX;
+    auto is_line_end = [&]( std::size_t p ) { return p == n || base[p] == '\n'; };
+    struct { std::uint64_t key; DIVISION code; } division_cache = { 0, DIV_NONE };     // key 0: empty
+
+    while( scanned < n )
+    {
+        // index a segment (whole 64 byte chunks, then the rest copied into a padded chunk)
+        position.erase( position.begin(), position.begin() + next );
+        next = 0;
+        std::size_t segment_end = n - scanned <= CSV_SEGMENT ? n : scanned + CSV_SEGMENT, lines = 0;
+        for( std::size_t chunk = scanned; chunk < segment_end; chunk += 64 )
+        {
+            const char *bytes = base + chunk;
+            char tail[64];
+            std::uint64_t ends;
+            if( chunk + 64 > n )
+            {
+                std::memset( tail, ' ', sizeof( tail ) );
+                std::memcpy( tail, bytes, n - chunk );
+                bytes = tail;
+            }
+            for( std::uint64_t mask = delimiters( bytes, ends ); mask; mask &= mask - 1 )
+                position.push_back( chunk + lowest_bit( mask ) );
+            lines += __builtin_popcountll( ends );
+        }
+        scanned = std::min( n, scanned + ( ( segment_end - scanned + 63 ) & ~std::size_t( 63 ) ) );
+        if( scanned == n && base[n - 1] != '\n' )
+        {
+            position.push_back( n );
+            lines++;
+        }
+
+        // room for the lines of the segment
+        std::size_t rows = std::min( last_row, row + lines );
+        resize_columns( trees, rows, vtotib, planted, tpa );
+        int *plot = trees.plot.data(), *tree = trees.tree.data(), *fia_spp = trees.fia_spp.data();
+        DIVISION *division = trees.division.data();
+        double *dbh = trees.dbh.data(), *height = trees.height.data(), *vtotib_ = trees.vtotib.data(), *tpa_ = trees.tpa.data();
+        std::uint8_t *planted_ = trees.planted.data();
+
+        while( row < rows )
+        {
+            // the fields of the next line: [line, position[next]), (position[next], position[next + 1]), ...
+            std::size_t end = next;
+            while( end < position.size() && !is_line_end( position[end] ) )
+                end++;
+            if( end == position.size() )
+                break;
+            std::size_t first = next, fields = end - next + 1;
+            std::uint64_t line_at = at + line;
+            next = end + 1;
+
+            auto field = [&]( int f, const char *&begin, const char *&last ) {
+                begin = base + ( f == 0 ? line : position[first + f - 1] + 1 );
+                last = base + position[first + f];
+                trim_field( begin, last );
+            };
+            const char *begin, *last;
+
+            if( fields == 1 )
+            {
+                field( 0, begin, last );
+                if( begin == last )
+                {
+                    line = position[end] + 1;   // blank line
+                    continue;
+                }
+            }
+            if( fields < fields_needed )
+                parse_error( line_at, "too few fields" );
+
+            field( column[TC_PLOT], begin, last );
+            if( !parse_int( begin, last, plot[row] ) )
+                field_error( line_at, TC_PLOT, begin, last );
+            field( column[TC_TREE], begin, last );
+            if( !parse_int( begin, last, tree[row] ) )
+                field_error( line_at, TC_TREE, begin, last );
+            field( column[TC_FIA_SPP], begin, last );
+            if( !parse_int( begin, last, fia_spp[row] ) )
+                field_error( line_at, TC_FIA_SPP, begin, last );
+            field( column[TC_DIVISION], begin, last );
+            if( last - begin > 7 )
+                division[row] = DIV_NONE;
+            else
+            {
+                // neighbouring trees are mostly in one division
+                std::uint64_t key = division_key( begin, last );
+                if( key != division_cache.key )
+                    division_cache = { key, division_keys.find( key ) };
+                division[row] = division_cache.code;
+            }
+            field( column[TC_DBH], begin, last );
+            if( !parse_double( begin, last, dbh[row] ) )
+                field_error( line_at, TC_DBH, begin, last );
+            field( column[TC_HEIGHT], begin, last );
+            if( !parse_double( begin, last, height[row] ) )
+                field_error( line_at, TC_HEIGHT, begin, last );
+            if( vtotib )
+            {
+                field( column[TC_VTOTIB], begin, last );
+                if( !parse_double( begin, last, vtotib_[row] ) )
+                    field_error( line_at, TC_VTOTIB, begin, last );
+            }
+            if( planted )
+            {
+                field( column[TC_PLANTED], begin, last );
+                if( !parse_flag( std::string_view( begin, last - begin ), planted_[row] ) )
+                    field_error( line_at, TC_PLANTED, begin, last );
+            }
+            if( tpa )
+            {
+                field( column[TC_TPA], begin, last );
+                if( !parse_double( begin, last, tpa_[row] ) )
+                    field_error( line_at, TC_TPA, begin, last );
+            }
+
+            line = position[end] + 1;
+            row++;
+        }
+
+        resize_columns( trees, row, vtotib, planted, tpa );
+        if( row == last_row )
+            return std::min( line, n );
+    }
+
+    return n;
+}
@@ -0,0 +1,60 @@
+// National Scale Volume and Biomass estimators (NSVB) tree list CSV parser
+//
+// Parses the lines of a CSV tree list (nsvb_treefile.hpp) straight into TREE_COLUMNS. The text
+// is scanned 64 bytes at a time for commas and line ends with SIMD compares (AVX2 when the
+// build targets it, SSE2 on other x86-64 builds, a scalar loop elsewhere), giving a bit mask
+// whose set bits are walked to cut fields, so no byte is examined twice and no line or field
+// strings are built. Fields are parsed by their column: integers by a digit loop, decimals
+// of up to 15 significant digits exactly by one division by a power of ten (the correctly
+// rounded result, as from_chars), other numbers by std::from_chars, and divisions by
+// comparing a packed 8 byte key against the division names.
+//
+// Values are the same as parsing each field with std::from_chars and division_code().
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_CSV_HPP
+#define NSVB_CSV_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "nsvb_plan.hpp"
+
+struct TREE_COLUMNS;
+
+// columns of a tree list (TREE_FILE_COLUMN)
+constexpr int TREE_CSV_COLUMNS = 9;
+
+// parse an integer field (optional '-', digits)
+bool csv_int( std::string_view s, int &value );
+
+// parse a number field as std::from_chars (the whole field must be used); empty or NA is NaN
+bool csv_double( std::string_view s, double &value );
+
+// map a division field to its code (DIV_NONE if not recognized)
+DIVISION csv_division( std::string_view s );
+
+// SIMD instructions used to scan for delimiters ("avx2", "sse2" or "scalar")
+const char *csv_scan_isa();
+
+class TREE_CSV {
+public:
+    TREE_CSV();
+
+    // field: the field of each column in TREE_FILE_COLUMN order (-1: absent)
+    explicit TREE_CSV( const int field[] );
+
+    // parse whole lines of text into trees, stopping after max_rows trees; returns the bytes
+    // parsed. Blank lines are skipped and fields may be quoted or padded with spaces. Errors
+    // throw std::runtime_error naming the byte offset (from at) of the line.
+    std::size_t parse( std::string_view text, std::uint64_t at, TREE_COLUMNS &trees, std::size_t max_rows = SIZE_MAX ) const;
+
+private:
+    int column[TREE_CSV_COLUMNS];           // field of each column (TREE_FILE_COLUMN order; -1: absent)
+    std::size_t fields_needed = 0;
+    bool vtotib = false, planted = false, tpa = false;
+};
+
+#endif
@@ -0,0 +1,273 @@
+// National Scale Volume and Biomass estimators (NSVB) result formatting
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "nsvb_format.hpp"
+#include "nsvb_green.hpp"
+#include "nsvb_timing.hpp"
+
+static const char *format_names[] = { "csv", "tsv", "ndjson" };
+
+static const char *tree_fields[] = { "plot", "tree", "fia_spp", "division", "volib", "volob", "wood", "bark", "branch",
+                                     "foliage", "total", "above_ground_biomass", "green_tons" };
+static const char *plot_fields[] = { "plot", "trees", "tpa", "volib", "volob", "green_tons", "wood", "bark", "branch",
+                                     "foliage", "total", "above_ground_biomass" };
+
+constexpr int TREE_FIELDS = sizeof( tree_fields ) / sizeof( tree_fields[0] );
+constexpr int PLOT_FIELDS = sizeof( plot_fields ) / sizeof( plot_fields[0] );
+
+// room for a number: shortest forms take at most 24 characters, fixed forms up to 17 decimals
+// of numbers below 1e45 (larger ones are written in their shortest form)
+constexpr std::size_t NUMBER_MAX = 64;
+
+// format named csv, tsv or ndjson
+OUTPUT_FORMAT output_format( std::string_view name )
+{
+    for( int f = OF_CSV; f <= OF_NDJSON; f++ )
+        if( name == format_names[f] )
+            return static_cast<OUTPUT_FORMAT>( f );
+    throw std::runtime_error( "unknown output format " + std::string( name ) );
+}
+
+const char *output_format_name( OUTPUT_FORMAT format )
+{
+    return format_names[format];
+}
+
+static std::string header( const char *const fields[], int count, const OUTPUT_OPTIONS &options )
+{
+    if( options.format == OF_NDJSON )
+        return "";
+
+    std::string line;
+    for( int f = 0; f < count; f++ )
+    {
+        if( f )
+            line += options.format == OF_TSV ? '\t' : ',';
+        line += fields[f];
+    }
+    return line + "\n";
+}
+
+std::string tree_results_header( const OUTPUT_OPTIONS &options )
+{
+    return header( tree_fields, TREE_FIELDS, options );
+}
+
+std::string plot_totals_header( const OUTPUT_OPTIONS &options )
+{
+    return header( plot_fields, PLOT_FIELDS, options );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// lines
+
+// text around the fields of a line
+struct LINE_LAYOUT {
+    std::string before[TREE_FIELDS];        // separator, or in JSON the separator and key
+    std::string end;
+    std::size_t longest = 0;                // characters of a line besides its fields
+    bool json = false;
+
+    LINE_LAYOUT( const char *const fields[], int count, const OUTPUT_OPTIONS &options ) : json( options.format == OF_NDJSON )
+    {
+        for( int f = 0; f < count; f++ )
+        {
+            if( json )
+                before[f] = std::string( f ? ",\"" : "{\"" ) + fields[f] + "\":";
+            else if( f )
+                before[f].assign( 1, options.format == OF_TSV ? '\t' : ',' );
+            longest += before[f].size();
+        }
+        end = json ? "}\n" : "\n";
+        longest += end.size();
+    }
+};
+
+static inline char *put( char *p, const std::string &s )
+{
+    std::memcpy( p, s.data(), s.size() );
+    return p + s.size();
+}
+
+static inline char *put_integer( char *p, long long x )
+{
+    return std::to_chars( p, p + NUMBER_MAX, x ).ptr;
+}
+
+static inline char *put_number( char *p, double x, const OUTPUT_OPTIONS &options, bool json )
+{
+    if( std::isnan( x ) || ( json && std::isinf( x ) ) )
+    {
+        const char *text = json ? "null" : "NA";
+        std::size_t n = json ? 4 : 2;
+        std::memcpy( p, text, n );
+        return p + n;
+    }
+    if( options.precision >= 0 )
+    {
+        auto [end, error] = std::to_chars( p, p + NUMBER_MAX, x, std::chars_format::fixed, std::min( options.precision, 17 ) );
+        if( error == std::errc() )
+            return end;
+    }
+    return std::to_chars( p, p + NUMBER_MAX, x ).ptr;
+}
+
+// append tree results
+void format_trees( const TREE_COLUMNS &trees, const std::vector<double> results[8], std::string &out, const OUTPUT_OPTIONS &options )
+{
+    LINE_LAYOUT layout( tree_fields, TREE_FIELDS, options );
+    std::size_t line_max = layout.longest + TREE_FIELDS * NUMBER_MAX;
+
+    // lines are written into the string in runs of up to 256 (the string keeps its capacity
+    // from block to block)
+    for( std::size_t first = 0; first < trees.size(); first += 256 )
+    {
+        std::size_t last = std::min( trees.size(), first + 256 ), at = out.size();
+        double green[256];
+        compute_green_tons( last - first, &trees.fia_spp[first], &results[1][first], &results[0][first], green );
+        out.resize_and_overwrite( at + ( last - first ) * line_max, [&]( char *text, std::size_t ) {
+            char *p = text + at;
+            for( std::size_t i = first; i < last; i++ )
+            {
+                p = put( p, layout.before[0] );
+                p = put_integer( p, trees.plot[i] );
+                p = put( p, layout.before[1] );
+                p = put_integer( p, trees.tree[i] );
+                p = put( p, layout.before[2] );
+                p = put_integer( p, trees.fia_spp[i] );
+                p = put( p, layout.before[3] );
+                const char *division = division_name( trees.division[i] );
+                std::size_t length = std::strlen( division );
+                if( layout.json )
+                    *p++ = '"';
+                std::memcpy( p, division, length );
+                p += length;
+                if( layout.json )
+                    *p++ = '"';
+                for( int c = 0; c < 8; c++ )
+                {
+                    p = put( p, layout.before[4 + c] );
+                    p = put_number( p, results[c][i], options, layout.json );
+                }
+                p = put( p, layout.before[12] );
+                p = put_number( p, green[i - first], options, layout.json );
+                p = put( p, layout.end );
+            }
+            return static_cast<std::size_t>( p - text );
+        } );
+    }
+}
+
+// append plot totals
+void format_plots( const std::vector<PLOT_TOTALS> &plots, std::string &out, const OUTPUT_OPTIONS &options )
+{
+    LINE_LAYOUT layout( plot_fields, PLOT_FIELDS, options );
+    std::size_t at = out.size();
+
+    out.resize_and_overwrite( at + plots.size() * ( layout.longest + PLOT_FIELDS * NUMBER_MAX ), [&]( char *text, std::size_t ) {
+        char *p = text + at;
+        for( const PLOT_TOTALS &t : plots )
+        {
+            p = put( p, layout.before[0] );
+            p = put_integer( p, t.plot );
+            p = put( p, layout.before[1] );
+            p = put_integer( p, static_cast<long long>( t.trees ) );
+            const double values[] = { t.tpa, t.volib, t.volob, t.green_tons, t.biomass.wood, t.biomass.bark, t.biomass.branch,
+                                      t.biomass.foliage, t.biomass.total, t.biomass.above_ground_biomass };
+            for( int c = 0; c < PLOT_FIELDS - 2; c++ )
+            {
+                p = put( p, layout.before[2 + c] );
+                p = put_number( p, values[c], options, layout.json );
+            }
+            p = put( p, layout.end );
+        }
+        return static_cast<std::size_t>( p - text );
+    } );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// RESULT_WRITER
+
+RESULT_WRITER::RESULT_WRITER( int file, std::size_t buffer_bytes )
+    : fd( file ), name( "file descriptor " + std::to_string( file ) ), buffer( std::max<std::size_t>( buffer_bytes, 1 ) )
+{
+}
+
+RESULT_WRITER::RESULT_WRITER( const std::string &path, std::size_t buffer_bytes )
+    : fd( ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 ) ), owned( true ), name( path ),
+      buffer( std::max<std::size_t>( buffer_bytes, 1 ) )
+{
+    if( fd < 0 )
+        throw std::runtime_error( "cannot create " + path );
+}
+
+RESULT_WRITER::~RESULT_WRITER()
+{
+    try {
+        close();
+    } catch( ... ) {
+    }
+}
+
+// write(2) until every byte is out
+void RESULT_WRITER::write_out( const char *data, std::size_t size )
+{
+    while( size > 0 )
+    {
+        ssize_t n = ::write( fd, data, size );
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+            throw std::runtime_error( "cannot write " + name + ": " + std::strerror( errno ) );
+        data += n;
+        size -= static_cast<std::size_t>( n );
+    }
+}
+
+void RESULT_WRITER::write( std::string_view data )
+{
+    NSVB_TIME_STAGE( STAGE_WRITE );
+
+    total += data.size();
+    if( used + data.size() > buffer.size() )
+    {
+        flush();
+        if( data.size() >= buffer.size() )
+        {
+            write_out( data.data(), data.size() );
+            return;
+        }
+    }
+    std::memcpy( buffer.data() + used, data.data(), data.size() );
+    used += data.size();
+}
+
+void RESULT_WRITER::flush()
+{
+    std::size_t n = used;
+    used = 0;
+    write_out( buffer.data(), n );
+}
+
+void RESULT_WRITER::close()
+{
+    if( fd < 0 )
+        return;
+    flush();
+    if( owned )
+    {
+        int file = fd;
+        fd = -1;
+        if( ::close( file ) )
+            throw std::runtime_error( "cannot close " + name );
+    }
+}
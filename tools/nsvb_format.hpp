@@ -0,0 +1,90 @@
+// National Scale Volume and Biomass estimators (NSVB) result formatting
+//
+// Formats tree results and plot totals as CSV, TSV or newline delimited JSON (one object per
+// line) with std::to_chars: numbers are written in their shortest form that reads back to the
+// same double, or with a fixed number of decimals. Blocks of lines are formatted into a
+// reused std::string (sized for the longest possible lines, then cut to the text written), and
+// RESULT_WRITER sends them to a file descriptor with write(2) through a large buffer.
+//
+// Undefined values are NA in CSV and TSV and null in JSON; infinities are written as in CSV
+// ("inf") and as null in JSON.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_FORMAT_HPP
+#define NSVB_FORMAT_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nsvb_compress.hpp"
+#include "nsvb_rollup.hpp"
+#include "nsvb_treefile.hpp"
+
+enum OUTPUT_FORMAT { OF_CSV = 0, OF_TSV, OF_NDJSON };
+
+struct OUTPUT_OPTIONS {
+    OUTPUT_FORMAT format = OF_CSV;
+    int precision = -1;                     // decimals of every number (-1: shortest round trip)
+    COMPRESSION compression = CP_NONE;      // of result files, block by block (nsvb_compress.hpp)
+    int level = 0;                          // compression level (0: the library's default)
+};
+
+// format named csv, tsv or ndjson (throws std::runtime_error for another name)
+OUTPUT_FORMAT output_format( std::string_view name );
+
+// name of a format, also the extension of its files
+const char *output_format_name( OUTPUT_FORMAT format );
+
+// first line of tree results and of plot totals ("" for NDJSON)
+std::string tree_results_header( const OUTPUT_OPTIONS &options );
+std::string plot_totals_header( const OUTPUT_OPTIONS &options );
+
+// append tree results: plot, tree, fia_spp, division, the BATCH_RESULT columns in declaration
+// order (volib .. above_ground_biomass) and green tons (batch compute_green_tons() of nsvb_green.hpp)
+void format_trees( const TREE_COLUMNS &trees, const std::vector<double> results[8], std::string &out, const OUTPUT_OPTIONS &options = {} );
+
+// append plot totals: plot, trees, tpa, volib, volob, green_tons and the biomass components
+void format_plots( const std::vector<PLOT_TOTALS> &plots, std::string &out, const OUTPUT_OPTIONS &options = {} );
+
+// buffered output to a file descriptor
+class RESULT_WRITER {
+public:
+    // write to fd (left open)
+    explicit RESULT_WRITER( int fd, std::size_t buffer_bytes = 1u << 20 );
+
+    // create or truncate path and write to it
+    explicit RESULT_WRITER( const std::string &path, std::size_t buffer_bytes = 1u << 20 );
+
+    RESULT_WRITER( const RESULT_WRITER & ) = delete;
+    RESULT_WRITER &operator=( const RESULT_WRITER & ) = delete;
+
+    // flushes, ignoring errors (call close() to see them)
+    ~RESULT_WRITER();
+
+    // append data; blocks larger than the buffer are written directly
+    void write( std::string_view data );
+
+    // write the buffer out
+    void flush();
+
+    // flush and close a file opened by the writer
+    void close();
+
+    // bytes written, buffered or not
+    std::size_t bytes() const { return total; }
+
+private:
+    void write_out( const char *data, std::size_t size );
+
+    int fd = -1;
+    bool owned = false;
+    std::string name;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    std::size_t total = 0;
+};
+
+#endif
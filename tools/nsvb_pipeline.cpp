@@ -0,0 +1,279 @@
+// National Scale Volume and Biomass estimators (NSVB) streaming pipeline
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "nsvb_pipeline.hpp"
+#include "nsvb_queue.hpp"
+
+static const char *stage_names[PS_COUNT] = { "read", "parse", "evaluate", "format", "write" };
+
+void PLOT_MERGE::add( const PLOT_TOTALS &p )
+{
+    auto [it, added] = index.emplace( p.plot, plots.size() );
+    if( added )
+        plots.push_back( p );
+    else
+        add_totals( plots[it->second], p );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// pipeline
+
+// a block of trees passing through the stages
+struct PIPELINE_BLOCK {
+    std::uint64_t sequence = 0;             // position in the file
+    std::uint64_t at = 0;                   // file offset of the CSV text
+    std::string text;                       // CSV text (binary files are read into trees)
+    TREE_COLUMNS trees;
+    std::vector<double> results[8];         // BATCH_RESULT columns
+    std::vector<PLOT_TOTALS> plots;
+    std::string output;                     // formatted (and compressed) tree results
+    std::string packed;                     // compression buffer
+};
+
+using BLOCK_PTR = std::unique_ptr<PIPELINE_BLOCK>;
+
+// thrown through the reader when the pipeline is aborted
+struct PIPELINE_ABORTED {};
+
+static double seconds_since( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// evaluate a shard of a tree file
+PIPELINE_STATS run_pipeline( const TREE_FILE &file, const SHARD &shard, RESULT_WRITER *trees, PLOT_MERGE *plots, const PIPELINE_OPTIONS &options )
+{
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned parsers = std::max( 1u, options.parsers ), evaluators = std::max( 1u, options.evaluators ),
+             formatters = std::max( 1u, options.formatters ), depth = std::max( 1u, options.depth );
+
+    // every queue full plus one block in each worker
+    std::size_t max_blocks = 4 * depth + parsers + evaluators + formatters + 2;
+
+    std::atomic<bool> abort{ false };
+    STAGE_QUEUE<BLOCK_PTR> parse_queue( depth, 1, parsers, abort );
+    STAGE_QUEUE<BLOCK_PTR> evaluate_queue( depth, parsers, evaluators, abort );
+    STAGE_QUEUE<BLOCK_PTR> format_queue( depth, evaluators, formatters, abort );
+    STAGE_QUEUE<BLOCK_PTR> write_queue( depth, formatters, 1, abort );
+    STAGE_QUEUE<BLOCK_PTR> free_queue( max_blocks, 1, 1, abort );
+
+    PIPELINE_STATS stats;
+    std::mutex stats_mutex;
+    std::exception_ptr error;
+
+    auto fail = [&] {
+        std::lock_guard<std::mutex> lock( stats_mutex );
+        if( !error )
+            error = std::current_exception();
+        abort = true;
+    };
+    auto add_busy = [&]( PIPELINE_STAGE stage, double s ) {
+        std::lock_guard<std::mutex> lock( stats_mutex );
+        stats.busy[stage] += s;
+    };
+
+    // a middle stage: pop, work, push
+    auto stage = [&]( PIPELINE_STAGE name, STAGE_QUEUE<BLOCK_PTR> &in, STAGE_QUEUE<BLOCK_PTR> &out, auto work ) {
+        double busy = 0.0;
+        try {
+            BLOCK_PTR block;
+            while( in.pop( block ) )
+            {
+                auto begin = std::chrono::steady_clock::now();
+                work( *block );
+                busy += seconds_since( begin );
+                if( !out.push( block ) )
+                    break;
+            }
+        } catch( ... ) {
+            fail();
+        }
+        out.producer_done();
+        add_busy( name, busy );
+    };
+
+    // read: cut the shard into blocks, reusing blocks the writer has finished with
+    std::size_t created = 0;
+    std::uint64_t sequence = 0;
+    double read_busy = 0.0;
+    auto next_block = [&]() -> BLOCK_PTR {
+        BLOCK_PTR block;
+        if( created < max_blocks )
+        {
+            created++;
+            return std::make_unique<PIPELINE_BLOCK>();
+        }
+        if( !free_queue.pop( block ) )
+            throw PIPELINE_ABORTED();
+        return block;
+    };
+    auto reader = [&] {
+        try {
+            auto begin = std::chrono::steady_clock::now();
+            auto send = [&]( BLOCK_PTR &block ) {
+                read_busy += seconds_since( begin );
+                block->sequence = sequence++;
+                if( !parse_queue.push( block ) )
+                    throw PIPELINE_ABORTED();
+                begin = std::chrono::steady_clock::now();
+            };
+
+            if( file.binary() )
+                file.read( shard, options.block_rows, [&]( TREE_COLUMNS &columns ) {
+                    BLOCK_PTR block = next_block();
+                    std::swap( block->trees, columns );
+                    send( block );
+                } );
+            else
+                file.read_text( shard, options.block_bytes, [&]( std::string &text, std::uint64_t at ) {
+                    BLOCK_PTR block = next_block();
+                    block->text.swap( text );
+                    block->at = at;
+                    send( block );
+                } );
+            read_busy += seconds_since( begin );
+        } catch( const PIPELINE_ABORTED & ) {
+        } catch( ... ) {
+            fail();
+        }
+        parse_queue.producer_done();
+        add_busy( PS_READ, read_busy );
+    };
+
+    auto parse = [&]( PIPELINE_BLOCK &block ) {
+        if( file.binary() )
+            return;
+        block.trees.clear();
+        file.parse( block.text, block.at, block.trees );
+    };
+
+    // trees wanted one by one and by plot are evaluated once, the plot totals summed from the results
+    auto evaluate = [&]( PIPELINE_BLOCK &block ) {
+        TREE_BATCH batch = block.trees.batch();
+        const double *tpa = block.trees.tpa.empty() ? nullptr : block.trees.tpa.data();
+
+        if( !trees )
+        {
+            if( plots )
+                block.plots = rollup_plots( batch, block.trees.plot.data(), tpa, options.threads );
+            return;
+        }
+
+        BATCH_RESULT result;
+        double **to[] = { &result.volib, &result.volob, &result.wood, &result.bark, &result.branch, &result.foliage, &result.total,
+                          &result.above_ground_biomass };
+        for( int c = 0; c < 8; c++ )
+        {
+            block.results[c].resize( block.trees.size() );
+            *to[c] = block.results[c].data();
+        }
+        BATCH_OPTIONS batch_options;
+        batch_options.threads = options.threads;
+        evaluate_batch( batch, result, batch_options );
+
+        if( plots )
+            block.plots = rollup_plots( batch, result, block.trees.plot.data(), tpa, options.threads );
+    };
+
+    auto format = [&]( PIPELINE_BLOCK &block, BLOCK_COMPRESSOR &compressor ) {
+        block.output.clear();
+        if( trees )
+        {
+            format_trees( block.trees, block.results, block.output, options.output );
+            if( options.output.compression != CP_NONE )
+            {
+                compressor.compress( block.output, block.packed );
+                block.output.swap( block.packed );
+            }
+        }
+    };
+
+    // write: restore file order, write and merge, then return the block to the reader
+    auto writer = [&] {
+        double busy = 0.0;
+        try {
+            std::vector<BLOCK_PTR> waiting;         // blocks ahead of the next in sequence
+            std::uint64_t next = 0;
+            BLOCK_PTR block;
+            while( write_queue.pop( block ) )
+            {
+                auto begin = std::chrono::steady_clock::now();
+                waiting.push_back( std::move( block ) );
+                for( bool found = true; found; )
+                {
+                    found = false;
+                    for( auto &w : waiting )
+                        if( w && w->sequence == next )
+                        {
+                            if( trees )
+                                trees->write( w->output );
+                            if( plots )
+                                for( const PLOT_TOTALS &p : w->plots )
+                                    plots->add( p );
+                            stats.blocks++;
+                            stats.trees += w->trees.size();
+                            next++;
+                            found = true;
+                            if( !free_queue.push( w ) )
+                                throw PIPELINE_ABORTED();
+                        }
+                    waiting.erase( std::remove( waiting.begin(), waiting.end(), nullptr ), waiting.end() );
+                }
+                busy += seconds_since( begin );
+            }
+        } catch( const PIPELINE_ABORTED & ) {
+        } catch( ... ) {
+            fail();
+        }
+        free_queue.producer_done();
+        add_busy( PS_WRITE, busy );
+    };
+
+    // each format worker compresses with its own library state
+    std::vector<std::unique_ptr<BLOCK_COMPRESSOR>> compressors;
+    for( unsigned i = 0; i < formatters; i++ )
+        compressors.push_back( std::make_unique<BLOCK_COMPRESSOR>( options.output.compression, options.output.level ) );
+
+    std::vector<std::thread> workers;
+    workers.emplace_back( reader );
+    for( unsigned i = 0; i < parsers; i++ )
+        workers.emplace_back( [&] { stage( PS_PARSE, parse_queue, evaluate_queue, parse ); } );
+    for( unsigned i = 0; i < evaluators; i++ )
+        workers.emplace_back( [&] { stage( PS_EVALUATE, evaluate_queue, format_queue, evaluate ); } );
+    for( unsigned i = 0; i < formatters; i++ )
+        workers.emplace_back( [&, i] {
+            stage( PS_FORMAT, format_queue, write_queue, [&]( PIPELINE_BLOCK &block ) { format( block, *compressors[i] ); } );
+        } );
+    writer();
+    for( auto &w : workers )
+        w.join();
+
+    if( error )
+        std::rethrow_exception( error );
+
+    STAGE_QUEUE<BLOCK_PTR> *queues[PS_COUNT] = { &parse_queue, &evaluate_queue, &format_queue, &write_queue, &free_queue };
+    for( int s = 0; s < PS_COUNT; s++ )
+        stats.stalls[s] = queues[s]->stalls();
+    stats.seconds = seconds_since( start );
+
+    return stats;
+}
+
+// write pipeline statistics
+std::ostream &operator<<( std::ostream &os, const PIPELINE_STATS &stats )
+{
+    os << "pipeline: " << stats.trees << " trees in " << stats.blocks << " blocks, " << stats.seconds << " s";
+    for( int s = 0; s < PS_COUNT; s++ )
+        os << "; " << stage_names[s] << " " << stats.busy[s] << " s busy, " << stats.stalls[s] << " stalls";
+    return os;
+}
@@ -0,0 +1,70 @@
+// National Scale Volume and Biomass estimators (NSVB) streaming pipeline
+//
+// Evaluates a shard of a tree file with overlapped stages connected by bounded lock-free
+// queues (nsvb_queue.hpp):
+//
+//   read (1) -> parse (parsers) -> evaluate (evaluators) -> format (formatters) -> write (1)
+//
+// The reader cuts the file into blocks of whole lines (or rows of a binary file), workers of the
+// middle stages take blocks in any order, and the writer puts them back in file order before
+// writing tree results and merging plot totals, so output does not depend on the worker counts.
+// With output compression each format worker also compresses its blocks (one member or frame
+// per block), so compression runs in parallel off the writer.
+// Blocks are recycled from the writer to the reader and at most a fixed number exist, so a full
+// queue stops the stages before it (backpressure) and memory stays bounded: a long tree list
+// is processed at the speed of the slowest stage rather than the sum of the stages.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_PIPELINE_HPP
+#define NSVB_PIPELINE_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nsvb_format.hpp"
+#include "nsvb_rollup.hpp"
+#include "nsvb_treefile.hpp"
+
+struct PIPELINE_OPTIONS {
+    unsigned parsers = 1;                   // workers of each stage
+    unsigned evaluators = 1;
+    unsigned formatters = 1;
+    unsigned threads = 1;                   // evaluate_batch() threads of an evaluator (0: one per hardware thread)
+    unsigned depth = 4;                     // blocks queued between two stages
+    std::size_t block_bytes = 1u << 20;     // CSV text per block
+    std::size_t block_rows = 1u << 16;      // trees per block of a binary file
+    OUTPUT_OPTIONS output;                  // format and compression of tree results
+};
+
+// stage names in pipeline order
+enum PIPELINE_STAGE { PS_READ = 0, PS_PARSE, PS_EVALUATE, PS_FORMAT, PS_WRITE, PS_COUNT };
+
+struct PIPELINE_STATS {
+    std::size_t blocks = 0;
+    std::size_t trees = 0;
+    double seconds = 0.0;                   // wall time
+    double busy[PS_COUNT] = {};             // seconds spent working per stage (summed over its workers)
+    std::size_t stalls[PS_COUNT] = {};      // pushes of a stage that waited for room in the next queue
+};
+
+// plot totals merged in order of first appearance
+struct PLOT_MERGE {
+    std::vector<PLOT_TOTALS> plots;
+    std::unordered_map<int,std::size_t> index;
+
+    void add( const PLOT_TOTALS &p );
+};
+
+// evaluate a shard of a tree file, writing tree results in file order to trees (nullptr: none)
+// and adding plot totals to plots (nullptr: none)
+PIPELINE_STATS run_pipeline( const TREE_FILE &file, const SHARD &shard, RESULT_WRITER *trees, PLOT_MERGE *plots,
+                             const PIPELINE_OPTIONS &options = {} );
+
+// write pipeline statistics
+std::ostream &operator<<( std::ostream &os, const PIPELINE_STATS &stats );
+
+#endif
@@ -0,0 +1,220 @@
+// National Scale Volume and Biomass estimators (NSVB) bounded lock-free queues
+//
+// SPSC_QUEUE is a ring for one producer and one consumer thread; MPMC_QUEUE (a ring of cells
+// with sequence numbers) allows any number of each. Both hold a fixed number of items and never
+// allocate after construction. STAGE_QUEUE connects two pipeline stages: it uses the SPSC ring
+// when each side has one worker, waits (spinning, then yielding, then sleeping) while the queue
+// is full or empty, which is the backpressure between stages, and ends when every producer has
+// finished or the pipeline is aborted.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_QUEUE_HPP
+#define NSVB_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// capacity rounded up to a power of two
+inline std::size_t queue_capacity( std::size_t capacity )
+{
+    std::size_t c = 2;
+    while( c < capacity )
+        c *= 2;
+    return c;
+}
+
+template <typename T>
+class SPSC_QUEUE {
+public:
+    explicit SPSC_QUEUE( std::size_t capacity ) : mask( queue_capacity( capacity ) - 1 ), slots( new T[mask + 1] ) {}
+
+    // move item in unless the queue is full
+    bool try_push( T &item )
+    {
+        std::size_t t = tail.load( std::memory_order_relaxed );
+        if( t - head.load( std::memory_order_acquire ) > mask )
+            return false;
+
+        slots[t & mask] = std::move( item );
+        tail.store( t + 1, std::memory_order_release );
+        return true;
+    }
+
+    // move the oldest item out unless the queue is empty
+    bool try_pop( T &item )
+    {
+        std::size_t h = head.load( std::memory_order_relaxed );
+        if( h == tail.load( std::memory_order_acquire ) )
+            return false;
+
+        item = std::move( slots[h & mask] );
+        head.store( h + 1, std::memory_order_release );
+        return true;
+    }
+
+private:
+    const std::size_t mask;
+    std::unique_ptr<T[]> slots;
+    alignas( 64 ) std::atomic<std::size_t> head{ 0 };     // next item popped
+    alignas( 64 ) std::atomic<std::size_t> tail{ 0 };     // next item pushed
+};
+
+template <typename T>
+class MPMC_QUEUE {
+public:
+    explicit MPMC_QUEUE( std::size_t capacity ) : mask( queue_capacity( capacity ) - 1 ), cells( new CELL[mask + 1] )
+    {
+        for( std::size_t i = 0; i <= mask; i++ )
+            cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+
+    // move item in unless the queue is full
+    bool try_push( T &item )
+    {
+        std::size_t position = tail.load( std::memory_order_relaxed );
+        for( ;; )
+        {
+            CELL &cell = cells[position & mask];
+            std::intptr_t ahead = static_cast<std::intptr_t>( cell.sequence.load( std::memory_order_acquire ) )
+                                - static_cast<std::intptr_t>( position );
+            if( ahead == 0 )
+            {
+                if( tail.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+                {
+                    cell.value = std::move( item );
+                    cell.sequence.store( position + 1, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if( ahead < 0 )
+                return false;
+            else
+                position = tail.load( std::memory_order_relaxed );
+        }
+    }
+
+    // move the oldest item out unless the queue is empty
+    bool try_pop( T &item )
+    {
+        std::size_t position = head.load( std::memory_order_relaxed );
+        for( ;; )
+        {
+            CELL &cell = cells[position & mask];
+            std::intptr_t ahead = static_cast<std::intptr_t>( cell.sequence.load( std::memory_order_acquire ) )
+                                - static_cast<std::intptr_t>( position + 1 );
+            if( ahead == 0 )
+            {
+                if( head.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+                {
+                    item = std::move( cell.value );
+                    cell.sequence.store( position + mask + 1, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if( ahead < 0 )
+                return false;
+            else
+                position = head.load( std::memory_order_relaxed );
+        }
+    }
+
+private:
+    struct CELL {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<CELL[]> cells;
+    alignas( 64 ) std::atomic<std::size_t> head{ 0 };
+    alignas( 64 ) std::atomic<std::size_t> tail{ 0 };
+};
+
+// wait between attempts: spin, then yield, then sleep
+class BACKOFF {
+public:
+    void wait()
+    {
+        if( ++tries < 64 )
+            return;
+        if( tries < 256 )
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+    }
+
+    bool waited() const { return tries > 0; }
+
+private:
+    unsigned tries = 0;
+};
+
+// queue between two pipeline stages
+template <typename T>
+class STAGE_QUEUE {
+public:
+    // producers and consumers: workers on each side; abort: set when the pipeline fails
+    STAGE_QUEUE( std::size_t capacity, unsigned producers, unsigned consumers, const std::atomic<bool> &abort )
+        : open_producers( producers ), aborted( abort )
+    {
+        if( producers == 1 && consumers == 1 )
+            spsc = std::make_unique<SPSC_QUEUE<T>>( capacity );
+        else
+            mpmc = std::make_unique<MPMC_QUEUE<T>>( capacity );
+    }
+
+    // move item in, waiting while the queue is full; false when the pipeline was aborted
+    bool push( T &item )
+    {
+        BACKOFF backoff;
+        while( !( spsc ? spsc->try_push( item ) : mpmc->try_push( item ) ) )
+        {
+            if( aborted.load( std::memory_order_relaxed ) )
+                return false;
+            backoff.wait();
+        }
+        if( backoff.waited() )
+            full_waits.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    // move an item out, waiting while the queue is empty; false when every producer has finished
+    // and the queue is empty, or the pipeline was aborted
+    bool pop( T &item )
+    {
+        BACKOFF backoff;
+        for( ;; )
+        {
+            if( spsc ? spsc->try_pop( item ) : mpmc->try_pop( item ) )
+                return true;
+            if( aborted.load( std::memory_order_relaxed ) )
+                return false;
+            // check again after seeing the last producer finish, as it may have pushed just before
+            if( open_producers.load( std::memory_order_acquire ) == 0 )
+                return spsc ? spsc->try_pop( item ) : mpmc->try_pop( item );
+            backoff.wait();
+        }
+    }
+
+    // a producer has pushed its last item
+    void producer_done() { open_producers.fetch_sub( 1, std::memory_order_acq_rel ); }
+
+    // times a push waited for room
+    std::size_t stalls() const { return full_waits.load( std::memory_order_relaxed ); }
+
+private:
+    std::unique_ptr<SPSC_QUEUE<T>> spsc;
+    std::unique_ptr<MPMC_QUEUE<T>> mpmc;
+    std::atomic<unsigned> open_producers;
+    std::atomic<std::size_t> full_waits{ 0 };
+    const std::atomic<bool> &aborted;
+};
+
+#endif
@@ -0,0 +1,112 @@
+// National Scale Volume and Biomass estimators (NSVB) sharded tree file runner
+//
+// usage: nsvb_run [-shards N] [-jobs J] [pipeline options] [-no-trees] [-no-plots] input output
+//        nsvb_run -shard K -shards N [pipeline options] [-no-trees] [-no-plots] input output
+//        nsvb_run -merge -shards N [output options] [-no-trees] [-no-plots] output
+//        nsvb_run -convert input output
+//
+// The first form evaluates input (CSV or binary, see nsvb_treefile.hpp) in N shards with J local
+// worker processes and writes output.trees.csv and output.plots.csv (see nsvb_shard.hpp). On a
+// cluster, run the second form once per shard K = 0 .. N-1 (e.g. as a job array on a shared
+// filesystem), then the third. -convert writes a CSV tree list as a binary tree file.
+//
+// pipeline options (see nsvb_pipeline.hpp): -threads T (evaluate_batch() threads), -batch B
+// (rows per binary block), -block BYTES (CSV text per block), -parsers P, -evaluators E,
+// -formatters F (workers per stage), -depth D (blocks queued between stages) and -stats (write
+// stage busy time and stalls to stderr).
+//
+// output options (see nsvb_format.hpp, also part of the pipeline options; pass the same ones
+// to -merge): -format csv|tsv|ndjson (output.trees.tsv etc. for the others) and -precision N
+// (N decimals in every number; by default the shortest text reading back to the same double),
+// -compress gzip|zstd|lz4 (compress results block by block on the format workers, adding .gz,
+// .zst or .lz4 to the file names) and -level N (compression level). Compressed CSV input is
+// recognized by its contents (see nsvb_treefile.hpp).
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "nsvb_shard.hpp"
+#include "nsvb_treefile.hpp"
+
+static int usage()
+{
+    std::cerr << "usage: nsvb_run [-shards N] [-jobs J] [pipeline options] [-no-trees] [-no-plots] input output\n"
+              << "       nsvb_run -shard K -shards N [pipeline options] [-no-trees] [-no-plots] input output\n"
+              << "       nsvb_run -merge -shards N [output options] [-no-trees] [-no-plots] output\n"
+              << "       nsvb_run -convert input output\n"
+              << "pipeline options: [-threads T] [-batch B] [-block BYTES] [-parsers P] [-evaluators E] [-formatters F] [-depth D] [-stats]\n"
+              << "                  [output options]\n"
+              << "output options: [-format csv|tsv|ndjson] [-precision N] [-compress none|gzip|zstd|lz4] [-level N]\n";
+    return 2;
+}
+
+int main( int argc, char **argv )
+{
+    RUN_OPTIONS options;
+    PIPELINE_OPTIONS &pipeline = options.pipeline;
+    int shard = -1;
+    bool merge = false, convert = false;
+    std::string format = "csv", compress = "none";
+    std::vector<std::string> files;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        bool value = i + 1 < argc;
+        if( !std::strcmp( argv[i], "-shards" ) && value ) options.shards = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-jobs" ) && value ) options.jobs = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-threads" ) && value ) pipeline.threads = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-batch" ) && value ) pipeline.block_rows = std::strtoull( argv[++i], nullptr, 10 );
+        else if( !std::strcmp( argv[i], "-block" ) && value ) pipeline.block_bytes = std::strtoull( argv[++i], nullptr, 10 );
+        else if( !std::strcmp( argv[i], "-parsers" ) && value ) pipeline.parsers = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-evaluators" ) && value ) pipeline.evaluators = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-formatters" ) && value ) pipeline.formatters = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-depth" ) && value ) pipeline.depth = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-stats" ) ) options.stats = true;
+        else if( !std::strcmp( argv[i], "-format" ) && value ) format = argv[++i];
+        else if( !std::strcmp( argv[i], "-precision" ) && value ) pipeline.output.precision = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-compress" ) && value ) compress = argv[++i];
+        else if( !std::strcmp( argv[i], "-level" ) && value ) pipeline.output.level = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-shard" ) && value ) shard = std::atoi( argv[++i] );
+        else if( !std::strcmp( argv[i], "-no-trees" ) ) options.trees = false;
+        else if( !std::strcmp( argv[i], "-no-plots" ) ) options.plots = false;
+        else if( !std::strcmp( argv[i], "-merge" ) ) merge = true;
+        else if( !std::strcmp( argv[i], "-convert" ) ) convert = true;
+        else if( argv[i][0] == '-' ) return usage();
+        else files.push_back( argv[i] );
+    }
+    if( files.size() != ( merge ? 1u : 2u ) || options.shards == 0 || pipeline.block_rows == 0 || pipeline.block_bytes == 0 )
+        return usage();
+
+    try {
+        pipeline.output.format = output_format( format );
+        pipeline.output.compression = compression( compress );
+        if( convert )
+            write_tree_file( files[1], TREE_FILE( files[0] ).read_all() );
+        else if( merge )
+            merge_shards( files[0], options );
+        else if( shard >= 0 )
+        {
+            PIPELINE_STATS stats = run_shard( files[0], files[1], shard, options );
+            if( options.stats )
+                std::cerr << "shard " << shard << " " << stats << "\n";
+        }
+        else
+        {
+            // this executable, not argv[0] which may have been found on PATH
+            char self[4096];
+            ssize_t len = readlink( "/proc/self/exe", self, sizeof( self ) - 1 );
+            run_local( len > 0 ? std::string( self, len ) : std::string( argv[0] ), files[0], files[1], options );
+        }
+    } catch( const std::exception &e ) {
+        std::cerr << "nsvb_run: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+// National Scale Volume and Biomass estimators (NSVB) evaluation server
+//
+// usage: nsvb_server [-address A] [-port P] [-batch N] [-wait us] [-threads N]
+//
+// Serves the endpoints described in nsvb_service.hpp until interrupted, then prints the metrics.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "nsvb_service.hpp"
+
+int main( int argc, char **argv )
+{
+    SERVICE_OPTIONS options;
+
+    for( int i = 1; i + 1 < argc; i += 2 )
+    {
+        if( !std::strcmp( argv[i], "-address" ) ) options.address = argv[i + 1];
+        else if( !std::strcmp( argv[i], "-port" ) ) options.port = static_cast<unsigned short>( std::atoi( argv[i + 1] ) );
+        else if( !std::strcmp( argv[i], "-batch" ) ) options.max_batch = std::strtoull( argv[i + 1], nullptr, 10 );
+        else if( !std::strcmp( argv[i], "-wait" ) ) options.wait_us = std::atoi( argv[i + 1] );
+        else if( !std::strcmp( argv[i], "-threads" ) ) options.threads = std::atoi( argv[i + 1] );
+        else {
+            std::cerr << "usage: nsvb_server [-address A] [-port P] [-batch N] [-wait us] [-threads N]\n";
+            return 2;
+        }
+    }
+
+    // wait for SIGINT or SIGTERM in this thread; blocked before any server thread starts
+    sigset_t signals;
+    sigemptyset( &signals );
+    sigaddset( &signals, SIGINT );
+    sigaddset( &signals, SIGTERM );
+    pthread_sigmask( SIG_BLOCK, &signals, nullptr );
+
+    SERVICE service( options );
+    try {
+        unsigned short port = service.start();
+        std::cout << "listening on " << options.address << ":" << port << std::endl;
+    } catch( const std::exception &e ) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    int signal;
+    sigwait( &signals, &signal );
+    service.stop();
+
+    SERVICE_METRICS m = service.metrics();
+    std::cout << "requests " << m.requests << " (errors " << m.errors << "), trees " << m.trees << ", batches " << m.batches
+              << ", p50 " << m.p50_us << " us, p99 " << m.p99_us << " us\n";
+
+    return 0;
+}
@@ -0,0 +1,850 @@
+// National Scale Volume and Biomass estimators (NSVB) evaluation service
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "nsvb_service.hpp"
+#include "nsvb_workspace.hpp"
+
+// latencies kept for the percentiles
+constexpr std::size_t LATENCY_WINDOW = 65536;
+
+// largest request line and headers
+constexpr std::size_t MAX_HEADER = 64 * 1024;
+
+static double now()
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// HTTP
+
+struct HTTP_REQUEST {
+    std::string method;
+    std::string path;
+    std::string content_type;
+    std::string body;
+    bool keep_alive = true;
+};
+
+// outcome of reading a request
+enum READ_STATUS { READ_OK, READ_CLOSED, READ_BAD, READ_TOO_LARGE };
+
+static bool equal_nocase( std::string_view a, std::string_view b )
+{
+    return a.size() == b.size() && std::equal( a.begin(), a.end(), b.begin(), []( char x, char y ) {
+        return std::tolower( static_cast<unsigned char>( x ) ) == std::tolower( static_cast<unsigned char>( y ) );
+    } );
+}
+
+static std::string_view trim( std::string_view s )
+{
+    while( !s.empty() && ( s.front() == ' ' || s.front() == '\t' ) )
+        s.remove_prefix( 1 );
+    while( !s.empty() && ( s.back() == ' ' || s.back() == '\t' || s.back() == '\r' ) )
+        s.remove_suffix( 1 );
+    return s;
+}
+
+// read more of a connection into buffer (false when closed or failed)
+static bool receive( int fd, std::string &buffer )
+{
+    char chunk[65536];
+
+    for( ;; )
+    {
+        ssize_t got = recv( fd, chunk, sizeof( chunk ), 0 );
+        if( got > 0 )
+        {
+            buffer.append( chunk, got );
+            return true;
+        }
+        if( got < 0 && errno == EINTR )
+            continue;
+        return false;
+    }
+}
+
+// read the next request of a connection; bytes of following (pipelined) requests stay in buffer
+static READ_STATUS read_request( int fd, std::string &buffer, std::size_t max_body, HTTP_REQUEST &request )
+{
+    std::size_t header_end;
+    while( ( header_end = buffer.find( "\r\n\r\n" ) ) == std::string::npos )
+    {
+        if( buffer.size() > MAX_HEADER )
+            return READ_BAD;
+        if( !receive( fd, buffer ) )
+            return READ_CLOSED;
+    }
+
+    std::string_view header( buffer.data(), header_end );
+    std::size_t line_end = header.find( "\r\n" );
+    std::string_view line = header.substr( 0, line_end );
+
+    std::size_t s1 = line.find( ' ' ), s2 = line.rfind( ' ' );
+    if( s1 == std::string_view::npos || s2 == s1 )
+        return READ_BAD;
+    request.method = line.substr( 0, s1 );
+    request.path = line.substr( s1 + 1, s2 - s1 - 1 );
+    request.keep_alive = line.substr( s2 + 1 ) != "HTTP/1.0";
+
+    std::size_t length = 0;
+    while( line_end != std::string_view::npos )
+    {
+        header.remove_prefix( line_end + 2 );
+        line_end = header.find( "\r\n" );
+        line = header.substr( 0, line_end );
+
+        std::size_t colon = line.find( ':' );
+        if( colon == std::string_view::npos )
+            continue;
+        std::string_view name = trim( line.substr( 0, colon ) ), value = trim( line.substr( colon + 1 ) );
+
+        if( equal_nocase( name, "content-length" ) )
+        {
+            if( std::from_chars( value.data(), value.data() + value.size(), length ).ec != std::errc() )
+                return READ_BAD;
+        }
+        else if( equal_nocase( name, "content-type" ) )
+            request.content_type = value;
+        else if( equal_nocase( name, "connection" ) )
+            request.keep_alive = equal_nocase( value, "close" ) ? false : equal_nocase( value, "keep-alive" ) ? true : request.keep_alive;
+        else if( equal_nocase( name, "transfer-encoding" ) )
+            return READ_BAD;
+    }
+
+    if( length > max_body )
+        return READ_TOO_LARGE;
+
+    std::size_t body_start = header_end + 4;
+    while( buffer.size() < body_start + length )
+        if( !receive( fd, buffer ) )
+            return READ_CLOSED;
+
+    request.body.assign( buffer, body_start, length );
+    buffer.erase( 0, body_start + length );
+
+    return READ_OK;
+}
+
+static bool send_all( int fd, const char *data, std::size_t size )
+{
+    while( size )
+    {
+        ssize_t sent = send( fd, data, size, MSG_NOSIGNAL );
+        if( sent < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static bool send_response( int fd, int status, const char *content_type, const std::string &body, bool keep_alive )
+{
+    const char *reason = status == 200 ? "OK" : status == 400 ? "Bad Request" : status == 404 ? "Not Found"
+                       : status == 413 ? "Payload Too Large" : "Internal Server Error";
+
+    std::string head = "HTTP/1.1 " + std::to_string( status ) + " " + reason + "\r\nContent-Type: " + content_type
+                     + "\r\nContent-Length: " + std::to_string( body.size() ) + ( keep_alive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n" );
+
+    return send_all( fd, head.data(), head.size() ) && send_all( fd, body.data(), body.size() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// JSON
+
+// reader for the request schema; anything else is skipped
+struct JSON_READER {
+    const char *p;
+    const char *end;
+
+    [[noreturn]] void fail( const char *what )
+    {
+        throw std::invalid_argument( std::string( "invalid JSON: " ) + what );
+    }
+
+    void ws()
+    {
+        while( p < end && ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' ) )
+            p++;
+    }
+
+    bool accept( char c )
+    {
+        ws();
+        if( p < end && *p == c )
+        {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect( char c )
+    {
+        if( !accept( c ) )
+            fail( ( std::string( "expected '" ) + c + "'" ).c_str() );
+    }
+
+    std::string string()
+    {
+        expect( '"' );
+
+        std::string s;
+        while( p < end && *p != '"' )
+        {
+            if( *p == '\\' )
+            {
+                if( ++p == end )
+                    break;
+                switch( *p ) {
+                    case 'n': s += '\n'; break;
+                    case 't': s += '\t'; break;
+                    case 'r': s += '\r'; break;
+                    case 'b': s += '\b'; break;
+                    case 'f': s += '\f'; break;
+                    case 'u':       // code points are not needed by the schema; kept as '?'
+                        p = std::min( p + 4, end - 1 );
+                        s += '?';
+                        break;
+                    default: s += *p;
+                }
+                p++;
+            }
+            else
+                s += *p++;
+        }
+        if( p == end )
+            fail( "unterminated string" );
+        p++;
+
+        return s;
+    }
+
+    double number()
+    {
+        ws();
+        double x;
+        auto r = std::from_chars( p, end, x );
+        if( r.ec != std::errc() )
+            fail( "expected a number" );
+        p = r.ptr;
+        return x;
+    }
+
+    // a number that is an integer within [low,high]
+    double integer( double low, double high, const char *what )
+    {
+        double x = number();
+        if( !( x >= low && x <= high ) || x != std::trunc( x ) )
+            fail( what );
+        return x;
+    }
+
+    bool literal( const char *word )
+    {
+        ws();
+        std::size_t n = std::strlen( word );
+        if( std::size_t( end - p ) >= n && !std::memcmp( p, word, n ) )
+        {
+            p += n;
+            return true;
+        }
+        return false;
+    }
+
+    void skip()
+    {
+        ws();
+        if( p == end )
+            fail( "unexpected end" );
+
+        if( *p == '"' )
+            string();
+        else if( accept( '{' ) )
+        {
+            if( accept( '}' ) )
+                return;
+            do {
+                string();
+                expect( ':' );
+                skip();
+            } while( accept( ',' ) );
+            expect( '}' );
+        }
+        else if( accept( '[' ) )
+        {
+            if( accept( ']' ) )
+                return;
+            do
+                skip();
+            while( accept( ',' ) );
+            expect( ']' );
+        }
+        else if( !literal( "true" ) && !literal( "false" ) && !literal( "null" ) )
+            number();
+    }
+};
+
+// {"trees":[{"fia_spp":..,"division":..,"dbh":..,"height":..}, ...]}
+static void parse_json( const std::string &body, SERVICE_REQUEST &request )
+{
+    JSON_READER json{ body.data(), body.data() + body.size() };
+
+    json.expect( '{' );
+    if( json.accept( '}' ) )
+    {
+        json.ws();
+        if( json.p != json.end )
+            json.fail( "characters after the request object" );
+        return;
+    }
+
+    do {
+        std::string key = json.string();
+        json.expect( ':' );
+
+        if( key != "trees" )
+        {
+            json.skip();
+            continue;
+        }
+
+        json.expect( '[' );
+        if( json.accept( ']' ) )
+            continue;
+
+        do {
+            int fia_spp = 999;
+            std::string division;
+            double dbh = NAN, height = NAN;
+
+            json.expect( '{' );
+            if( !json.accept( '}' ) )
+            {
+                do {
+                    std::string field = json.string();
+                    json.expect( ':' );
+
+                    if( field == "fia_spp" )
+                        fia_spp = static_cast<int>( json.integer( INT_MIN, INT_MAX, "fia_spp must be an integer" ) );
+                    else if( field == "division" )
+                    {
+                        json.ws();
+                        if( json.p < json.end && *json.p == '"' )
+                            division = json.string();
+                        else if( !json.literal( "null" ) )
+                        {
+                            double d = json.integer( -1e15, 1e15, "a numeric division must be an integer" );
+                            division = std::to_string( static_cast<long long>( d ) );
+                        }
+                    }
+                    else if( field == "dbh" )
+                        dbh = json.number();
+                    else if( field == "height" )
+                        height = json.number();
+                    else
+                        json.skip();
+                } while( json.accept( ',' ) );
+                json.expect( '}' );
+            }
+
+            request.fia_spp.push_back( fia_spp );
+            request.division.push_back( division_code( division ) );
+            request.dbh.push_back( dbh );
+            request.height.push_back( height );
+        } while( json.accept( ',' ) );
+        json.expect( ']' );
+    } while( json.accept( ',' ) );
+
+    json.expect( '}' );
+    json.ws();
+    if( json.p != json.end )
+        json.fail( "characters after the request object" );
+}
+
+static void append_number( std::string &out, double x )
+{
+    if( !std::isfinite( x ) )
+    {
+        out += "null";
+        return;
+    }
+
+    char text[32];
+    out.append( text, std::to_chars( text, text + sizeof( text ), x ).ptr );
+}
+
+static std::string format_json( const SERVICE_REQUEST &request )
+{
+    static const char *names[SERVICE_RESULTS] = { "{\"volib\":", ",\"volob\":", ",\"wood\":", ",\"bark\":", ",\"branch\":",
+                                                  ",\"foliage\":", ",\"total\":", ",\"above_ground_biomass\":" };
+    std::string out = "{\"results\":[";
+    out.reserve( 16 + request.fia_spp.size() * 200 );
+
+    for( std::size_t i = 0; i < request.fia_spp.size(); i++ )
+    {
+        if( i )
+            out += ',';
+        for( int c = 0; c < SERVICE_RESULTS; c++ )
+        {
+            out += names[c];
+            append_number( out, request.results[i * SERVICE_RESULTS + c] );
+        }
+        out += '}';
+    }
+    out += "]}";
+
+    return out;
+}
+
+static std::string json_error( const std::string &message )
+{
+    std::string out = "{\"error\":\"";
+    for( char c : message )
+    {
+        if( c == '"' || c == '\\' )
+            out += '\\';
+        out += static_cast<unsigned char>( c ) < 0x20 ? ' ' : c;
+    }
+    return out + "\"}";
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// binary protocol
+
+static void parse_binary( const std::string &body, SERVICE_REQUEST &request )
+{
+    std::uint32_t version, n;
+
+    if( body.size() < 12 || std::memcmp( body.data(), SERVICE_MAGIC, 4 ) )
+        throw std::invalid_argument( "binary request: bad header" );
+    std::memcpy( &version, body.data() + 4, 4 );
+    std::memcpy( &n, body.data() + 8, 4 );
+    if( version != SERVICE_VERSION )
+        throw std::invalid_argument( "binary request: unsupported version " + std::to_string( version ) );
+    if( body.size() != 12 + std::size_t( n ) * SERVICE_RECORD_SIZE )
+        throw std::invalid_argument( "binary request: size does not match tree count" );
+
+    request.fia_spp.resize( n );
+    request.division.resize( n );
+    request.dbh.resize( n );
+    request.height.resize( n );
+
+    const char *record = body.data() + 12;
+    for( std::uint32_t i = 0; i < n; i++, record += SERVICE_RECORD_SIZE )
+    {
+        std::int32_t spp;
+        std::memcpy( &spp, record, 4 );
+        std::memcpy( &request.dbh[i], record + 8, 8 );
+        std::memcpy( &request.height[i], record + 16, 8 );
+
+        std::string_view division( record + 4, 4 );
+        while( !division.empty() && ( division.back() == ' ' || division.back() == '\0' ) )
+            division.remove_suffix( 1 );
+
+        request.fia_spp[i] = spp;
+        request.division[i] = division_code( division );
+    }
+}
+
+static std::string format_binary( const SERVICE_REQUEST &request )
+{
+    std::uint32_t n = static_cast<std::uint32_t>( request.fia_spp.size() );
+    std::string out( 12 + request.results.size() * sizeof( double ), '\0' );
+
+    std::memcpy( out.data(), SERVICE_MAGIC, 4 );
+    std::memcpy( out.data() + 4, &SERVICE_VERSION, 4 );
+    std::memcpy( out.data() + 8, &n, 4 );
+    std::memcpy( out.data() + 12, request.results.data(), request.results.size() * sizeof( double ) );
+
+    return out;
+}
+
+static std::string format_metrics( const SERVICE_METRICS &m )
+{
+    std::string out = "{\"requests\":" + std::to_string( m.requests ) + ",\"errors\":" + std::to_string( m.errors )
+                    + ",\"trees\":" + std::to_string( m.trees ) + ",\"batches\":" + std::to_string( m.batches );
+    const std::pair<const char *, double> values[] = {
+        { ",\"uptime_s\":", m.uptime }, { ",\"requests_per_s\":", m.requests_per_second }, { ",\"trees_per_s\":", m.trees_per_second },
+        { ",\"mean_batch_trees\":", m.mean_batch_trees }, { ",\"latency_p50_us\":", m.p50_us }, { ",\"latency_p99_us\":", m.p99_us } };
+    for( auto &[name, x] : values )
+    {
+        out += name;
+        append_number( out, x );
+    }
+    return out + "}";
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// service
+
+SERVICE::SERVICE( const SERVICE_OPTIONS &options ) : options( options )
+{
+    if( this->options.max_batch == 0 )
+        this->options.max_batch = 1;
+}
+
+SERVICE::~SERVICE()
+{
+    stop();
+}
+
+// listen and serve in background threads
+unsigned short SERVICE::start()
+{
+    listen_fd = socket( AF_INET, SOCK_STREAM, 0 );
+    if( listen_fd < 0 )
+        throw std::runtime_error( std::string( "socket: " ) + std::strerror( errno ) );
+
+    int one = 1;
+    setsockopt( listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof( one ) );
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons( options.port );
+    if( inet_pton( AF_INET, options.address.c_str(), &address.sin_addr ) != 1 )
+        throw std::runtime_error( "invalid listen address " + options.address );
+
+    if( bind( listen_fd, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) < 0 || listen( listen_fd, 128 ) < 0 )
+    {
+        std::string error = std::strerror( errno );
+        close( listen_fd );
+        listen_fd = -1;
+        throw std::runtime_error( "listen on " + options.address + ":" + std::to_string( options.port ) + ": " + error );
+    }
+
+    socklen_t length = sizeof( address );
+    getsockname( listen_fd, reinterpret_cast<sockaddr *>( &address ), &length );
+
+    started = now();
+    stopping = false;
+    batching = true;
+    batcher = std::thread( &SERVICE::batch_loop, this );
+    acceptor = std::thread( &SERVICE::accept_loop, this );
+
+    return ntohs( address.sin_port );
+}
+
+// stop accepting, close connections and join all threads
+void SERVICE::stop()
+{
+    if( listen_fd < 0 )
+        return;
+
+    stopping = true;
+    shutdown( listen_fd, SHUT_RDWR );
+    if( acceptor.joinable() )
+        acceptor.join();
+    close( listen_fd );
+    listen_fd = -1;
+
+    {
+        std::unique_lock<std::mutex> lock( connection_mutex );
+        for( int fd : connection_fds )
+            shutdown( fd, SHUT_RDWR );
+        connections_cv.wait( lock, [this] { return connection_fds.empty(); } );
+    }
+
+    // connection threads may have queued requests while closing; the batcher drains them before it exits
+    {
+        std::lock_guard<std::mutex> lock( queue_mutex );
+        batching = false;
+        queue_cv.notify_all();
+    }
+    if( batcher.joinable() )
+        batcher.join();
+}
+
+void SERVICE::accept_loop()
+{
+    while( !stopping )
+    {
+        int fd = accept( listen_fd, nullptr, nullptr );
+        if( fd < 0 )
+        {
+            if( stopping )
+                break;
+            if( errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE )
+            {
+                if( errno == EMFILE || errno == ENFILE )
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                continue;
+            }
+            break;
+        }
+
+        int one = 1;
+        setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof( one ) );
+
+        std::lock_guard<std::mutex> lock( connection_mutex );
+        connection_fds.insert( fd );
+        std::thread( [this, fd] {
+            serve( fd );
+
+            std::lock_guard<std::mutex> lock( connection_mutex );
+            close( fd );
+            connection_fds.erase( fd );
+            connections_cv.notify_all();
+        } ).detach();
+    }
+}
+
+// serve the requests of a connection
+void SERVICE::serve( int fd )
+{
+    std::string buffer;
+
+    while( !stopping )
+    {
+        HTTP_REQUEST request;
+        READ_STATUS status = read_request( fd, buffer, options.max_body, request );
+        if( status == READ_CLOSED )
+            break;
+        if( status != READ_OK )
+        {
+            send_response( fd, status == READ_TOO_LARGE ? 413 : 400, "application/json",
+                           json_error( status == READ_TOO_LARGE ? "request too large" : "malformed request" ), false );
+            record( 0.0, true );
+            break;
+        }
+
+        double start = now();
+        int code = 200;
+        const char *type = "application/json";
+        std::string body;
+        bool counted = false;
+
+        try {
+            if( request.path == "/evaluate" && request.method == "POST" )
+            {
+                bool binary = request.content_type.starts_with( "application/octet-stream" );
+                SERVICE_REQUEST trees;
+
+                counted = true;
+                if( binary )
+                    parse_binary( request.body, trees );
+                else
+                    parse_json( request.body, trees );
+
+                evaluate( trees );
+
+                body = binary ? format_binary( trees ) : format_json( trees );
+                if( binary )
+                    type = "application/octet-stream";
+
+                std::lock_guard<std::mutex> lock( metrics_mutex );
+                this->trees += trees.fia_spp.size();
+            }
+            else if( request.path == "/metrics" && request.method == "GET" )
+                body = format_metrics( metrics() );
+            else if( request.path == "/health" && request.method == "GET" )
+            {
+                body = "ok\n";
+                type = "text/plain";
+            }
+            else
+            {
+                code = 404;
+                body = json_error( "no such endpoint: " + request.method + " " + request.path );
+            }
+        } catch( const std::invalid_argument &e ) {
+            code = 400;
+            body = json_error( e.what() );
+        } catch( const std::exception &e ) {
+            code = 500;
+            body = json_error( e.what() );
+        }
+
+        bool sent = send_response( fd, code, type, body, request.keep_alive );
+        if( counted )
+            record( ( now() - start ) * 1e6, code != 200 );
+        if( !sent || !request.keep_alive )
+            break;
+    }
+}
+
+// evaluate the trees of a request through the coalescing queue
+void SERVICE::evaluate( SERVICE_REQUEST &request )
+{
+    request.results.assign( request.fia_spp.size() * SERVICE_RESULTS, 0.0 );
+    request.done = request.fia_spp.empty();
+    if( request.done )
+        return;
+
+    std::unique_lock<std::mutex> lock( queue_mutex );
+    if( !batching )
+        throw std::runtime_error( "service is not running" );
+    queue.push_back( &request );
+    queue_cv.notify_one();
+    done_cv.wait( lock, [&request] { return request.done; } );
+
+    if( !request.error.empty() )
+        throw std::runtime_error( "evaluation failed: " + request.error );
+}
+
+// evaluate the n trees of a batch of requests as one batch into the requests' results
+static void evaluate_requests( const std::vector<SERVICE_REQUEST *> &batch, std::size_t n, WORKSPACE &workspace, unsigned threads )
+{
+    workspace.reset();
+    TREE_BATCH trees;
+    int *fia_spp = workspace.arena().allocate<int>( n );
+    DIVISION *division = workspace.arena().allocate<DIVISION>( n );
+    double *dbh = workspace.column( n );
+    double *height = workspace.column( n );
+
+    std::size_t offset = 0;
+    for( SERVICE_REQUEST *r : batch )
+    {
+        std::copy( r->fia_spp.begin(), r->fia_spp.end(), fia_spp + offset );
+        std::copy( r->division.begin(), r->division.end(), division + offset );
+        std::copy( r->dbh.begin(), r->dbh.end(), dbh + offset );
+        std::copy( r->height.begin(), r->height.end(), height + offset );
+        offset += r->fia_spp.size();
+    }
+
+    trees.n = n;
+    trees.fia_spp = fia_spp;
+    trees.division_codes = division;
+    trees.dbh = dbh;
+    trees.height = height;
+
+    BATCH_RESULT result = workspace.result_columns( n );
+    BATCH_OPTIONS batch_options;
+    batch_options.threads = threads;
+    evaluate_batch( trees, result, batch_options );
+
+    const double *columns[SERVICE_RESULTS] = { result.volib, result.volob, result.wood, result.bark, result.branch,
+                                               result.foliage, result.total, result.above_ground_biomass };
+    offset = 0;
+    for( SERVICE_REQUEST *r : batch )
+    {
+        for( std::size_t i = 0; i < r->fia_spp.size(); i++ )
+            for( int c = 0; c < SERVICE_RESULTS; c++ )
+                r->results[i * SERVICE_RESULTS + c] = columns[c][offset + i];
+        offset += r->fia_spp.size();
+    }
+}
+
+// coalesce queued requests into batches of up to max_batch trees, waiting up to wait_us for more
+void SERVICE::batch_loop()
+{
+    WORKSPACE workspace;
+    std::vector<SERVICE_REQUEST *> batch;
+
+    std::unique_lock<std::mutex> lock( queue_mutex );
+    for( ;; )
+    {
+        queue_cv.wait( lock, [this] { return !batching || !queue.empty(); } );
+        if( queue.empty() )
+            break;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds( options.wait_us );
+        std::size_t n = 0;
+        batch.clear();
+        for( ;; )
+        {
+            while( !queue.empty() && ( batch.empty() || n + queue.front()->fia_spp.size() <= options.max_batch ) )
+            {
+                n += queue.front()->fia_spp.size();
+                batch.push_back( queue.front() );
+                queue.pop_front();
+            }
+            if( n >= options.max_batch || !queue.empty() || stopping )
+                break;
+            if( !queue_cv.wait_until( lock, deadline, [this] { return stopping || !queue.empty(); } ) )
+                break;
+        }
+        lock.unlock();
+
+        // an exception fails the requests of this batch only
+        std::string error;
+        try {
+            evaluate_requests( batch, n, workspace, options.threads );
+        } catch( const std::exception &e ) {
+            error = *e.what() ? e.what() : "unknown error";
+        } catch( ... ) {
+            error = "unknown error";
+        }
+
+        {
+            std::lock_guard<std::mutex> metrics_lock( metrics_mutex );
+            batches++;
+        }
+
+        lock.lock();
+        for( SERVICE_REQUEST *r : batch )
+        {
+            r->error = error;
+            r->done = true;
+        }
+        done_cv.notify_all();
+    }
+}
+
+void SERVICE::record( double latency_us, bool error )
+{
+    std::lock_guard<std::mutex> lock( metrics_mutex );
+
+    requests++;
+    if( error )
+        errors++;
+    else if( latencies.size() < LATENCY_WINDOW )
+        latencies.push_back( latency_us );
+    else
+        latencies[latency_next++ % LATENCY_WINDOW] = latency_us;
+}
+
+SERVICE_METRICS SERVICE::metrics()
+{
+    SERVICE_METRICS m;
+    std::vector<double> sorted;
+
+    {
+        std::lock_guard<std::mutex> lock( metrics_mutex );
+        m.requests = requests;
+        m.errors = errors;
+        m.trees = trees;
+        m.batches = batches;
+        sorted = latencies;
+    }
+
+    m.uptime = started > 0.0 ? now() - started : 0.0;
+    if( m.uptime > 0.0 )
+    {
+        m.requests_per_second = m.requests / m.uptime;
+        m.trees_per_second = m.trees / m.uptime;
+    }
+    if( m.batches )
+        m.mean_batch_trees = double( m.trees ) / m.batches;
+
+    if( !sorted.empty() )
+    {
+        std::sort( sorted.begin(), sorted.end() );
+        m.p50_us = sorted[( sorted.size() - 1 ) / 2];
+        m.p99_us = sorted[static_cast<std::size_t>( 0.99 * ( sorted.size() - 1 ) )];
+    }
+
+    return m;
+}
@@ -0,0 +1,127 @@
+// National Scale Volume and Biomass estimators (NSVB) evaluation service
+//
+// A small HTTP/1.1 server evaluating trees for local tools. Requests from concurrent
+// connections are queued and coalesced into larger batches for evaluate_batch().
+//
+//  POST /evaluate  Content-Type: application/json
+//      {"trees":[{"fia_spp":202,"division":"M240","dbh":10.5,"height":65}, ...]}
+//      -> {"results":[{"volib":..,"volob":..,"wood":..,"bark":..,"branch":..,"foliage":..,
+//                      "total":..,"above_ground_biomass":..}, ...]}     (NaN as null)
+//
+//  POST /evaluate  Content-Type: application/octet-stream (little endian)
+//      request:  "NSVB" uint32 version (1) uint32 n, then n records of
+//                int32 fia_spp, char division[4] (padded with spaces or NULs), double dbh, double height
+//      response: "NSVB" uint32 version (1) uint32 n, then n records of 8 doubles
+//                (volib, volob, wood, bark, branch, foliage, total, above_ground_biomass)
+//
+//  GET /metrics    request, tree and batch counts, throughput and p50/p99 latency as JSON
+//  GET /health     "ok"
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_SERVICE_HPP
+#define NSVB_SERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nsvb_plan.hpp"
+
+// binary protocol
+constexpr char SERVICE_MAGIC[4] = { 'N', 'S', 'V', 'B' };
+constexpr std::uint32_t SERVICE_VERSION = 1;
+constexpr std::size_t SERVICE_RECORD_SIZE = 24;         // bytes of a binary request record
+constexpr int SERVICE_RESULTS = 8;                      // doubles per result record
+
+struct SERVICE_OPTIONS {
+    std::string address = "127.0.0.1";      // listen address (loopback by default)
+    unsigned short port = 8080;             // 0: any free port
+    std::size_t max_batch = 65536;          // trees per coalesced batch
+    unsigned wait_us = 200;                 // time a batch waits for more requests (microseconds)
+    unsigned threads = 1;                   // evaluate_batch() threads
+    std::size_t max_body = 256u << 20;      // largest request body (bytes)
+};
+
+struct SERVICE_METRICS {
+    std::uint64_t requests = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t trees = 0;
+    std::uint64_t batches = 0;
+    double uptime = 0.0;                    // seconds
+    double requests_per_second = 0.0;
+    double trees_per_second = 0.0;
+    double mean_batch_trees = 0.0;
+    double p50_us = 0.0;                    // request latency (body received to response written)
+    double p99_us = 0.0;
+};
+
+// trees of one request waiting for a batch
+struct SERVICE_REQUEST {
+    std::vector<int> fia_spp;
+    std::vector<DIVISION> division;
+    std::vector<double> dbh;
+    std::vector<double> height;
+    std::vector<double> results;            // SERVICE_RESULTS per tree
+    std::string error;                      // why the batch evaluating the request failed ("" when it did not)
+    bool done = false;
+};
+
+class SERVICE {
+public:
+    explicit SERVICE( const SERVICE_OPTIONS &options = {} );
+    ~SERVICE();
+
+    SERVICE( const SERVICE & ) = delete;
+    SERVICE &operator=( const SERVICE & ) = delete;
+
+    // listen and serve in background threads; returns the bound port (throws std::runtime_error)
+    unsigned short start();
+
+    // stop accepting, close connections and join all threads
+    void stop();
+
+    SERVICE_METRICS metrics();
+
+    // evaluate the trees of a request through the coalescing queue (blocks until done; throws
+    // std::runtime_error when the batch fails, which fails every request of the batch, or when
+    // the service is not running)
+    void evaluate( SERVICE_REQUEST &request );
+
+private:
+    SERVICE_OPTIONS options;
+    int listen_fd = -1;
+    std::atomic<bool> stopping{ false };
+    std::thread acceptor;
+    std::thread batcher;
+
+    std::mutex connection_mutex;
+    std::condition_variable connections_cv;    // a connection closed
+    std::set<int> connection_fds;               // open connections (each served by a detached thread)
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;       // requests queued
+    std::condition_variable done_cv;        // requests evaluated
+    std::deque<SERVICE_REQUEST *> queue;
+    bool batching = false;                  // batcher accepts requests; cleared once every connection has closed
+
+    std::mutex metrics_mutex;
+    double started = 0.0;
+    std::uint64_t requests = 0, errors = 0, trees = 0, batches = 0;
+    std::vector<double> latencies;          // most recent request latencies (microseconds), a ring
+    std::size_t latency_next = 0;
+
+    void accept_loop();
+    void batch_loop();
+    void serve( int fd );
+    void record( double latency_us, bool error );
+};
+
+#endif
@@ -0,0 +1,198 @@
+// National Scale Volume and Biomass estimators (NSVB) sharded runner
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+#include "nsvb_shard.hpp"
+#include "nsvb_treefile.hpp"
+
+extern char **environ;
+
+// name of an output file of a shard
+std::string shard_file( const std::string &output, unsigned shard, const char *kind )
+{
+    char suffix[32];
+    std::snprintf( suffix, sizeof( suffix ), ".shard-%04u.", shard );
+    return output + suffix + kind;
+}
+
+// write to path + ".tmp" and rename when complete, so a reader never sees a partial file
+static void write_file( const std::string &path, const std::string &data )
+{
+    std::string temporary = path + ".tmp";
+    RESULT_WRITER out( temporary );
+    out.write( data );
+    out.close();
+    if( std::rename( temporary.c_str(), path.c_str() ) )
+        throw std::runtime_error( "cannot rename " + temporary );
+}
+
+// evaluate one shard of input into its shard files
+PIPELINE_STATS run_shard( const std::string &input, const std::string &output, unsigned shard, const RUN_OPTIONS &options )
+{
+    TREE_FILE file( input );
+    std::vector<SHARD> shards = file.shards( options.shards );
+    if( shard >= shards.size() )
+        throw std::runtime_error( "shard " + std::to_string( shard ) + " of " + std::to_string( options.shards ) );
+
+    PLOT_MERGE plots;
+    PIPELINE_STATS stats;
+
+    if( options.trees )
+    {
+        std::string path = shard_file( output, shard, "trees" ), temporary = path + ".tmp";
+        RESULT_WRITER out( temporary );
+        stats = run_pipeline( file, shards[shard], &out, options.plots ? &plots : nullptr, options.pipeline );
+        out.close();
+        if( std::rename( temporary.c_str(), path.c_str() ) )
+            throw std::runtime_error( "cannot rename " + temporary );
+    }
+    else
+        stats = run_pipeline( file, shards[shard], nullptr, options.plots ? &plots : nullptr, options.pipeline );
+
+    if( options.plots )
+        write_file( shard_file( output, shard, "plots" ),
+                    std::string( reinterpret_cast<const char *>( plots.plots.data() ), plots.plots.size() * sizeof( PLOT_TOTALS ) ) );
+
+    return stats;
+}
+
+static std::string read_file( const std::string &path )
+{
+    std::ifstream is( path, std::ios::binary | std::ios::ate );
+    if( !is )
+        throw std::runtime_error( "missing shard output " + path );
+
+    std::string data( static_cast<std::size_t>( is.tellg() ), '\0' );
+    is.seekg( 0 );
+    is.read( data.data(), data.size() );
+    if( !is )
+        throw std::runtime_error( "cannot read " + path );
+    return data;
+}
+
+// combine the shard files of output
+void merge_shards( const std::string &output, const RUN_OPTIONS &options )
+{
+    unsigned shards = std::max( 1u, options.shards );
+    const OUTPUT_OPTIONS &format = options.pipeline.output;
+    std::string extension = std::string( output_format_name( format.format ) ) + compression_extension( format.compression );
+    BLOCK_COMPRESSOR compressor( format.compression, format.level );
+    std::string packed;
+
+    if( options.trees )
+    {
+        std::string path = output + ".trees." + extension, temporary = path + ".tmp";
+        RESULT_WRITER out( temporary );
+        std::string header = tree_results_header( format );
+        if( !header.empty() )
+        {
+            compressor.compress( header, packed );
+            out.write( packed );
+        }
+        for( unsigned k = 0; k < shards; k++ )
+            out.write( read_file( shard_file( output, k, "trees" ) ) );
+        out.close();
+        if( std::rename( temporary.c_str(), path.c_str() ) )
+            throw std::runtime_error( "cannot rename " + temporary );
+    }
+
+    if( options.plots )
+    {
+        PLOT_MERGE plots;
+        for( unsigned k = 0; k < shards; k++ )
+        {
+            std::string data = read_file( shard_file( output, k, "plots" ) );
+            if( data.size() % sizeof( PLOT_TOTALS ) )
+                throw std::runtime_error( "corrupt shard output " + shard_file( output, k, "plots" ) );
+
+            std::vector<PLOT_TOTALS> partial( data.size() / sizeof( PLOT_TOTALS ) );
+            std::copy( data.begin(), data.end(), reinterpret_cast<char *>( partial.data() ) );
+            for( const PLOT_TOTALS &p : partial )
+                plots.add( p );
+        }
+
+        std::string text = plot_totals_header( format );
+        format_plots( plots.plots, text, format );
+        compressor.compress( text, packed );
+        write_file( output + ".plots." + extension, packed );
+    }
+
+    for( unsigned k = 0; k < shards; k++ )
+    {
+        if( options.trees )
+            std::remove( shard_file( output, k, "trees" ).c_str() );
+        if( options.plots )
+            std::remove( shard_file( output, k, "plots" ).c_str() );
+    }
+}
+
+// run every shard as a worker process, options.jobs at a time, then merge
+void run_local( const std::string &self, const std::string &input, const std::string &output, const RUN_OPTIONS &options )
+{
+    unsigned shards = std::max( 1u, options.shards ), jobs = std::max( 1u, options.jobs );
+    unsigned running = 0, failed = 0;
+
+    auto wait_one = [&] {
+        int status;
+        if( wait( &status ) <= 0 )
+        {
+            failed += running;
+            running = 0;
+            return;
+        }
+        running--;
+        if( !WIFEXITED( status ) || WEXITSTATUS( status ) )
+            failed++;
+    };
+
+    for( unsigned k = 0; k < shards; k++ )
+    {
+        if( running == jobs )
+            wait_one();
+
+        const PIPELINE_OPTIONS &p = options.pipeline;
+        std::vector<std::string> args = { self, "-shard", std::to_string( k ), "-shards", std::to_string( shards ),
+                                          "-threads", std::to_string( p.threads ), "-batch", std::to_string( p.block_rows ),
+                                          "-block", std::to_string( p.block_bytes ), "-parsers", std::to_string( p.parsers ),
+                                          "-evaluators", std::to_string( p.evaluators ), "-formatters", std::to_string( p.formatters ),
+                                          "-depth", std::to_string( p.depth ), "-format", output_format_name( p.output.format ),
+                                          "-precision", std::to_string( p.output.precision ), "-compress",
+                                          compression_name( p.output.compression ), "-level", std::to_string( p.output.level ) };
+        if( !options.trees )
+            args.push_back( "-no-trees" );
+        if( !options.plots )
+            args.push_back( "-no-plots" );
+        if( options.stats )
+            args.push_back( "-stats" );
+        args.push_back( input );
+        args.push_back( output );
+
+        std::vector<char *> argv;
+        for( auto &a : args )
+            argv.push_back( a.data() );
+        argv.push_back( nullptr );
+
+        pid_t pid;
+        if( posix_spawn( &pid, self.c_str(), nullptr, nullptr, argv.data(), environ ) )
+        {
+            failed++;
+            break;
+        }
+        running++;
+    }
+    while( running )
+        wait_one();
+
+    if( failed )
+        throw std::runtime_error( std::to_string( failed ) + " shard worker(s) failed" );
+
+    merge_shards( output, options );
+}
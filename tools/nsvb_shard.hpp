@@ -0,0 +1,52 @@
+// National Scale Volume and Biomass estimators (NSVB) sharded runner
+//
+// Evaluates a tree file (nsvb_treefile.hpp) in shards, one worker process per shard. Workers
+// are started locally (run_local()) or by a job launcher on nodes sharing a filesystem, each
+// running run_shard() on its shard; merge_shards() then combines their outputs.
+//
+// A worker streams its shard through run_pipeline() (nsvb_pipeline.hpp) and writes
+//   <output>.shard-NNNN.trees   per tree results (options.pipeline.output format, no header)
+//   <output>.shard-NNNN.plots   plot rollup partials (PLOT_TOTALS records, native layout)
+// merge_shards() writes
+//   <output>.trees.csv  plot, tree, fia_spp, division, volib, volob, wood, bark, branch, foliage,
+//                       total, above_ground_biomass, green_tons (undefined values as NA)
+//   <output>.plots.csv  plot, trees, tpa, volib, volob, green_tons and the biomass components per acre
+// (.tsv or .ndjson in place of .csv for those formats, nsvb_format.hpp, followed by .gz, .zst
+// or .lz4 when compressed, nsvb_compress.hpp: shard files are then concatenated members or
+// frames and are merged without decompressing)
+// by concatenating tree results and adding plot partials with add_totals() in shard order, and
+// removes the shard files. Tree results are the same for any number of shards and jobs; plot
+// totals are the same for any number of jobs, and for plots not split between shards also for
+// any number of shards (a split plot is summed in another order).
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_SHARD_HPP
+#define NSVB_SHARD_HPP
+
+#include <string>
+#include "nsvb_pipeline.hpp"
+
+struct RUN_OPTIONS {
+    unsigned shards = 1;                    // shards of the input
+    unsigned jobs = 1;                      // local worker processes running at once
+    bool trees = true;                      // write per tree results
+    bool plots = true;                      // write plot rollups
+    PIPELINE_OPTIONS pipeline;              // stages of each worker
+    bool stats = false;                     // workers write PIPELINE_STATS to stderr
+};
+
+// name of an output file of a shard (kind "trees" or "plots")
+std::string shard_file( const std::string &output, unsigned shard, const char *kind );
+
+// evaluate one shard of input into its shard files
+PIPELINE_STATS run_shard( const std::string &input, const std::string &output, unsigned shard, const RUN_OPTIONS &options );
+
+// combine the shard files of output
+void merge_shards( const std::string &output, const RUN_OPTIONS &options );
+
+// run every shard as a worker process (self -shard K ...), options.jobs at a time, then merge
+void run_local( const std::string &self, const std::string &input, const std::string &output, const RUN_OPTIONS &options );
+
+#endif
@@ -0,0 +1,449 @@
+// National Scale Volume and Biomass estimators (NSVB) tree list files
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include "nsvb_treefile.hpp"
+
+// bytes read from a CSV file at a time
+constexpr std::size_t CSV_READ = 4u << 20;
+
+// column names of the CSV header
+static const char *column_names[TC_COUNT] = { "plot", "tree", "fia_spp", "division", "dbh", "tht", "vtotib", "planted", "tpa" };
+
+void TREE_COLUMNS::clear()
+{
+    plot.clear(); tree.clear(); fia_spp.clear(); division.clear();
+    dbh.clear(); height.clear(); vtotib.clear(); planted.clear(); tpa.clear();
+}
+
+// the trees as a batch
+TREE_BATCH TREE_COLUMNS::batch() const
+{
+    TREE_BATCH b;
+    b.n = size();
+    b.fia_spp = fia_spp.data();
+    b.division_codes = division.data();
+    b.dbh = dbh.data();
+    b.height = height.data();
+    b.vtotib = vtotib.empty() ? nullptr : vtotib.data();
+    // planted holds only 0 and 1, the object representations of bool
+    b.planted = planted.empty() ? nullptr : reinterpret_cast<const bool *>( planted.data() );
+
+    return b;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// CSV
+
+static std::string_view trim( std::string_view s )
+{
+    while( !s.empty() && ( s.front() == ' ' || s.front() == '"' ) )
+        s.remove_prefix( 1 );
+    while( !s.empty() && ( s.back() == ' ' || s.back() == '"' || s.back() == '\r' ) )
+        s.remove_suffix( 1 );
+    return s;
+}
+
+// fields of a line split at commas (fields may not contain commas)
+static void split( std::string_view line, std::vector<std::string_view> &fields )
+{
+    fields.clear();
+    for( std::size_t p = 0;; )
+    {
+        std::size_t comma = line.find( ',', p );
+        fields.push_back( trim( line.substr( p, comma == std::string_view::npos ? std::string_view::npos : comma - p ) ) );
+        if( comma == std::string_view::npos )
+            break;
+        p = comma + 1;
+    }
+}
+
+// read the text of a CSV shard in blocks of whole lines
+void TREE_FILE::read_text( const SHARD &shard, std::size_t block_bytes, const std::function<void( std::string &, std::uint64_t )> &consume ) const
+{
+    std::uint64_t remaining = shard.end - shard.begin;
+    if( remaining == 0 )
+        return;
+
+    // a compressed file is decompressed from its start (its shard ends at UINT64_MAX)
+    std::ifstream is;
+    std::unique_ptr<COMPRESSED_READER> stream;
+    if( compressed )
+    {
+        stream = std::make_unique<COMPRESSED_READER>( path );
+        std::string skip( shard.begin, '\0' );
+        stream->read( skip.data(), skip.size() );
+    }
+    else
+    {
+        is.open( path, std::ios::binary );
+        is.seekg( shard.begin );
+    }
+
+    block_bytes = std::max<std::size_t>( 1, block_bytes );
+    std::string buffer, carry;
+    std::uint64_t position = shard.begin;       // file offset of buffer[0]
+
+    while( remaining > 0 )
+    {
+        std::size_t block = static_cast<std::size_t>( std::min<std::uint64_t>( remaining, block_bytes ) );
+        buffer.swap( carry );
+        std::size_t keep = buffer.size();
+        buffer.resize( keep + block );
+        if( stream )
+        {
+            std::size_t n = stream->read( buffer.data() + keep, block );
+            buffer.resize( keep + n );
+            remaining = n < block ? 0 : remaining - block;
+            if( buffer.empty() )
+                break;
+        }
+        else
+        {
+            if( !is.read( buffer.data() + keep, block ) )
+                throw std::runtime_error( path + ": read failed" );
+            remaining -= block;
+        }
+
+        // the partial last line waits for the next block (the shard ends at a line end or the file end)
+        std::size_t eol = remaining ? buffer.rfind( '\n' ) : buffer.size() - 1;
+        if( eol == std::string::npos )
+        {
+            carry.swap( buffer );
+            continue;
+        }
+        carry.assign( buffer, eol + 1 );
+        buffer.resize( eol + 1 );
+
+        std::uint64_t at = position;
+        position += buffer.size();
+        consume( buffer, at );
+        buffer.clear();
+    }
+}
+
+// parse whole CSV lines of text into trees
+std::size_t TREE_FILE::parse( std::string_view text, std::uint64_t at, TREE_COLUMNS &trees, std::size_t max_rows ) const
+{
+    try {
+        return csv.parse( text, at, trees, max_rows );
+    } catch( const std::exception &e ) {
+        throw std::runtime_error( path + ": " + e.what() );
+    }
+}
+
+// read the CSV records of a shard in batches
+void TREE_FILE::read_csv( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const
+{
+    TREE_COLUMNS trees;
+
+    read_text( shard, CSV_READ, [&]( std::string &text, std::uint64_t at ) {
+        for( std::size_t done = 0; done < text.size(); )
+        {
+            done += parse( std::string_view( text ).substr( done ), at + done, trees, batch_rows - trees.size() );
+            if( trees.size() == batch_rows )
+            {
+                consume( trees );
+                trees.clear();
+            }
+        }
+    } );
+
+    if( trees.size() )
+        consume( trees );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// binary
+
+static std::size_t column_size( int c )
+{
+    switch( c )
+    {
+        case TC_DIVISION: return 4;
+        case TC_PLANTED: return 1;
+        case TC_PLOT: case TC_TREE: case TC_FIA_SPP: return sizeof( std::int32_t );
+        default: return sizeof( double );
+    }
+}
+
+template <typename T>
+static void read_column( std::ifstream &is, const TREE_FILE_HEADER &h, int c, std::uint64_t row, std::size_t n, std::vector<T> &to )
+{
+    to.resize( n );
+    is.seekg( h.offset[c] + row * sizeof( T ) );
+    is.read( reinterpret_cast<char *>( to.data() ), n * sizeof( T ) );
+}
+
+// read rows [begin,end) of a binary file
+void TREE_FILE::read_binary( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const
+{
+    std::ifstream is( path, std::ios::binary );
+    TREE_COLUMNS trees;
+    std::vector<char> division;
+
+    for( std::uint64_t row = shard.begin; row < shard.end; row += batch_rows )
+    {
+        std::size_t n = static_cast<std::size_t>( std::min<std::uint64_t>( batch_rows, shard.end - row ) );
+
+        trees.clear();
+        read_column( is, header, TC_PLOT, row, n, trees.plot );
+        read_column( is, header, TC_TREE, row, n, trees.tree );
+        read_column( is, header, TC_FIA_SPP, row, n, trees.fia_spp );
+        read_column( is, header, TC_DBH, row, n, trees.dbh );
+        read_column( is, header, TC_HEIGHT, row, n, trees.height );
+        if( has_vtotib() )
+            read_column( is, header, TC_VTOTIB, row, n, trees.vtotib );
+        if( has_planted() )
+        {
+            // any nonzero byte is planted; batch() needs 0 or 1
+            read_column( is, header, TC_PLANTED, row, n, trees.planted );
+            for( std::uint8_t &p : trees.planted )
+                p = p != 0;
+        }
+        if( has_tpa() )
+            read_column( is, header, TC_TPA, row, n, trees.tpa );
+
+        division.resize( 4 * n );
+        is.seekg( header.offset[TC_DIVISION] + row * 4 );
+        is.read( division.data(), division.size() );
+        if( !is )
+            throw std::runtime_error( path + ": truncated binary tree file" );
+
+        trees.division.resize( n );
+        for( std::size_t i = 0; i < n; i++ )
+            trees.division[i] = division_code( std::string_view( division.data() + 4 * i, strnlen( division.data() + 4 * i, 4 ) ) );
+
+        consume( trees );
+    }
+}
+
+// write trees as a binary tree file
+void write_tree_file( const std::string &path, const TREE_COLUMNS &trees )
+{
+    std::size_t n = trees.size();
+    TREE_FILE_HEADER h;
+    std::memset( &h, 0, sizeof( h ) );
+    std::memcpy( h.magic, TREE_FILE_MAGIC, sizeof( h.magic ) );
+    h.version = TREE_FILE_VERSION;
+    h.columns = ( trees.vtotib.empty() ? 0 : TREE_VTOTIB ) | ( trees.planted.empty() ? 0 : TREE_PLANTED ) | ( trees.tpa.empty() ? 0 : TREE_TPA );
+    h.rows = n;
+
+    const void *data[TC_COUNT] = { trees.plot.data(), trees.tree.data(), trees.fia_spp.data(), nullptr, trees.dbh.data(), trees.height.data(),
+                                   trees.vtotib.empty() ? nullptr : trees.vtotib.data(), trees.planted.empty() ? nullptr : trees.planted.data(),
+                                   trees.tpa.empty() ? nullptr : trees.tpa.data() };
+
+    std::uint64_t offset = sizeof( h );
+    for( int c = 0; c < TC_COUNT; c++ )
+    {
+        if( c >= TC_VTOTIB && !data[c] )
+            continue;
+        offset = ( offset + 63 ) / 64 * 64;
+        h.offset[c] = offset;
+        offset += n * column_size( c );
+    }
+
+    std::vector<char> division( 4 * n, 0 );
+    for( std::size_t i = 0; i < n; i++ )
+        std::strncpy( division.data() + 4 * i, division_name( trees.division[i] ), 4 );
+    data[TC_DIVISION] = division.data();
+
+    std::ofstream os( path, std::ios::binary );
+    os.write( reinterpret_cast<const char *>( &h ), sizeof( h ) );
+    std::uint64_t at = sizeof( h );
+    for( int c = 0; c < TC_COUNT; c++ )
+    {
+        if( !h.offset[c] )
+            continue;
+        static const char zeros[64] = {};
+        os.write( zeros, h.offset[c] - at );
+        os.write( static_cast<const char *>( data[c] ), n * column_size( c ) );
+        at = h.offset[c] + n * column_size( c );
+    }
+    if( !os.flush() )
+        throw std::runtime_error( "cannot write " + path );
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// TREE_FILE
+
+TREE_FILE::TREE_FILE( const std::string &file ) : path( file )
+{
+    std::ifstream is( path, std::ios::binary | std::ios::ate );
+    if( !is )
+        throw std::runtime_error( "cannot open " + path );
+    size = static_cast<std::uint64_t>( is.tellg() );
+    is.seekg( 0 );
+
+    std::fill( column, column + TC_COUNT, -1 );
+
+    char magic[8] = {};
+    is.read( magic, sizeof( magic ) );
+    compressed = detect_compression( magic, static_cast<std::size_t>( is.gcount() ) );
+    if( compressed )
+    {
+        is.close();
+        read_compressed_header();
+        return;
+    }
+    if( is && std::memcmp( magic, TREE_FILE_MAGIC, sizeof( magic ) ) == 0 )
+    {
+        is.seekg( 0 );
+        if( !is.read( reinterpret_cast<char *>( &header ), sizeof( header ) ) || header.version != TREE_FILE_VERSION )
+            throw std::runtime_error( path + ": unsupported binary tree file version" );
+        for( int c = 0; c < TC_COUNT; c++ )
+            if( header.offset[c] )
+            {
+                if( header.offset[c] + header.rows * column_size( c ) > size )
+                    throw std::runtime_error( path + ": truncated binary tree file" );
+                column[c] = c;
+            }
+        if( column[TC_PLOT] < 0 || column[TC_TREE] < 0 || column[TC_FIA_SPP] < 0 || column[TC_DIVISION] < 0 || column[TC_DBH] < 0
+            || column[TC_HEIGHT] < 0 )
+            throw std::runtime_error( path + ": binary tree file misses a column" );
+
+        is_binary = true;
+        return;
+    }
+
+    // CSV header
+    is.clear();
+    is.seekg( 0 );
+    std::string line;
+    if( !std::getline( is, line ) )
+        throw std::runtime_error( path + ": empty file" );
+    data_begin = std::min<std::uint64_t>( line.size() + 1, size );
+
+    read_header( line );
+}
+
+// the header of a compressed CSV file
+void TREE_FILE::read_compressed_header()
+{
+    COMPRESSED_READER stream( path );
+    std::string text;
+    char chunk[65536];
+    for( std::size_t n; text.find( '\n' ) == std::string::npos && ( n = stream.read( chunk, sizeof( chunk ) ) ) > 0; )
+        text.append( chunk, n );
+
+    if( text.empty() )
+        throw std::runtime_error( path + ": empty file" );
+    if( text.size() >= sizeof( TREE_FILE_MAGIC ) && std::memcmp( text.data(), TREE_FILE_MAGIC, sizeof( TREE_FILE_MAGIC ) ) == 0 )
+        throw std::runtime_error( path + ": compressed binary tree files are not supported" );
+
+    std::string line = text.substr( 0, text.find( '\n' ) );
+    size = UINT64_MAX;
+    data_begin = std::min<std::uint64_t>( line.size() + 1, text.size() );
+
+    read_header( line );
+}
+
+// the columns named by a CSV header
+void TREE_FILE::read_header( const std::string &line )
+{
+    std::vector<std::string_view> fields;
+    split( line, fields );
+    for( int f = 0; f < static_cast<int>( fields.size() ); f++ )
+        for( int c = 0; c < TC_COUNT; c++ )
+            if( fields[f] == column_names[c] || ( c == TC_HEIGHT && fields[f] == "height" ) )
+                column[c] = f;
+
+    for( int c = TC_PLOT; c <= TC_HEIGHT; c++ )
+        if( column[c] < 0 )
+            throw std::runtime_error( path + ": no " + column_names[c] + " column" );
+
+    csv = TREE_CSV( column );
+}
+
+// split the records into count shards of about equal size
+std::vector<SHARD> TREE_FILE::shards( unsigned count ) const
+{
+    count = std::max( 1u, count );
+    std::vector<SHARD> shards( count );
+
+    if( is_binary )
+    {
+        for( unsigned k = 0; k < count; k++ )
+        {
+            shards[k].index = k;
+            shards[k].begin = header.rows * k / count;
+            shards[k].end = header.rows * ( k + 1 ) / count;
+        }
+        return shards;
+    }
+
+    // a compressed file is one stream
+    if( compressed )
+    {
+        for( unsigned k = 0; k < count; k++ )
+        {
+            shards[k].index = k;
+            shards[k].begin = k ? size : data_begin;
+            shards[k].end = size;
+        }
+        return shards;
+    }
+
+    // each boundary moves forward to the start of a line
+    std::ifstream is( path, std::ios::binary );
+    std::vector<std::uint64_t> boundary( count + 1 );
+    boundary[0] = data_begin;
+    boundary[count] = size;
+    for( unsigned k = 1; k < count; k++ )
+    {
+        std::uint64_t at = std::max( boundary[k - 1], data_begin + ( size - data_begin ) * k / count );
+        if( at > data_begin && at < size )
+        {
+            // at is a line start when the byte before it ends a line
+            is.seekg( at - 1 );
+            char c;
+            while( is.get( c ) && c != '\n' )
+                ;
+            at = is ? static_cast<std::uint64_t>( is.tellg() ) : size;
+            is.clear();
+        }
+        boundary[k] = std::min( at, size );
+    }
+
+    for( unsigned k = 0; k < count; k++ )
+    {
+        shards[k].index = k;
+        shards[k].begin = boundary[k];
+        shards[k].end = boundary[k + 1];
+    }
+
+    return shards;
+}
+
+// read the trees of a shard in batches
+void TREE_FILE::read( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const
+{
+    batch_rows = std::max<std::size_t>( 1, batch_rows );
+
+    if( is_binary )
+        read_binary( shard, batch_rows, consume );
+    else
+        read_csv( shard, batch_rows, consume );
+}
+
+// read the whole file
+TREE_COLUMNS TREE_FILE::read_all() const
+{
+    TREE_COLUMNS all;
+    auto append = []( auto &to, const auto &from ) { to.insert( to.end(), from.begin(), from.end() ); };
+
+    read( shards( 1 )[0], 1u << 20, [&]( const TREE_COLUMNS &t ) {
+        append( all.plot, t.plot ); append( all.tree, t.tree ); append( all.fia_spp, t.fia_spp );
+        append( all.division, t.division ); append( all.dbh, t.dbh ); append( all.height, t.height );
+        append( all.vtotib, t.vtotib ); append( all.planted, t.planted ); append( all.tpa, t.tpa );
+    } );
+
+    return all;
+}
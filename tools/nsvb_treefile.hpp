@@ -0,0 +1,133 @@
+// National Scale Volume and Biomass estimators (NSVB) tree list files
+//
+// Tree lists are read from CSV or from a binary columnar file, whole or by shard.
+//
+// CSV: a header naming the columns, in any order (other columns are ignored)
+//      plot, tree, fia_spp, division, dbh, tht (or height) and optionally vtotib, planted
+//      (0/1, true/false) and tpa; one tree per line.
+//
+// Binary (little endian on the platforms built): TREE_FILE_HEADER, then each column as an
+//      array of rows values starting at its offset (64 byte aligned):
+//      int32 plot, int32 tree, int32 fia_spp, char division[4] (NUL padded), double dbh,
+//      double height, and when flagged double vtotib, uint8 planted (nonzero: planted), double tpa.
+//
+// A shard is a range of whole records: bytes of a CSV file, split at line ends, or rows of a
+// binary file. Shards are planned from the file alone, so independent worker processes agree
+// on them.
+//
+// A CSV file may be compressed with gzip, zstd or LZ4 (nsvb_compress.hpp). It is read as one
+// stream, so it forms a single shard (the others are empty); byte offsets in messages count
+// decompressed bytes.
+//
+// Greg Johnson Biometrics LLC
+// 10-18-2026
+
+#ifndef NSVB_TREEFILE_HPP
+#define NSVB_TREEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nsvb_batch.hpp"
+#include "nsvb_compress.hpp"
+#include "nsvb_csv.hpp"
+
+constexpr char TREE_FILE_MAGIC[8] = { 'N', 'S', 'V', 'B', 'T', 'R', 'E', 'E' };
+constexpr std::uint32_t TREE_FILE_VERSION = 1;
+
+// optional columns of a binary tree file
+enum TREE_FILE_COLUMNS : std::uint32_t {
+    TREE_VTOTIB = 1,
+    TREE_PLANTED = 2,
+    TREE_TPA = 4
+};
+
+// columns of a binary tree file, in file order
+enum TREE_FILE_COLUMN { TC_PLOT = 0, TC_TREE, TC_FIA_SPP, TC_DIVISION, TC_DBH, TC_HEIGHT, TC_VTOTIB, TC_PLANTED, TC_TPA, TC_COUNT };
+
+struct TREE_FILE_HEADER {
+    char magic[8];                          // TREE_FILE_MAGIC
+    std::uint32_t version;                  // TREE_FILE_VERSION
+    std::uint32_t columns;                  // TREE_FILE_COLUMNS present
+    std::uint64_t rows;
+    std::uint64_t offset[TC_COUNT];         // first byte of each column (0: absent)
+};
+
+// tree list columns
+struct TREE_COLUMNS {
+    std::vector<int> plot;
+    std::vector<int> tree;
+    std::vector<int> fia_spp;
+    std::vector<DIVISION> division;
+    std::vector<double> dbh;
+    std::vector<double> height;
+    std::vector<double> vtotib;             // empty when not read
+    std::vector<std::uint8_t> planted;      // 0 or 1; empty when not read
+    std::vector<double> tpa;                // empty when not read
+
+    std::size_t size() const { return fia_spp.size(); }
+    void clear();
+
+    // the trees as a batch (columns stay owned here)
+    TREE_BATCH batch() const;
+};
+
+// a range of whole records of a tree file
+struct SHARD {
+    unsigned index = 0;
+    std::uint64_t begin = 0;                // first byte (CSV) or row (binary)
+    std::uint64_t end = 0;
+};
+
+class TREE_FILE {
+public:
+    // open a CSV or binary tree file and read its header
+    explicit TREE_FILE( const std::string &path );
+
+    bool binary() const { return is_binary; }
+    COMPRESSION compression() const { return compressed; }
+    bool has_vtotib() const { return column[TC_VTOTIB] >= 0; }
+    bool has_planted() const { return column[TC_PLANTED] >= 0; }
+    bool has_tpa() const { return column[TC_TPA] >= 0; }
+
+    // split the records into count shards of about equal size (some may be empty)
+    std::vector<SHARD> shards( unsigned count ) const;
+
+    // read the trees of a shard in batches of up to batch_rows trees, passing each to consume
+    // (which may take the columns)
+    void read( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const;
+
+    // read the whole file
+    TREE_COLUMNS read_all() const;
+
+    // read the text of a CSV shard in blocks of whole lines of about block_bytes, passing each
+    // block and the file offset of its first byte to consume (which may take the text)
+    void read_text( const SHARD &shard, std::size_t block_bytes, const std::function<void( std::string &, std::uint64_t )> &consume ) const;
+
+    // parse whole CSV lines of text (starting at file offset at) into trees, stopping after
+    // max_rows trees; returns the bytes parsed (see nsvb_csv.hpp)
+    std::size_t parse( std::string_view text, std::uint64_t at, TREE_COLUMNS &trees, std::size_t max_rows = SIZE_MAX ) const;
+
+private:
+    void read_compressed_header();
+    void read_header( const std::string &line );
+    void read_csv( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const;
+    void read_binary( const SHARD &shard, std::size_t batch_rows, const std::function<void( TREE_COLUMNS & )> &consume ) const;
+
+    std::string path;
+    bool is_binary = false;
+    COMPRESSION compressed = CP_NONE;
+    std::uint64_t size = 0;                 // bytes of the file (UINT64_MAX when compressed)
+    std::uint64_t data_begin = 0;           // first byte after the CSV header
+    int column[TC_COUNT];                   // CSV field of each column (-1: absent)
+    TREE_CSV csv;                           // parser of the CSV columns
+    TREE_FILE_HEADER header{};
+};
+
+// write trees as a binary tree file (optional columns are written when not empty)
+void write_tree_file( const std::string &path, const TREE_COLUMNS &trees );
+
+#endif